@@ -46,6 +46,29 @@ Abstract:
 #define CXPLAT_POOL_PROC          '10xC' // Cx01
 #define CXPLAT_POOL_TMP_ALLOC     '20xC' // Cx02
 #define CXPLAT_POOL_CUSTOM_THREAD '30xC' // Cx03
+#define CXPLAT_POOL_RUNDOWN       '40xC' // Cx04
+#define CXPLAT_POOL_TIMER         '50xC' // Cx05
+#define CXPLAT_POOL_RATE_LIMITER  '60xC' // Cx06
+#define CXPLAT_POOL_HISTOGRAM     '70xC' // Cx07
+#define CXPLAT_POOL_SCHEDULER     '80xC' // Cx08
+#define CXPLAT_POOL_THREAD_POOL   '90xC' // Cx09
+#define CXPLAT_POOL_WORKER        'A0xC' // Cx0A
+#define CXPLAT_POOL_PER_PROC      'B0xC' // Cx0B
+#define CXPLAT_POOL_THREAD_CACHE  'C0xC' // Cx0C
+#define CXPLAT_POOL_FUTURE        'D0xC' // Cx0D
+#define CXPLAT_POOL_COROUTINE     'E0xC' // Cx0E
+#define CXPLAT_POOL_HIGH_RES_TIMER 'F0xC' // Cx0F
+
+//
+// Size used to pad per-processor data to avoid false sharing.
+//
+#define CXPLAT_CACHE_LINE_SIZE 64
+
+//
+// Default number of spin iterations for CxPlatEventWaitWithSpin; roughly a few
+// microseconds on current hardware.
+//
+#define CXPLAT_EVENT_DEFAULT_SPIN_COUNT 2000
 
 //
 // Thread create flags.
@@ -54,7 +77,9 @@ typedef enum CXPLAT_THREAD_FLAGS {
     CXPLAT_THREAD_FLAG_NONE               = 0x0000,
     CXPLAT_THREAD_FLAG_SET_IDEAL_PROC     = 0x0001,
     CXPLAT_THREAD_FLAG_SET_AFFINITIZE     = 0x0002,
-    CXPLAT_THREAD_FLAG_HIGH_PRIORITY      = 0x0004
+    CXPLAT_THREAD_FLAG_HIGH_PRIORITY      = 0x0004,
+    CXPLAT_THREAD_FLAG_SET_NUMA_NODE      = 0x0008, // Linux only
+    CXPLAT_THREAD_FLAG_SET_PROCESSORS     = 0x0010  // Linux only
 } CXPLAT_THREAD_FLAGS;
 
 #ifdef DEFINE_ENUM_FLAG_OPERATORS
@@ -106,6 +131,1462 @@ CxPlatGetAllocFailDenominator(
     );
 #endif
 
+//
+// List Interfaces
+//
+
+typedef struct CXPLAT_LIST_ENTRY {
+    struct CXPLAT_LIST_ENTRY* Flink;
+    struct CXPLAT_LIST_ENTRY* Blink;
+} CXPLAT_LIST_ENTRY;
+
+#define CXPLAT_CONTAINING_RECORD(address, type, field) \
+    ((type *)((uint8_t*)(address) - offsetof(type, field)))
+
+inline
+void
+CxPlatListInitializeHead(
+    _Out_ CXPLAT_LIST_ENTRY* ListHead
+    )
+{
+    ListHead->Flink = ListHead->Blink = ListHead;
+}
+
+inline
+BOOLEAN
+CxPlatListIsEmpty(
+    _In_ const CXPLAT_LIST_ENTRY* ListHead
+    )
+{
+    return (BOOLEAN)(ListHead->Flink == ListHead);
+}
+
+inline
+void
+CxPlatListInsertHead(
+    _Inout_ CXPLAT_LIST_ENTRY* ListHead,
+    _Out_ CXPLAT_LIST_ENTRY* Entry
+    )
+{
+    CXPLAT_LIST_ENTRY* Flink = ListHead->Flink;
+    Entry->Flink = Flink;
+    Entry->Blink = ListHead;
+    Flink->Blink = Entry;
+    ListHead->Flink = Entry;
+}
+
+inline
+void
+CxPlatListInsertTail(
+    _Inout_ CXPLAT_LIST_ENTRY* ListHead,
+    _Out_ CXPLAT_LIST_ENTRY* Entry
+    )
+{
+    CXPLAT_LIST_ENTRY* Blink = ListHead->Blink;
+    Entry->Flink = ListHead;
+    Entry->Blink = Blink;
+    Blink->Flink = Entry;
+    ListHead->Blink = Entry;
+}
+
+//
+// Removes the entry from whatever list it's in. Returns TRUE if the list is
+// now empty.
+//
+inline
+BOOLEAN
+CxPlatListEntryRemove(
+    _Inout_ CXPLAT_LIST_ENTRY* Entry
+    )
+{
+    CXPLAT_LIST_ENTRY* Flink = Entry->Flink;
+    CXPLAT_LIST_ENTRY* Blink = Entry->Blink;
+    Blink->Flink = Flink;
+    Flink->Blink = Blink;
+    return (BOOLEAN)(Flink == Blink);
+}
+
+inline
+CXPLAT_LIST_ENTRY*
+CxPlatListRemoveHead(
+    _Inout_ CXPLAT_LIST_ENTRY* ListHead
+    )
+{
+    CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
+    (void)CxPlatListEntryRemove(Entry);
+    return Entry;
+}
+
+//
+// Appends all entries in Source to the tail of Destination, leaving Source
+// empty.
+//
+inline
+void
+CxPlatListMoveItems(
+    _Inout_ CXPLAT_LIST_ENTRY* Source,
+    _Inout_ CXPLAT_LIST_ENTRY* Destination
+    )
+{
+    if (!CxPlatListIsEmpty(Source)) {
+        Source->Flink->Blink = Destination->Blink;
+        Destination->Blink->Flink = Source->Flink;
+        Source->Blink->Flink = Destination;
+        Destination->Blink = Source->Blink;
+        CxPlatListInitializeHead(Source);
+    }
+}
+
+//
+// Timer Wheel Interfaces
+//
+// A hierarchical timing wheel for tracking large numbers of timers with O(1)
+// insert, reset and cancel. Each level has 64 slots; a slot at level N spans
+// 64^N ticks of ResolutionUs. Timers beyond the last level wait on an overflow
+// list. Timers never expire early, and at most one tick late relative to the
+// time passed to CxPlatTimerWheelProcessExpired.
+//
+// The wheel doesn't own any threads or locks; callers drive it with their own
+// notion of the current time and serialize access to it.
+//
+
+#define CXPLAT_TIMER_WHEEL_LEVELS       6
+#define CXPLAT_TIMER_WHEEL_SLOT_BITS    6
+#define CXPLAT_TIMER_WHEEL_SLOTS        (1 << CXPLAT_TIMER_WHEEL_SLOT_BITS)
+
+#define CXPLAT_TIMER_ENTRY_NOT_QUEUED   0xFF
+
+typedef struct CXPLAT_TIMER_ENTRY {
+
+    CXPLAT_LIST_ENTRY Link;
+
+    //
+    // Absolute expiration time, as passed to CxPlatTimerWheelInsert.
+    //
+    uint64_t ExpirationUs;
+
+    //
+    // Where the entry is queued, so cancel doesn't need to search.
+    //
+    uint8_t Level;
+    uint8_t Slot;
+
+} CXPLAT_TIMER_ENTRY;
+
+typedef struct CXPLAT_TIMER_WHEEL {
+
+    uint64_t ResolutionUs;
+
+    //
+    // The first tick that hasn't been processed yet.
+    //
+    uint64_t CurrentTick;
+
+    uint64_t TimerCount;
+
+    //
+    // Bitmap of non-empty slots, per level.
+    //
+    uint64_t Occupied[CXPLAT_TIMER_WHEEL_LEVELS];
+
+    CXPLAT_LIST_ENTRY Slots[CXPLAT_TIMER_WHEEL_LEVELS][CXPLAT_TIMER_WHEEL_SLOTS];
+
+    CXPLAT_LIST_ENTRY Overflow;
+
+} CXPLAT_TIMER_WHEEL;
+
+inline
+void
+CxPlatTimerEntryInitialize(
+    _Out_ CXPLAT_TIMER_ENTRY* Entry
+    )
+{
+    Entry->ExpirationUs = 0;
+    Entry->Level = CXPLAT_TIMER_ENTRY_NOT_QUEUED;
+    Entry->Slot = 0;
+}
+
+inline
+BOOLEAN
+CxPlatTimerEntryIsQueued(
+    _In_ const CXPLAT_TIMER_ENTRY* Entry
+    )
+{
+    return (BOOLEAN)(Entry->Level != CXPLAT_TIMER_ENTRY_NOT_QUEUED);
+}
+
+void
+CxPlatTimerWheelInitialize(
+    _Out_ CXPLAT_TIMER_WHEEL* Wheel,
+    _In_ uint32_t ResolutionUs,
+    _In_ uint64_t NowUs
+    );
+
+void
+CxPlatTimerWheelUninitialize(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel
+    );
+
+//
+// Queues the entry to expire at ExpirationUs, first removing it if it's
+// already queued.
+//
+void
+CxPlatTimerWheelInsert(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _Inout_ CXPLAT_TIMER_ENTRY* Entry,
+    _In_ uint64_t ExpirationUs
+    );
+
+//
+// Removes the entry if it's queued. No-op otherwise.
+//
+void
+CxPlatTimerWheelCancel(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _Inout_ CXPLAT_TIMER_ENTRY* Entry
+    );
+
+//
+// Returns the next time the wheel needs processing, or UINT64_MAX if it is
+// empty. This may be earlier than the next timer's expiration when timers on
+// a higher level need to be moved down, but is never later.
+//
+uint64_t
+CxPlatTimerWheelNextExpirationUs(
+    _In_ const CXPLAT_TIMER_WHEEL* Wheel
+    );
+
+//
+// Moves every timer that has expired as of NowUs to the tail of ExpiredList,
+// in expiration order, and returns how many there were.
+//
+uint32_t
+CxPlatTimerWheelProcessExpired(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _In_ uint64_t NowUs,
+    _Inout_ CXPLAT_LIST_ENTRY* ExpiredList
+    );
+
+//
+// Timer Interfaces
+//
+// One-shot timers with callbacks dispatched on a per-processor timer thread.
+// A timer's callback runs on the processor that last set it, so state touched
+// by both stays cache-hot. The timer threads are started by the first
+// CxPlatTimerCreate and stopped by the last CxPlatTimerDelete, or by
+// CxPlatUninitialize if that delete was made from a callback.
+//
+// Calls for a given timer must be serialized by the caller, but may be made
+// from its own callback.
+//
+
+typedef struct CXPLAT_TIMER CXPLAT_TIMER;
+
+//
+// Called by CxPlatInitialize and CxPlatUninitialize respectively. Every timer
+// must be deleted before uninitializing.
+//
+void
+CxPlatTimerServiceInitialize(
+    void
+    );
+
+void
+CxPlatTimerServiceUninitialize(
+    void
+    );
+
+typedef
+void
+(CXPLAT_TIMER_CALLBACK)(
+    _In_ CXPLAT_TIMER* Timer,
+    _In_opt_ void* Context
+    );
+
+CXPLAT_STATUS
+CxPlatTimerCreate(
+    _In_ CXPLAT_TIMER_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _Out_ CXPLAT_TIMER** Timer
+    );
+
+//
+// Cancels the timer and waits for any callback already running on another
+// thread to complete before freeing it.
+//
+void
+CxPlatTimerDelete(
+    _In_ CXPLAT_TIMER* Timer
+    );
+
+//
+// Arms the timer to fire DelayUs from now on the current processor, replacing
+// any previous expiration.
+//
+void
+CxPlatTimerSet(
+    _In_ CXPLAT_TIMER* Timer,
+    _In_ uint64_t DelayUs
+    );
+
+//
+// Like CxPlatTimerSet, but lets the timer fire up to ToleranceUs late so that
+// it can share a wakeup with other timers on the same processor. Within the
+// window, the expiration is moved to the thread's next wakeup if there is one,
+// otherwise to the coarsest power-of-two boundary, so timers with overlapping
+// windows tend to line up.
+//
+void
+CxPlatTimerSetWithTolerance(
+    _In_ CXPLAT_TIMER* Timer,
+    _In_ uint64_t DelayUs,
+    _In_ uint64_t ToleranceUs
+    );
+
+//
+// Returns TRUE if the timer was pending and will no longer fire. The callback
+// may still be running when this returns FALSE.
+//
+BOOLEAN
+CxPlatTimerCancel(
+    _In_ CXPLAT_TIMER* Timer
+    );
+
+typedef struct CXPLAT_TIMER_STATS {
+
+    //
+    // Number of times the timer threads have woken up.
+    //
+    uint64_t Wakeups;
+
+    //
+    // Number of timer callbacks invoked.
+    //
+    uint64_t Expirations;
+
+} CXPLAT_TIMER_STATS;
+
+//
+// Returns totals across all processors since the timer threads were started.
+// Sample twice and divide by the elapsed time for per-second rates.
+//
+void
+CxPlatTimerGetStats(
+    _Out_ CXPLAT_TIMER_STATS* Stats
+    );
+
+//
+// Coarse Time Interfaces
+//
+// CxPlatTimeCoarseUs64 returns the same time base as CxPlatTimeUs64, but only
+// accurate to within the ticker period. While the ticker is running, a read
+// is a single load of a process-global timestamp the ticker thread refreshes.
+// Otherwise it falls back to the cheapest platform clock with the same base.
+//
+// The ticker is reference counted; each successful CxPlatTimeCoarseStart must
+// be paired with a CxPlatTimeCoarseStop. If started more than once, the
+// shortest requested period is used. It isn't supported on 32-bit platforms,
+// where the timestamp can't be read atomically with a plain load.
+//
+
+#define CXPLAT_TIME_COARSE_DEFAULT_PERIOD_US 1000
+
+extern uint64_t CxPlatTimeCoarseCurrentUs;
+
+inline
+uint64_t
+CxPlatTimeCoarseUs64(
+    void
+    )
+{
+#if defined(_WIN64) || defined(__LP64__)
+    const uint64_t TimeUs = *(volatile uint64_t*)&CxPlatTimeCoarseCurrentUs;
+    if (TimeUs != 0) {
+        return TimeUs;
+    }
+#endif
+    return CxPlatInternalTimeCoarseUs64();
+}
+
+//
+// Called by CxPlatInitialize and CxPlatUninitialize respectively. The ticker
+// must be stopped before uninitializing.
+//
+void
+CxPlatTimeCoarseInitialize(
+    void
+    );
+
+void
+CxPlatTimeCoarseUninitialize(
+    void
+    );
+
+CXPLAT_STATUS
+CxPlatTimeCoarseStart(
+    _In_ uint32_t PeriodUs
+    );
+
+void
+CxPlatTimeCoarseStop(
+    void
+    );
+
+//
+// Epoch Time Interfaces
+//
+// Wall clock time since the Unix epoch, computed from the monotonic platform
+// clock plus an offset captured from the system wall clock. The offset is
+// refreshed every CXPLAT_TIME_EPOCH_RESYNC_US, so a read is normally just a
+// platform time read and a few loads, and wall clock adjustments show up
+// within that period. Between refreshes the result may drift from the system
+// wall clock by however much the two clocks' rates differ.
+//
+// Resolution is that of the platform clock, which may be coarser than a
+// nanosecond.
+//
+
+#define CXPLAT_TIME_EPOCH_RESYNC_US (1000 * 1000)
+
+uint64_t
+CxPlatTimeEpochNs64(
+    void
+    );
+
+uint64_t
+CxPlatTimeEpochUs64(
+    void
+    );
+
+//
+// Deadline Sleep Interfaces
+//
+// Deadlines are absolute, in the CxPlatTimeUs64 time base.
+//
+// The precise variants sleep for the bulk of the interval and then spin for
+// the rest, so they return within a few microseconds of the deadline even
+// when the OS sleep overshoots. The spin margin tracks a moving average of the
+// observed overshoot, so it adapts to the machine's load.
+//
+
+void
+CxPlatSleepUntil(
+    _In_ uint64_t DeadlineUs
+    );
+
+void
+CxPlatSleepUntilPrecise(
+    _In_ uint64_t DeadlineUs
+    );
+
+void
+CxPlatSleepUsPrecise(
+    _In_ uint64_t DurationUs
+    );
+
+//
+// Scheduler Interfaces
+//
+// Runs one-shot and periodic task callbacks on a small set of dedicated
+// threads, always picking the task with the earliest deadline next. Periodic
+// deadlines advance by whole periods from the previous deadline, so they
+// don't drift; if a run is so late that whole periods have passed, those
+// periods are skipped rather than run back to back.
+//
+// Callbacks are passed how late they are running. A task never runs on more
+// than one thread at a time.
+//
+// Calls for a given task must be serialized by the caller, but may be made
+// from its own callback. All tasks must be deleted before their scheduler.
+//
+
+typedef struct CXPLAT_SCHEDULER CXPLAT_SCHEDULER;
+typedef struct CXPLAT_SCHEDULER_TASK CXPLAT_SCHEDULER_TASK;
+
+typedef
+void
+(CXPLAT_SCHEDULER_TASK_CALLBACK)(
+    _In_ CXPLAT_SCHEDULER_TASK* Task,
+    _In_opt_ void* Context,
+    _In_ uint64_t LatenessUs
+    );
+
+//
+// Creates a scheduler with ThreadCount threads (at least one), created with
+// ThreadFlags. Affinitized threads are spread across processors in order.
+//
+CXPLAT_STATUS
+CxPlatSchedulerCreate(
+    _In_ uint32_t ThreadCount,
+    _In_ uint16_t ThreadFlags,
+    _Out_ CXPLAT_SCHEDULER** Scheduler
+    );
+
+void
+CxPlatSchedulerDelete(
+    _In_ CXPLAT_SCHEDULER* Scheduler
+    );
+
+CXPLAT_STATUS
+CxPlatSchedulerTaskCreate(
+    _In_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ CXPLAT_SCHEDULER_TASK_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _Out_ CXPLAT_SCHEDULER_TASK** Task
+    );
+
+//
+// Cancels the task and waits for a running callback to complete, unless
+// called from that callback.
+//
+void
+CxPlatSchedulerTaskDelete(
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    );
+
+//
+// Schedules the task to run after DelayUs, then every PeriodUs after that, or
+// only once if PeriodUs is zero. Replaces any previous schedule.
+//
+void
+CxPlatSchedulerTaskStart(
+    _In_ CXPLAT_SCHEDULER_TASK* Task,
+    _In_ uint64_t DelayUs,
+    _In_ uint64_t PeriodUs
+    );
+
+//
+// Stops the task from running again. Returns TRUE if it was scheduled. A
+// callback that's already running isn't waited for.
+//
+BOOLEAN
+CxPlatSchedulerTaskCancel(
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    );
+
+typedef struct CXPLAT_SCHEDULER_STATS {
+
+    uint64_t Runs;
+
+    //
+    // Total and worst time between a task's deadline and its callback
+    // starting.
+    //
+    uint64_t TotalLatenessUs;
+    uint64_t MaxLatenessUs;
+
+    //
+    // Periods skipped because a periodic task ran more than a period late.
+    //
+    uint64_t MissedPeriods;
+
+} CXPLAT_SCHEDULER_STATS;
+
+void
+CxPlatSchedulerGetStats(
+    _In_ CXPLAT_SCHEDULER* Scheduler,
+    _Out_ CXPLAT_SCHEDULER_STATS* Stats
+    );
+
+//
+// Thread Pool Interfaces
+//
+// A work-stealing thread pool with one worker per processor, each
+// affinitized to its processor. Work submitted from a worker goes on that
+// worker's own lock-free deque; work submitted from anywhere else goes on a
+// shared queue. Workers run their own newest work first, then take from the
+// shared queue, then steal the oldest work from other workers, and only park
+// when all of those are empty.
+//
+// Work items are owned by the caller and must stay valid until their
+// callback runs. The pool doesn't touch an item once its callback has been
+// called, so the callback may free or resubmit it. To wait for work to
+// complete, submit it as part of a group.
+//
+
+typedef struct CXPLAT_THREAD_POOL CXPLAT_THREAD_POOL;
+
+typedef
+void
+(CXPLAT_THREAD_POOL_CALLBACK)(
+    _In_opt_ void* Context
+    );
+
+typedef struct CXPLAT_THREAD_POOL_GROUP {
+
+    //
+    // Work submitted as part of the group that hasn't completed yet, plus one
+    // that is dropped only while waiting.
+    //
+    long Outstanding;
+
+    //
+    // Set by whoever drops Outstanding to zero, unless a worker is waiting.
+    //
+    CXPLAT_EVENT Done;
+
+    //
+    // The doorbell of the worker waiting on the group, if any, which is rung
+    // instead once Completed is set.
+    //
+    struct CXPLAT_DOORBELL* Waiter;
+    long Completed;
+
+} CXPLAT_THREAD_POOL_GROUP;
+
+typedef struct CXPLAT_THREAD_POOL_WORK {
+
+    //
+    // Links the item into the shared queue.
+    //
+    CXPLAT_LIST_ENTRY Link;
+
+    CXPLAT_THREAD_POOL_CALLBACK* Callback;
+    void* Context;
+    CXPLAT_THREAD_POOL_GROUP* Group;
+
+} CXPLAT_THREAD_POOL_WORK;
+
+CXPLAT_STATUS
+CxPlatThreadPoolCreate(
+    _Out_ CXPLAT_THREAD_POOL** Pool
+    );
+
+//
+// Runs any work that's still queued, then stops the workers.
+//
+void
+CxPlatThreadPoolDelete(
+    _In_ CXPLAT_THREAD_POOL* Pool
+    );
+
+inline
+void
+CxPlatThreadPoolWorkInitialize(
+    _Out_ CXPLAT_THREAD_POOL_WORK* Work,
+    _In_ CXPLAT_THREAD_POOL_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _In_opt_ CXPLAT_THREAD_POOL_GROUP* Group
+    )
+{
+    Work->Link.Flink = Work->Link.Blink = NULL;
+    Work->Callback = Callback;
+    Work->Context = Context;
+    Work->Group = Group;
+}
+
+void
+CxPlatThreadPoolSubmit(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _In_ CXPLAT_THREAD_POOL_WORK* Work
+    );
+
+inline
+void
+CxPlatThreadPoolGroupInitialize(
+    _Out_ CXPLAT_THREAD_POOL_GROUP* Group
+    )
+{
+    Group->Outstanding = 1;
+    CxPlatEventInitialize(&Group->Done, FALSE, FALSE);
+    Group->Waiter = NULL;
+    Group->Completed = FALSE;
+}
+
+inline
+void
+CxPlatThreadPoolGroupUninitialize(
+    _Inout_ CXPLAT_THREAD_POOL_GROUP* Group
+    )
+{
+    CXPLAT_DBG_ASSERT(Group->Outstanding == 1);
+    CxPlatEventUninitialize(Group->Done);
+}
+
+//
+// Waits for all work submitted as part of the group to complete. When called
+// from a worker, runs other queued work in the meantime, so work can wait on
+// work it submitted itself. Only one thread may wait on a group at a time.
+//
+void
+CxPlatThreadPoolGroupWait(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Inout_ CXPLAT_THREAD_POOL_GROUP* Group
+    );
+
+typedef struct CXPLAT_THREAD_POOL_STATS {
+
+    uint32_t WorkerCount;
+
+    //
+    // Workers parked on the idle stack, waiting for work.
+    //
+    uint32_t IdleCount;
+
+} CXPLAT_THREAD_POOL_STATS;
+
+void
+CxPlatThreadPoolGetStats(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Out_ CXPLAT_THREAD_POOL_STATS* Stats
+    );
+
+//
+// Thread Cache Interfaces
+//
+// Runs callbacks on their own thread without creating one each time. A
+// cached thread is held by the caller from start until release, much like a
+// thread from CxPlatThreadCreate is until it's deleted. Releasing it parks it
+// for the next caller instead of joining it. Parked threads are shared by the
+// whole process, up to four times the processor count in total; any beyond
+// that exit when released.
+//
+
+typedef struct CXPLAT_CACHED_THREAD CXPLAT_CACHED_THREAD;
+
+typedef
+void
+(CXPLAT_CACHED_THREAD_CALLBACK)(
+    _In_opt_ void* Context
+    );
+
+//
+// Called by CxPlatInitialize and CxPlatUninitialize respectively. Every cached
+// thread must be released before uninitializing.
+//
+void
+CxPlatThreadCacheInitialize(
+    void
+    );
+
+void
+CxPlatThreadCacheUninitialize(
+    void
+    );
+
+//
+// Runs the callback on a parked thread, or a new one if none are parked.
+//
+CXPLAT_STATUS
+CxPlatCachedThreadStart(
+    _In_ CXPLAT_CACHED_THREAD_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _Out_ CXPLAT_CACHED_THREAD** Thread
+    );
+
+void
+CxPlatCachedThreadWait(
+    _In_ CXPLAT_CACHED_THREAD* Thread
+    );
+
+//
+// Returns TRUE if the callback completed within the timeout.
+//
+BOOLEAN
+CxPlatCachedThreadWaitWithTimeout(
+    _In_ CXPLAT_CACHED_THREAD* Thread,
+    _In_ uint32_t TimeoutMs
+    );
+
+//
+// Waits for the callback to complete, then hands the thread back to the
+// cache. The caller must not use the thread afterwards.
+//
+void
+CxPlatCachedThreadRelease(
+    _In_ CXPLAT_CACHED_THREAD* Thread
+    );
+
+//
+// Execution Context Interfaces
+//
+// A worker pool runs one affinitized event loop thread per processor. Each
+// execution context is registered with one worker and only ever run by that
+// worker's thread, so state owned by the context needs no locking.
+//
+// Every pass of the loop runs each context that has been woken or whose
+// NextTimeUs has arrived. Run returns FALSE to unregister the context, after
+// which the worker doesn't touch it again. When no context has anything to
+// do, the worker sleeps until the earliest NextTimeUs or the next wake.
+//
+
+typedef struct CXPLAT_EXECUTION_CONTEXT CXPLAT_EXECUTION_CONTEXT;
+typedef struct CXPLAT_WORKER_POOL CXPLAT_WORKER_POOL;
+
+typedef struct CXPLAT_EXECUTION_STATE {
+
+    //
+    // When the current pass of the loop started.
+    //
+    uint64_t TimeNowUs;
+
+    //
+    // Consecutive passes in which no context had anything to do.
+    //
+    uint32_t NoWorkCount;
+
+    uint32_t ProcIndex;
+
+    CXPLAT_THREAD_ID ThreadId;
+
+} CXPLAT_EXECUTION_STATE;
+
+typedef
+BOOLEAN
+(CXPLAT_EXECUTION_CONTEXT_RUN)(
+    _Inout_ CXPLAT_EXECUTION_CONTEXT* Context,
+    _In_ const CXPLAT_EXECUTION_STATE* State
+    );
+
+struct CXPLAT_EXECUTION_CONTEXT {
+
+    //
+    // Internal to the worker.
+    //
+    CXPLAT_LIST_ENTRY Link;
+    void* Worker;
+    long Ready;
+
+    CXPLAT_EXECUTION_CONTEXT_RUN* Run;
+
+    void* Context;
+
+    //
+    // When the context next needs to run without being woken, or UINT64_MAX
+    // if never. Only updated from Run.
+    //
+    uint64_t NextTimeUs;
+
+};
+
+inline
+void
+CxPlatExecutionContextInitialize(
+    _Out_ CXPLAT_EXECUTION_CONTEXT* Context,
+    _In_ CXPLAT_EXECUTION_CONTEXT_RUN* Run,
+    _In_opt_ void* UserContext
+    )
+{
+    Context->Link.Flink = Context->Link.Blink = NULL;
+    Context->Worker = NULL;
+    Context->Ready = FALSE;
+    Context->Run = Run;
+    Context->Context = UserContext;
+    Context->NextTimeUs = UINT64_MAX;
+}
+
+CXPLAT_STATUS
+CxPlatWorkerPoolCreate(
+    _Out_ CXPLAT_WORKER_POOL** Pool
+    );
+
+//
+// Stops the workers. Contexts still registered are dropped without being run
+// again.
+//
+void
+CxPlatWorkerPoolDelete(
+    _In_ CXPLAT_WORKER_POOL* Pool
+    );
+
+//
+// Registers the context with the worker for the given processor. It's run
+// once right away.
+//
+void
+CxPlatWorkerPoolAddExecutionContext(
+    _In_ CXPLAT_WORKER_POOL* Pool,
+    _Inout_ CXPLAT_EXECUTION_CONTEXT* Context,
+    _In_ uint32_t ProcIndex
+    );
+
+//
+// Makes the context run on its worker's next pass. May be called from any
+// thread; wakes coalesce until the context runs.
+//
+void
+CxPlatWakeExecutionContext(
+    _In_ CXPLAT_EXECUTION_CONTEXT* Context
+    );
+
+//
+// Rundown Protection Interfaces
+//
+// Rundown protection guards an object that may be torn down while other
+// threads are still using it. Users call Acquire before touching the object
+// and Release when done. Once Wait is called, all new Acquire calls fail and
+// Wait returns only after every outstanding reference has been released.
+//
+// The CacheAware variant keeps a separate count per processor so that Acquire
+// and Release on hot paths don't bounce a shared cache line between cores. A
+// reference may be released on a different processor than it was acquired on.
+//
+
+#ifndef _KERNEL_MODE
+
+#define CXPLAT_RUNDOWN_ACTIVE       0x1
+#define CXPLAT_RUNDOWN_COUNT_INC    0x2
+
+typedef struct CXPLAT_RUNDOWN_REF {
+
+    //
+    // Number of outstanding references (in units of CXPLAT_RUNDOWN_COUNT_INC),
+    // with CXPLAT_RUNDOWN_ACTIVE set once rundown has started.
+    //
+    int64_t Count;
+
+    //
+    // Signaled when the last reference is released during rundown.
+    //
+    CXPLAT_EVENT RundownComplete;
+
+} CXPLAT_RUNDOWN_REF;
+
+inline
+void
+CxPlatRundownInitialize(
+    _Out_ CXPLAT_RUNDOWN_REF* Rundown
+    )
+{
+    Rundown->Count = 0;
+    CxPlatEventInitialize(&Rundown->RundownComplete, FALSE, FALSE);
+}
+
+inline
+void
+CxPlatRundownUninitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    )
+{
+    CxPlatEventUninitialize(Rundown->RundownComplete);
+}
+
+//
+// Allows the rundown to be acquired again after a completed wait.
+//
+inline
+void
+CxPlatRundownReinitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    )
+{
+    CXPLAT_DBG_ASSERT(Rundown->Count == CXPLAT_RUNDOWN_ACTIVE);
+    Rundown->Count = 0;
+}
+
+inline
+BOOLEAN
+CxPlatInternalRundownCountAcquire(
+    _Inout_ int64_t* Count
+    )
+{
+    int64_t Value = *(volatile int64_t*)Count;
+    while (!(Value & CXPLAT_RUNDOWN_ACTIVE)) {
+        const int64_t Prev =
+            InterlockedCompareExchange64(Count, Value + CXPLAT_RUNDOWN_COUNT_INC, Value);
+        if (Prev == Value) {
+            return TRUE;
+        }
+        Value = Prev;
+    }
+    return FALSE;
+}
+
+inline
+BOOLEAN
+CxPlatRundownAcquire(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    )
+{
+    return CxPlatInternalRundownCountAcquire(&Rundown->Count);
+}
+
+inline
+void
+CxPlatRundownRelease(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    )
+{
+    const int64_t Value =
+        InterlockedExchangeAdd64(&Rundown->Count, -CXPLAT_RUNDOWN_COUNT_INC);
+    CXPLAT_DBG_ASSERT(Value >= CXPLAT_RUNDOWN_COUNT_INC);
+    if (Value == CXPLAT_RUNDOWN_COUNT_INC + CXPLAT_RUNDOWN_ACTIVE) {
+        CxPlatEventSet(Rundown->RundownComplete);
+    }
+}
+
+//
+// Blocks new acquires and waits for all outstanding references to be released.
+//
+inline
+void
+CxPlatRundownWait(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    )
+{
+    int64_t Value = *(volatile int64_t*)&Rundown->Count;
+    for (;;) {
+        CXPLAT_DBG_ASSERT(!(Value & CXPLAT_RUNDOWN_ACTIVE));
+        const int64_t Prev =
+            InterlockedCompareExchange64(
+                &Rundown->Count, Value | CXPLAT_RUNDOWN_ACTIVE, Value);
+        if (Prev == Value) {
+            break;
+        }
+        Value = Prev;
+    }
+    if (Value != 0) {
+        CxPlatEventWaitForever(Rundown->RundownComplete);
+    }
+}
+
+typedef struct CXPLAT_RUNDOWN_REF_SHARD {
+    int64_t Count;
+    uint8_t Reserved[CXPLAT_CACHE_LINE_SIZE - sizeof(int64_t)];
+} CXPLAT_RUNDOWN_REF_SHARD;
+
+typedef struct CXPLAT_RUNDOWN_REF_CACHE_AWARE {
+
+    //
+    // One count per processor, each in its own cache line. Counts are only
+    // meaningful in aggregate, so an individual shard may go negative when a
+    // reference is released on a different processor than it was acquired.
+    //
+    CXPLAT_RUNDOWN_REF_SHARD* Shards;
+    uint32_t ShardCount;
+
+    //
+    // Number of references still outstanding once rundown has started.
+    //
+    int64_t Remaining;
+
+    //
+    // Signaled when the last reference is released during rundown.
+    //
+    CXPLAT_EVENT RundownComplete;
+
+} CXPLAT_RUNDOWN_REF_CACHE_AWARE;
+
+CXPLAT_STATUS
+CxPlatRundownCacheAwareInitialize(
+    _Out_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    );
+
+void
+CxPlatRundownCacheAwareUninitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    );
+
+void
+CxPlatRundownCacheAwareReinitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    );
+
+void
+CxPlatRundownCacheAwareWait(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    );
+
+inline
+BOOLEAN
+CxPlatRundownCacheAwareAcquire(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    CXPLAT_DBG_ASSERT(CxPlatProcCurrentNumber() < Rundown->ShardCount);
+    return
+        CxPlatInternalRundownCountAcquire(
+            &Rundown->Shards[CxPlatProcCurrentNumber()].Count);
+}
+
+inline
+void
+CxPlatRundownCacheAwareRelease(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    CXPLAT_DBG_ASSERT(CxPlatProcCurrentNumber() < Rundown->ShardCount);
+    int64_t* Count = &Rundown->Shards[CxPlatProcCurrentNumber()].Count;
+    int64_t Value = *(volatile int64_t*)Count;
+    while (!(Value & CXPLAT_RUNDOWN_ACTIVE)) {
+        const int64_t Prev =
+            InterlockedCompareExchange64(Count, Value - CXPLAT_RUNDOWN_COUNT_INC, Value);
+        if (Prev == Value) {
+            return;
+        }
+        Value = Prev;
+    }
+
+    //
+    // This shard has already been frozen by the rundown wait, so the reference
+    // is accounted against the aggregate remaining count instead.
+    //
+    if (InterlockedDecrement64(&Rundown->Remaining) == 0) {
+        CxPlatEventSet(Rundown->RundownComplete);
+    }
+}
+
+#endif // _KERNEL_MODE
+
+//
+// Doorbell Interfaces
+//
+// A doorbell is a coalescing wakeup channel between any number of producers
+// and a single consumer. Ring is a single atomic add unless the consumer is
+// parked, in which case it also sets the consumer's event. Wait returns the
+// number of rings since the last Wait, blocking only if there were none.
+//
+
+#define CXPLAT_DOORBELL_PARKED  0x1
+#define CXPLAT_DOORBELL_RING    0x2
+
+typedef struct CXPLAT_DOORBELL {
+
+    //
+    // Number of pending rings (in units of CXPLAT_DOORBELL_RING), with
+    // CXPLAT_DOORBELL_PARKED set while the consumer is blocked.
+    //
+    int64_t State;
+
+    //
+    // Auto-reset event the consumer blocks on while parked.
+    //
+    CXPLAT_EVENT Event;
+
+} CXPLAT_DOORBELL;
+
+inline
+void
+CxPlatDoorbellInitialize(
+    _Out_ CXPLAT_DOORBELL* Doorbell
+    )
+{
+    Doorbell->State = 0;
+    CxPlatEventInitialize(&Doorbell->Event, FALSE, FALSE);
+}
+
+inline
+void
+CxPlatDoorbellUninitialize(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    )
+{
+    CxPlatEventUninitialize(Doorbell->Event);
+}
+
+inline
+void
+CxPlatDoorbellRing(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    )
+{
+    //
+    // Only the ring that finds the consumer parked with nothing pending needs
+    // to wake it; any later rings are collected by the same wake.
+    //
+    if (InterlockedExchangeAdd64(&Doorbell->State, CXPLAT_DOORBELL_RING) ==
+        CXPLAT_DOORBELL_PARKED) {
+        CxPlatEventSet(Doorbell->Event);
+    }
+}
+
+//
+// Returns the number of pending rings without blocking, or zero if none.
+//
+uint32_t
+CxPlatDoorbellDrain(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    );
+
+//
+// Blocks until the doorbell has been rung and returns the number of rings.
+//
+uint32_t
+CxPlatDoorbellWait(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    );
+
+//
+// Returns zero if the timeout elapsed without a ring.
+//
+uint32_t
+CxPlatDoorbellWaitWithTimeoutUs(
+    _Inout_ CXPLAT_DOORBELL* Doorbell,
+    _In_ uint64_t TimeoutUs
+    );
+
+//
+// Wait On Address Interfaces
+//
+// Blocks the calling thread while the value at Address equals CompareValue,
+// until another thread calls one of the Wake functions on the same address.
+// Wakes may be spurious, so callers must re-check their condition in a loop.
+// No per-waiter state is allocated. Not supported in kernel mode.
+//
+
+#ifndef _KERNEL_MODE
+
+void
+CxPlatWaitOnAddressForever(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue
+    );
+
+//
+// Returns FALSE if the timeout elapsed without a wake.
+//
+BOOLEAN
+CxPlatWaitOnAddressWithTimeoutUs(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue,
+    _In_ uint64_t TimeoutUs
+    );
+
+void
+CxPlatWakeByAddressSingle(
+    _In_ volatile uint32_t* Address
+    );
+
+void
+CxPlatWakeByAddressAll(
+    _In_ volatile uint32_t* Address
+    );
+
+#endif // _KERNEL_MODE
+
+//
+// Per-Processor Storage Interfaces
+//
+// One zero initialized slot of SlotSize bytes for each processor. Every slot
+// starts on its own cache line, so processors updating their own slot never
+// share lines with each other. With CXPLAT_NUMA_AWARE, each NUMA node's slots
+// are also placed in pages on that node.
+//
+// Aggregate by visiting every slot:
+//
+//     for (uint32_t i = 0; i < PerProc.Count; ++i) {
+//         Total += ((COUNTERS*)CxPlatPerProcGet(&PerProc, i))->Value;
+//     }
+//
+
+typedef struct CXPLAT_PER_PROC {
+
+    uint32_t Count;
+    uint32_t SlotSize;
+
+    void** Slots;
+
+} CXPLAT_PER_PROC;
+
+CXPLAT_STATUS
+CxPlatPerProcInitialize(
+    _Out_ CXPLAT_PER_PROC* PerProc,
+    _In_ uint32_t SlotSize
+    );
+
+void
+CxPlatPerProcUninitialize(
+    _Inout_ CXPLAT_PER_PROC* PerProc
+    );
+
+inline
+void*
+CxPlatPerProcGet(
+    _In_ const CXPLAT_PER_PROC* PerProc,
+    _In_ uint32_t ProcIndex
+    )
+{
+    CXPLAT_DBG_ASSERT(ProcIndex < PerProc->Count);
+    return PerProc->Slots[ProcIndex];
+}
+
+//
+// Returns the calling processor's slot. The caller may be moved to another
+// processor at any time, so the slot still needs interlocked updates unless
+// something else (e.g. affinitization) keeps the caller in place.
+//
+inline
+void*
+CxPlatPerProcGetCurrent(
+    _In_ const CXPLAT_PER_PROC* PerProc
+    )
+{
+    return PerProc->Slots[CxPlatProcCurrentNumber()];
+}
+
+//
+// Rate Limiter Interfaces
+//
+// A lock-free token bucket, implemented as a generic cell rate algorithm: the
+// bucket is a single "theoretical arrival time" updated with compare-exchange,
+// so there is no separate refill step.
+//
+// When CacheSize is non-zero, each processor takes tokens from the bucket in
+// batches of CacheSize and hands them out locally, so most acquires only touch
+// a per-processor cache line. Cached tokens count as spent, so over a short
+// window up to CacheSize tokens per processor can be in flight beyond the
+// burst size.
+//
+
+typedef struct CXPLAT_RATE_LIMITER_SHARD {
+    int64_t Tokens;
+    uint8_t Reserved[CXPLAT_CACHE_LINE_SIZE - sizeof(int64_t)];
+} CXPLAT_RATE_LIMITER_SHARD;
+
+//
+// Higher rates would overflow the limiter's 64-bit time arithmetic.
+//
+#define CXPLAT_RATE_LIMITER_MAX_RATE 1000000000000ull
+
+typedef struct CXPLAT_RATE_LIMITER {
+
+    //
+    // The time at which the bucket will be full again, in units of the time
+    // it takes to refill one token.
+    //
+    int64_t TheoreticalArrival;
+
+    uint64_t TokensPerSecond;
+    uint32_t Burst;
+    uint32_t CacheSize;
+
+    CXPLAT_RATE_LIMITER_SHARD* Shards;
+    uint32_t ShardCount;
+
+} CXPLAT_RATE_LIMITER;
+
+//
+// Starts with a full bucket of Burst tokens, refilled at TokensPerSecond.
+// Returns CXPLAT_STATUS_NOT_SUPPORTED if TokensPerSecond is zero or above
+// CXPLAT_RATE_LIMITER_MAX_RATE.
+//
+CXPLAT_STATUS
+CxPlatRateLimiterInitialize(
+    _Out_ CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint64_t TokensPerSecond,
+    _In_ uint32_t Burst,
+    _In_ uint32_t CacheSize
+    );
+
+void
+CxPlatRateLimiterUninitialize(
+    _Inout_ CXPLAT_RATE_LIMITER* Limiter
+    );
+
+//
+// Takes Tokens from the bucket if they're all available, otherwise takes none
+// and returns FALSE.
+//
+BOOLEAN
+CxPlatRateLimiterTryAcquire(
+    _Inout_ CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint32_t Tokens
+    );
+
+//
+// Returns how long until Tokens will be available, or zero if they already
+// are. Returns UINT64_MAX if Tokens exceeds the burst size.
+//
+uint64_t
+CxPlatRateLimiterTimeUntilUs(
+    _In_ const CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint32_t Tokens
+    );
+
+//
+// Histogram Interfaces
+//
+// A log-linear histogram of non-negative integer values, in the style of
+// HdrHistogram. Each power of two range is split into 2^SignificantBits
+// linear buckets, so every recorded value is accurate to within a relative
+// error of 2^-SignificantBits. Values at or above 2^MaxValueBits are counted
+// in the last bucket. Out of range parameters are clamped.
+//
+// Recording is wait-free: each processor has its own set of counters, and
+// queries add them up. Memory use is therefore per processor, roughly
+// (MaxValueBits - SignificantBits + 1) << SignificantBits counters each.
+//
+
+#define CXPLAT_HISTOGRAM_MAX_SIGNIFICANT_BITS 12
+
+typedef struct CXPLAT_HISTOGRAM {
+
+    uint32_t SignificantBits;
+    uint32_t MaxValueBits;
+    uint32_t BucketCount;
+
+    //
+    // Counters per shard: one per bucket, followed by the sum of the recorded
+    // values. Padded so shards don't share cache lines.
+    //
+    uint32_t ShardStride;
+    uint32_t ShardCount;
+    int64_t* Shards;
+
+} CXPLAT_HISTOGRAM;
+
+CXPLAT_STATUS
+CxPlatHistogramInitialize(
+    _Out_ CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint32_t SignificantBits,
+    _In_ uint32_t MaxValueBits
+    );
+
+void
+CxPlatHistogramUninitialize(
+    _Inout_ CXPLAT_HISTOGRAM* Histogram
+    );
+
+void
+CxPlatHistogramRecord(
+    _Inout_ CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint64_t Value
+    );
+
+//
+// Clears all counts. Values recorded concurrently may or may not be kept.
+//
+void
+CxPlatHistogramReset(
+    _Inout_ CXPLAT_HISTOGRAM* Histogram
+    );
+
+//
+// Adds Source's counts into Destination, which must have been initialized
+// with the same SignificantBits and MaxValueBits. To take a snapshot, reset
+// an idle histogram and merge into it.
+//
+void
+CxPlatHistogramMerge(
+    _Inout_ CXPLAT_HISTOGRAM* Destination,
+    _In_ const CXPLAT_HISTOGRAM* Source
+    );
+
+uint64_t
+CxPlatHistogramCount(
+    _In_ const CXPLAT_HISTOGRAM* Histogram
+    );
+
+//
+// Returns the mean of the recorded values, or zero if there are none.
+//
+uint64_t
+CxPlatHistogramMean(
+    _In_ const CXPLAT_HISTOGRAM* Histogram
+    );
+
+//
+// Returns the value at or below which PercentilePpm parts per million of the
+// recorded values fall (e.g. 999000 for p99.9), reported as the largest value
+// sharing its bucket. Returns zero if nothing has been recorded.
+//
+uint64_t
+CxPlatHistogramValueAtPercentile(
+    _In_ const CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint32_t PercentilePpm
+    );
+
 #if defined(__cplusplus)
 }
 #endif
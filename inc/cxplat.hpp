@@ -73,8 +73,90 @@ struct CxPlatEvent {
     void Reset() { CxPlatEventReset(Handle); }
     void WaitForever() { CxPlatEventWaitForever(Handle); }
     bool WaitTimeout(uint32_t TimeoutMs) { return CxPlatEventWaitWithTimeout(Handle, TimeoutMs); }
+    bool WaitTimeoutUs(uint64_t TimeoutUs) { return CxPlatEventWaitWithTimeoutUs(Handle, TimeoutUs); }
+    void WaitWithSpin(uint32_t SpinCount = CXPLAT_EVENT_DEFAULT_SPIN_COUNT) { CxPlatEventWaitWithSpin(Handle, SpinCount); }
 };
 
+struct CxPlatDoorbell {
+    CXPLAT_DOORBELL Handle;
+    CxPlatDoorbell() noexcept { CxPlatDoorbellInitialize(&Handle); }
+    ~CxPlatDoorbell() noexcept { CxPlatDoorbellUninitialize(&Handle); }
+    void Ring() noexcept { CxPlatDoorbellRing(&Handle); }
+    uint32_t Drain() noexcept { return CxPlatDoorbellDrain(&Handle); }
+    uint32_t Wait() noexcept { return CxPlatDoorbellWait(&Handle); }
+    uint32_t WaitTimeoutUs(uint64_t TimeoutUs) noexcept { return CxPlatDoorbellWaitWithTimeoutUs(&Handle, TimeoutUs); }
+};
+
+struct CxPlatThreadPool {
+    CXPLAT_THREAD_POOL* Handle {nullptr};
+    CxPlatThreadPool() noexcept {
+        if (CXPLAT_FAILED(CxPlatThreadPoolCreate(&Handle))) {
+            Handle = nullptr;
+        }
+    }
+    ~CxPlatThreadPool() noexcept { if (Handle) { CxPlatThreadPoolDelete(Handle); } }
+    bool IsValid() const noexcept { return Handle != nullptr; }
+    operator CXPLAT_THREAD_POOL*() const noexcept { return Handle; }
+    void Submit(CXPLAT_THREAD_POOL_WORK* Work) noexcept { CxPlatThreadPoolSubmit(Handle, Work); }
+};
+
+struct CxPlatThreadPoolGroup {
+    CXPLAT_THREAD_POOL_GROUP Handle;
+    CxPlatThreadPoolGroup() noexcept { CxPlatThreadPoolGroupInitialize(&Handle); }
+    ~CxPlatThreadPoolGroup() noexcept { CxPlatThreadPoolGroupUninitialize(&Handle); }
+    operator CXPLAT_THREAD_POOL_GROUP*() noexcept { return &Handle; }
+    void Wait(CXPLAT_THREAD_POOL* Pool) noexcept { CxPlatThreadPoolGroupWait(Pool, &Handle); }
+};
+
+//
+// Per-processor storage of T. Slots start zeroed and T's constructors and
+// destructor are never run, so T must be usable from all zero bytes.
+//
+template <typename T>
+class CxPlatPerProc {
+private:
+    CXPLAT_PER_PROC Handle;
+    bool Initialized;
+public:
+    CxPlatPerProc() noexcept {
+        Initialized = CXPLAT_SUCCEEDED(CxPlatPerProcInitialize(&Handle, sizeof(T)));
+    }
+    ~CxPlatPerProc() noexcept { if (Initialized) { CxPlatPerProcUninitialize(&Handle); } }
+    CxPlatPerProc(const CxPlatPerProc&) = delete;
+    CxPlatPerProc& operator=(const CxPlatPerProc&) = delete;
+    bool IsValid() const noexcept { return Initialized; }
+    uint32_t Count() const noexcept { return Handle.Count; }
+    T* Current() const noexcept { return (T*)CxPlatPerProcGetCurrent(&Handle); }
+    T* operator[](uint32_t ProcIndex) const noexcept { return (T*)CxPlatPerProcGet(&Handle, ProcIndex); }
+};
+
+template <typename T>
+class CxPlatThreadPoolWorkT {
+private:
+    typedef void CallbackT(_Inout_ T* Context);
+
+    static void WorkCallback(_In_opt_ void* Context) {
+        auto Work = (CxPlatThreadPoolWorkT*)Context;
+        Work->UserCallback(Work->UserContext);
+    }
+
+    CXPLAT_THREAD_POOL_WORK Handle;
+    CallbackT* UserCallback;
+    T* UserContext;
+public:
+    CxPlatThreadPoolWorkT(
+        CallbackT Callback,
+        T* UserContext = nullptr,
+        CXPLAT_THREAD_POOL_GROUP* Group = nullptr
+        ) noexcept : UserCallback(Callback), UserContext(UserContext) {
+        CxPlatThreadPoolWorkInitialize(&Handle, WorkCallback, this, Group);
+    }
+
+    void Submit(CXPLAT_THREAD_POOL* Pool) noexcept { CxPlatThreadPoolSubmit(Pool, &Handle); }
+};
+
+typedef CxPlatThreadPoolWorkT<void> CxPlatThreadPoolWork;
+
 template <typename T>
 class CxPlatAsyncT {
 private:
@@ -85,48 +167,789 @@ private:
         CallbackT *UserCallback;
     };
 
-    static CXPLAT_THREAD_CALLBACK(ThreadCallback, Context) {
+    static void ThreadCallback(void* Context) {
         auto AsyncContext = (ContextT*)Context;
         AsyncContext->UserCallback(AsyncContext->UserContext);
-        CXPLAT_THREAD_RETURN(0);
     }
 
     struct ContextT AsyncContext {0, 0};
-    CXPLAT_THREAD_CONFIG ThreadConfig {0, 0, "CxPlatAsync", ThreadCallback, &AsyncContext};
-    CXPLAT_THREAD Thread {0};
-    bool ThreadCompleted {false};
+    CXPLAT_CACHED_THREAD* Thread {nullptr};
     bool Initialized;
 public:
     CxPlatAsyncT(CallbackT Callback, T* UserContext = nullptr) noexcept
         : AsyncContext({UserContext, Callback}),
-          Initialized(CxPlatThreadCreate(&ThreadConfig, &Thread) == 0) {
+          Initialized(CxPlatCachedThreadStart(ThreadCallback, &AsyncContext, &Thread) == 0) {
     }
     ~CxPlatAsyncT() noexcept {
         if (Initialized) {
-            if (!ThreadCompleted) {
-                CxPlatThreadWaitForever(&Thread);
-            }
-            CxPlatThreadDelete(&Thread);
+            CxPlatCachedThreadRelease(Thread);
         }
     }
 
     void Wait() noexcept {
         if (Initialized) {
-            CxPlatThreadWaitForever(&Thread);
-            ThreadCompleted = true;
+            CxPlatCachedThreadWait(Thread);
         }
     }
 
-#if _WIN32
     bool WaitFor(uint32_t TimeoutMs) noexcept {
         if (Initialized) {
-            return (ThreadCompleted = CxPlatThreadWaitWithTimeout(&Thread, TimeoutMs));
+            return CxPlatCachedThreadWaitWithTimeout(Thread, TimeoutMs);
         }
         return false;
     }
-#endif // _WIN32
 };
 
 typedef CxPlatAsyncT<void> CxPlatAsync;
 
+
+//
+// Futures and continuations.
+//
+// A promise and its future share one allocation, which also holds the
+// future's continuation, if any. A continuation is queued to the promise's
+// thread pool once both it and the value are set, or run inline on the
+// completing thread if the promise has no pool. Then returns a future for
+// the continuation's result, which continues on the same pool, so work can
+// be pipelined without any thread blocking in between.
+//
+// Values and continuation callables are copied bytewise, so both must be
+// trivially copyable; lambdas capturing pointers and integers are. A future
+// can have at most one continuation. Futures of void carry no value; their
+// continuations take no arguments.
+//
+
+#define CXPLAT_FUTURE_CALLABLE_SIZE (8 * sizeof(void*))
+
+//
+// Stands in for the value of a void future.
+//
+struct CxPlatFutureVoid { };
+
+template <typename T>
+struct CxPlatFutureStorage {
+    typedef T Type;
+    enum { IsVoid = false };
+};
+
+template <>
+struct CxPlatFutureStorage<void> {
+    typedef CxPlatFutureVoid Type;
+    enum { IsVoid = true };
+};
+
+template <typename T>
+class CxPlatFutureState {
+public:
+    typedef typename CxPlatFutureStorage<T>::Type ValueT;
+
+private:
+    enum : long {
+        VALUE_SET = 0x1,
+        CONTINUATION_SET = 0x2,
+        EVENT_CLAIMED = 0x4, // A waiter is initializing Ready.
+        WAITER = 0x8         // Ready is initialized and SetValue must set it.
+    };
+
+    typedef void InvokeT(_Inout_ void* Callable, _In_ const ValueT* Value);
+
+    static void RunContinuation(_In_opt_ void* Context) {
+        auto State = (CxPlatFutureState*)Context;
+        State->Invoke(State->Callable, &State->Value);
+        State->Release();
+    }
+
+    void Continue() noexcept {
+        if (Pool == nullptr) {
+            RunContinuation(this);
+        } else {
+            CxPlatThreadPoolWorkInitialize(&Work, RunContinuation, this, nullptr);
+            CxPlatThreadPoolSubmit(Pool, &Work);
+        }
+    }
+
+    //
+    // Ready is only initialized once somebody has to block on it, so futures
+    // consumed purely through continuations never create an event. Returns
+    // false if the value is already set and there is nothing to wait for.
+    //
+    bool PrepareWait() noexcept {
+        if (IsReady()) {
+            return false;
+        }
+        long OldFlags = InterlockedOr(&Flags, EVENT_CLAIMED);
+        if (!(OldFlags & EVENT_CLAIMED)) {
+            CxPlatEventInitialize(&Ready, TRUE, FALSE);
+            OldFlags = InterlockedOr(&Flags, WAITER);
+        } else {
+            while (!((OldFlags = *(volatile long*)&Flags) & WAITER)) {
+                YieldProcessor();
+            }
+        }
+        return !(OldFlags & VALUE_SET);
+    }
+
+    long RefCount;
+    long Flags;
+    CXPLAT_THREAD_POOL* Pool;
+    CXPLAT_EVENT Ready;
+    ValueT Value;
+    CXPLAT_THREAD_POOL_WORK Work;
+    InvokeT* Invoke;
+    void* Callable[CXPLAT_FUTURE_CALLABLE_SIZE / sizeof(void*)];
+
+public:
+    static CxPlatFutureState* Create(_In_opt_ CXPLAT_THREAD_POOL* Pool) noexcept {
+        static_assert(__is_trivially_copyable(ValueT), "Future values must be trivially copyable");
+        auto State =
+            (CxPlatFutureState*)CXPLAT_ALLOC_NONPAGED(sizeof(CxPlatFutureState), CXPLAT_POOL_FUTURE);
+        if (State != nullptr) {
+            CxPlatZeroMemory(State, sizeof(*State));
+            State->RefCount = 1;
+            State->Pool = Pool;
+        }
+        return State;
+    }
+
+    CXPLAT_THREAD_POOL* GetPool() const noexcept { return Pool; }
+    bool IsReady() const noexcept { return (*(volatile long*)&Flags & VALUE_SET) != 0; }
+    const ValueT& GetValue() const noexcept { return Value; }
+
+    void Wait() noexcept {
+        if (PrepareWait()) {
+            CxPlatEventWaitForever(Ready);
+        }
+    }
+
+    bool WaitFor(uint32_t TimeoutMs) noexcept {
+        if (!PrepareWait()) {
+            return true;
+        }
+        return CxPlatEventWaitWithTimeout(Ready, TimeoutMs);
+    }
+
+    void AddRef() noexcept { InterlockedIncrement(&RefCount); }
+    void Release() noexcept {
+        if (InterlockedDecrement(&RefCount) == 0) {
+            if (Flags & WAITER) {
+                CxPlatEventUninitialize(Ready);
+            }
+            CXPLAT_FREE(this, CXPLAT_POOL_FUTURE);
+        }
+    }
+
+    //
+    // Whichever of these two comes second runs the continuation.
+    //
+    void SetValue(const ValueT& NewValue) noexcept {
+        CxPlatCopyMemory(&Value, &NewValue, sizeof(ValueT));
+        const long OldFlags = InterlockedOr(&Flags, VALUE_SET);
+        CXPLAT_DBG_ASSERT(!(OldFlags & VALUE_SET));
+        if (OldFlags & WAITER) {
+            CxPlatEventSet(Ready);
+        }
+        if (OldFlags & CONTINUATION_SET) {
+            Continue();
+        }
+    }
+
+    void SetContinuation(
+        _In_ InvokeT* NewInvoke,
+        _In_reads_bytes_(Size) const void* NewCallable,
+        _In_ size_t Size
+        ) noexcept {
+        CXPLAT_DBG_ASSERT(Size <= sizeof(Callable));
+        CxPlatCopyMemory(Callable, NewCallable, Size);
+        Invoke = NewInvoke;
+        AddRef(); // Released once the continuation has run.
+        const long OldFlags = InterlockedOr(&Flags, CONTINUATION_SET);
+        CXPLAT_DBG_ASSERT(!(OldFlags & CONTINUATION_SET));
+        if (OldFlags & VALUE_SET) {
+            Continue();
+        }
+    }
+};
+
+//
+// The type a continuation F returns when given a future's value, and how to
+// call it and complete the next future with its result, for each pairing of
+// void and non-void values.
+//
+template <typename T, typename F>
+struct CxPlatFutureResult {
+    typedef decltype((*(F*)nullptr)(*(const T*)nullptr)) Type;
+};
+
+template <typename F>
+struct CxPlatFutureResult<void, F> {
+    typedef decltype((*(F*)nullptr)()) Type;
+};
+
+template <typename T, typename U>
+struct CxPlatFutureInvoke {
+    template <typename F>
+    static void Run(F& Fn, const T* Value, CxPlatFutureState<U>* Next) noexcept {
+        Next->SetValue(Fn(*Value));
+    }
+};
+
+template <typename U>
+struct CxPlatFutureInvoke<void, U> {
+    template <typename F>
+    static void Run(F& Fn, const CxPlatFutureVoid*, CxPlatFutureState<U>* Next) noexcept {
+        Next->SetValue(Fn());
+    }
+};
+
+template <typename T>
+struct CxPlatFutureInvoke<T, void> {
+    template <typename F>
+    static void Run(F& Fn, const T* Value, CxPlatFutureState<void>* Next) noexcept {
+        Fn(*Value);
+        Next->SetValue(CxPlatFutureVoid());
+    }
+};
+
+template <>
+struct CxPlatFutureInvoke<void, void> {
+    template <typename F>
+    static void Run(F& Fn, const CxPlatFutureVoid*, CxPlatFutureState<void>* Next) noexcept {
+        Fn();
+        Next->SetValue(CxPlatFutureVoid());
+    }
+};
+
+template <typename T>
+class CxPlatFuture {
+private:
+    template <typename U> friend class CxPlatFuture;
+    template <typename U> friend class CxPlatPromise;
+
+    typedef typename CxPlatFutureState<T>::ValueT ValueT;
+
+    CxPlatFutureState<T>* State;
+
+    explicit CxPlatFuture(CxPlatFutureState<T>* State) noexcept : State(State) { }
+
+public:
+    CxPlatFuture() noexcept : State(nullptr) { }
+    CxPlatFuture(CxPlatFuture&& Other) noexcept : State(Other.State) { Other.State = nullptr; }
+    CxPlatFuture& operator=(CxPlatFuture&& Other) noexcept {
+        if (this != &Other) {
+            if (State) { State->Release(); }
+            State = Other.State;
+            Other.State = nullptr;
+        }
+        return *this;
+    }
+    CxPlatFuture(const CxPlatFuture&) = delete;
+    CxPlatFuture& operator=(const CxPlatFuture&) = delete;
+    ~CxPlatFuture() noexcept { if (State) { State->Release(); } }
+
+    bool IsValid() const noexcept { return State != nullptr; }
+    bool IsReady() const noexcept { return State->IsReady(); }
+    void Wait() noexcept { State->Wait(); }
+    bool WaitFor(uint32_t TimeoutMs) noexcept { return State->WaitFor(TimeoutMs); }
+    const ValueT& Get() noexcept { State->Wait(); return State->GetValue(); }
+
+    //
+    // Calls Fn with the value, or with no arguments for a void future, once
+    // it's set. Returns an invalid future if the continuation's state can't
+    // be allocated, in which case Fn never runs.
+    //
+    template <typename F>
+    auto Then(F Fn) noexcept -> CxPlatFuture<typename CxPlatFutureResult<T, F>::Type> {
+        typedef typename CxPlatFutureResult<T, F>::Type U;
+
+        struct Continuation {
+            F Fn;
+            CxPlatFutureState<U>* Next;
+            static void Invoke(_Inout_ void* Callable, _In_ const ValueT* Value) {
+                auto This = (Continuation*)Callable;
+                CxPlatFutureInvoke<T, U>::Run(This->Fn, Value, This->Next);
+                This->Next->Release();
+            }
+        };
+        static_assert(__is_trivially_copyable(F), "Continuations must be trivially copyable");
+        static_assert(sizeof(Continuation) <= CXPLAT_FUTURE_CALLABLE_SIZE, "Continuation too large");
+        static_assert(alignof(Continuation) <= alignof(void*), "Continuation over aligned");
+
+        CXPLAT_DBG_ASSERT(State != nullptr);
+        auto Next = CxPlatFutureState<U>::Create(State->GetPool());
+        if (Next == nullptr) {
+            return CxPlatFuture<U>();
+        }
+        Next->AddRef(); // One for the continuation, one for the returned future.
+        Continuation Cont = { Fn, Next };
+        State->SetContinuation(Continuation::Invoke, &Cont, sizeof(Cont));
+        return CxPlatFuture<U>(Next);
+    }
+};
+
+//
+// A promise that is destroyed without setting its value leaves its future
+// waiting forever.
+//
+template <typename T>
+class CxPlatPromise {
+private:
+    typedef typename CxPlatFutureState<T>::ValueT ValueT;
+
+    CxPlatFutureState<T>* State;
+    bool FutureRetrieved {false};
+
+public:
+    CxPlatPromise(_In_opt_ CXPLAT_THREAD_POOL* Pool = nullptr) noexcept
+        : State(CxPlatFutureState<T>::Create(Pool)) { }
+    CxPlatPromise(const CxPlatPromise&) = delete;
+    CxPlatPromise& operator=(const CxPlatPromise&) = delete;
+    ~CxPlatPromise() noexcept { if (State) { State->Release(); } }
+
+    bool IsValid() const noexcept { return State != nullptr; }
+
+    CxPlatFuture<T> GetFuture() noexcept {
+        CXPLAT_DBG_ASSERT(!FutureRetrieved);
+        FutureRetrieved = true;
+        State->AddRef();
+        return CxPlatFuture<T>(State);
+    }
+
+    void SetValue(const ValueT& Value) noexcept { State->SetValue(Value); }
+
+    void SetValue() noexcept {
+        static_assert(CxPlatFutureStorage<T>::IsVoid, "Only void promises can be set without a value");
+        State->SetValue(CxPlatFutureVoid());
+    }
+};
+
+
+//
+// Coroutines.
+//
+// CxPlatTask is an eagerly started coroutine that can be co_awaited by one
+// other coroutine, or waited on by one thread. Frames are allocated from the
+// cxplat allocator; if that fails the task is invalid and never runs.
+//
+// The awaitables suspend without blocking a thread and resume either inline
+// on the thread that unblocked them or, given a thread pool, on the pool:
+//
+//  - CxPlatCoEvent, a manual reset event whose waiters are coroutines. A
+//    CXPLAT_EVENT can only be waited on by blocking a thread.
+//  - CxPlatCoLock, a mutex handed directly from one coroutine to the next.
+//  - CxPlatCoTimer, which sleeps on a CXPLAT_TIMER and resumes on the pool.
+//  - CxPlatCoResumeOnPool, which moves the coroutine onto a thread pool.
+//  - CxPlatCoResumeOnProc, which moves the coroutine onto a given
+//    processor's worker in a CXPLAT_WORKER_POOL.
+//
+// Each awaitable keeps its waiter state in the awaiting coroutine's frame,
+// so suspending allocates nothing. Requires C++20; not available in kernel
+// mode.
+//
+
+#if !defined(_KERNEL_MODE) && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+
+#define CXPLAT_COROUTINES 1
+
+//
+// A coroutine suspended on one of the awaitables. Lives in the coroutine's
+// frame for as long as it is suspended.
+//
+struct CxPlatCoWaiter {
+    CXPLAT_LIST_ENTRY Link;
+    CXPLAT_THREAD_POOL_WORK Work;
+    std::coroutine_handle<> Handle;
+
+    static void ResumeCallback(_In_opt_ void* Context) {
+        ((CxPlatCoWaiter*)Context)->Handle.resume();
+    }
+
+    //
+    // Resumes inline, or on the pool if there is one. The waiter must not be
+    // touched afterwards, since the coroutine may already have freed it.
+    //
+    void Resume(_In_opt_ CXPLAT_THREAD_POOL* Pool) noexcept {
+        if (Pool == nullptr) {
+            Handle.resume();
+        } else {
+            CxPlatThreadPoolWorkInitialize(&Work, ResumeCallback, this, nullptr);
+            CxPlatThreadPoolSubmit(Pool, &Work);
+        }
+    }
+};
+
+template <typename T = void>
+class CxPlatTask;
+
+template <typename T>
+class CxPlatTaskPromise;
+
+class CxPlatTaskPromiseBase {
+private:
+    enum : long {
+        RUNNING,
+        AWAITED,
+        COMPLETED
+    };
+
+    long State {RUNNING};
+
+    //
+    // Whichever is set when the task is awaited.
+    //
+    std::coroutine_handle<> Continuation;
+    CXPLAT_EVENT* WaitEvent {nullptr};
+
+public:
+    static void* operator new(size_t Size) noexcept {
+        return CXPLAT_ALLOC_NONPAGED(Size, CXPLAT_POOL_COROUTINE);
+    }
+    static void operator delete(void* Frame) noexcept {
+        CXPLAT_FREE(Frame, CXPLAT_POOL_COROUTINE);
+    }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> Handle) noexcept {
+            CxPlatTaskPromiseBase& Promise = Handle.promise();
+            if (InterlockedExchange(&Promise.State, COMPLETED) == AWAITED) {
+                if (Promise.WaitEvent == nullptr) {
+                    return Promise.Continuation;
+                }
+                //
+                // The waiter may free the frame as soon as this is set.
+                //
+                CxPlatEventSet(*Promise.WaitEvent);
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() noexcept { }
+    };
+
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept {
+        CXPLAT_FRE_ASSERTMSG(FALSE, "Unhandled exception in coroutine");
+    }
+
+    bool IsCompleted() noexcept {
+        return InterlockedCompareExchange(&State, COMPLETED, COMPLETED) == COMPLETED;
+    }
+
+    //
+    // Returns false if the task has already completed, in which case the
+    // awaiting coroutine must not suspend.
+    //
+    bool SetContinuation(std::coroutine_handle<> Handle) noexcept {
+        Continuation = Handle;
+        return InterlockedCompareExchange(&State, AWAITED, RUNNING) == RUNNING;
+    }
+
+    void Wait() noexcept {
+        if (!IsCompleted()) {
+            CxPlatEvent Event;
+            WaitEvent = &Event.Handle;
+            if (InterlockedCompareExchange(&State, AWAITED, RUNNING) == RUNNING) {
+                Event.WaitForever();
+            }
+        }
+    }
+};
+
+template <typename T>
+class CxPlatTask {
+public:
+    typedef CxPlatTaskPromise<T> promise_type;
+
+private:
+    std::coroutine_handle<promise_type> Handle;
+
+public:
+    struct Awaiter {
+        std::coroutine_handle<promise_type> Handle;
+        bool await_ready() noexcept { return Handle.promise().IsCompleted(); }
+        bool await_suspend(std::coroutine_handle<> Awaiting) noexcept {
+            return Handle.promise().SetContinuation(Awaiting);
+        }
+        T await_resume() noexcept { return Handle.promise().Result(); }
+    };
+
+    CxPlatTask() noexcept : Handle(nullptr) { }
+    explicit CxPlatTask(std::coroutine_handle<promise_type> Handle) noexcept : Handle(Handle) { }
+    CxPlatTask(CxPlatTask&& Other) noexcept : Handle(Other.Handle) { Other.Handle = nullptr; }
+    CxPlatTask& operator=(CxPlatTask&& Other) noexcept {
+        if (this != &Other) {
+            if (Handle) {
+                Handle.promise().Wait();
+                Handle.destroy();
+            }
+            Handle = Other.Handle;
+            Other.Handle = nullptr;
+        }
+        return *this;
+    }
+    CxPlatTask(const CxPlatTask&) = delete;
+    CxPlatTask& operator=(const CxPlatTask&) = delete;
+
+    //
+    // Waits for the task to complete before freeing it.
+    //
+    ~CxPlatTask() noexcept {
+        if (Handle) {
+            Handle.promise().Wait();
+            Handle.destroy();
+        }
+    }
+
+    bool IsValid() const noexcept { return (bool)Handle; }
+    bool IsReady() const noexcept { return Handle.promise().IsCompleted(); }
+    void Wait() noexcept { Handle.promise().Wait(); }
+    T Get() noexcept { Handle.promise().Wait(); return Handle.promise().Result(); }
+
+    Awaiter operator co_await() noexcept { return Awaiter{Handle}; }
+};
+
+template <typename T>
+class CxPlatTaskPromise : public CxPlatTaskPromiseBase {
+private:
+    T Value {};
+
+public:
+    CxPlatTask<T> get_return_object() noexcept {
+        return CxPlatTask<T>(std::coroutine_handle<CxPlatTaskPromise>::from_promise(*this));
+    }
+    static CxPlatTask<T> get_return_object_on_allocation_failure() noexcept {
+        return CxPlatTask<T>();
+    }
+    void return_value(const T& NewValue) noexcept { Value = NewValue; }
+    T Result() noexcept { return Value; }
+};
+
+template <>
+class CxPlatTaskPromise<void> : public CxPlatTaskPromiseBase {
+public:
+    CxPlatTask<void> get_return_object() noexcept {
+        return CxPlatTask<void>(std::coroutine_handle<CxPlatTaskPromise>::from_promise(*this));
+    }
+    static CxPlatTask<void> get_return_object_on_allocation_failure() noexcept {
+        return CxPlatTask<void>();
+    }
+    void return_void() noexcept { }
+    void Result() noexcept { }
+};
+
+class CxPlatCoEvent {
+private:
+    CXPLAT_DISPATCH_LOCK Lock;
+    bool IsSet {false};
+    CXPLAT_LIST_ENTRY Waiters;
+    CXPLAT_THREAD_POOL* Pool;
+
+public:
+    struct Awaiter {
+        CxPlatCoEvent* Event;
+        CxPlatCoWaiter Waiter;
+        bool await_ready() noexcept { return *(volatile bool*)&Event->IsSet; }
+        bool await_suspend(std::coroutine_handle<> Handle) noexcept {
+            Waiter.Handle = Handle;
+            CxPlatDispatchLockAcquire(&Event->Lock);
+            const bool Suspend = !Event->IsSet;
+            if (Suspend) {
+                CxPlatListInsertTail(&Event->Waiters, &Waiter.Link);
+            }
+            CxPlatDispatchLockRelease(&Event->Lock);
+            return Suspend;
+        }
+        void await_resume() noexcept { }
+    };
+
+    CxPlatCoEvent(_In_opt_ CXPLAT_THREAD_POOL* Pool = nullptr) noexcept : Pool(Pool) {
+        CxPlatDispatchLockInitialize(&Lock);
+        CxPlatListInitializeHead(&Waiters);
+    }
+    ~CxPlatCoEvent() noexcept {
+        CXPLAT_DBG_ASSERT(CxPlatListIsEmpty(&Waiters));
+        CxPlatDispatchLockUninitialize(&Lock);
+    }
+    CxPlatCoEvent(const CxPlatCoEvent&) = delete;
+    CxPlatCoEvent& operator=(const CxPlatCoEvent&) = delete;
+
+    //
+    // Resumes every waiting coroutine. The event isn't touched while they
+    // are resumed, so an inline waiter is free to delete it.
+    //
+    void Set() noexcept {
+        CXPLAT_LIST_ENTRY Ready;
+        CxPlatListInitializeHead(&Ready);
+        CXPLAT_THREAD_POOL* ResumePool = Pool;
+        CxPlatDispatchLockAcquire(&Lock);
+        IsSet = true;
+        CxPlatListMoveItems(&Waiters, &Ready);
+        CxPlatDispatchLockRelease(&Lock);
+        while (!CxPlatListIsEmpty(&Ready)) {
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&Ready), CxPlatCoWaiter, Link)->Resume(ResumePool);
+        }
+    }
+
+    void Reset() noexcept {
+        CxPlatDispatchLockAcquire(&Lock);
+        IsSet = false;
+        CxPlatDispatchLockRelease(&Lock);
+    }
+
+    Awaiter operator co_await() noexcept { return Awaiter{this, {}}; }
+};
+
+//
+// Release hands the lock straight to the longest waiting coroutine. Without
+// a pool, that coroutine runs inside Release, so long chains of inline
+// handoffs nest on the releasing thread's stack.
+//
+class CxPlatCoLock {
+private:
+    CXPLAT_DISPATCH_LOCK Lock;
+    bool Held {false};
+    CXPLAT_LIST_ENTRY Waiters;
+    CXPLAT_THREAD_POOL* Pool;
+
+public:
+    struct Awaiter {
+        CxPlatCoLock* Owner;
+        CxPlatCoWaiter Waiter;
+        bool await_ready() noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> Handle) noexcept {
+            Waiter.Handle = Handle;
+            CxPlatDispatchLockAcquire(&Owner->Lock);
+            const bool Suspend = Owner->Held;
+            if (Suspend) {
+                CxPlatListInsertTail(&Owner->Waiters, &Waiter.Link);
+            } else {
+                Owner->Held = true;
+            }
+            CxPlatDispatchLockRelease(&Owner->Lock);
+            return Suspend;
+        }
+        void await_resume() noexcept { }
+    };
+
+    CxPlatCoLock(_In_opt_ CXPLAT_THREAD_POOL* Pool = nullptr) noexcept : Pool(Pool) {
+        CxPlatDispatchLockInitialize(&Lock);
+        CxPlatListInitializeHead(&Waiters);
+    }
+    ~CxPlatCoLock() noexcept {
+        CXPLAT_DBG_ASSERT(!Held);
+        CxPlatDispatchLockUninitialize(&Lock);
+    }
+    CxPlatCoLock(const CxPlatCoLock&) = delete;
+    CxPlatCoLock& operator=(const CxPlatCoLock&) = delete;
+
+    Awaiter Acquire() noexcept { return Awaiter{this, {}}; }
+
+    void Release() noexcept {
+        CxPlatCoWaiter* Next = nullptr;
+        CXPLAT_THREAD_POOL* ResumePool = Pool;
+        CxPlatDispatchLockAcquire(&Lock);
+        CXPLAT_DBG_ASSERT(Held);
+        if (CxPlatListIsEmpty(&Waiters)) {
+            Held = false;
+        } else {
+            Next = CXPLAT_CONTAINING_RECORD(CxPlatListRemoveHead(&Waiters), CxPlatCoWaiter, Link);
+        }
+        CxPlatDispatchLockRelease(&Lock);
+        if (Next != nullptr) {
+            Next->Resume(ResumePool);
+        }
+    }
+};
+
+//
+// One sleep at a time per timer. The coroutine resumes on the pool rather
+// than the timer thread, so it can't hold up other timers.
+//
+class CxPlatCoTimer {
+private:
+    CXPLAT_TIMER* Timer {nullptr};
+    CXPLAT_THREAD_POOL* Pool;
+    CxPlatCoWaiter Waiter;
+
+    static void TimerCallback(_In_ CXPLAT_TIMER*, _In_opt_ void* Context) {
+        auto This = (CxPlatCoTimer*)Context;
+        This->Waiter.Resume(This->Pool);
+    }
+
+public:
+    struct Awaiter {
+        CxPlatCoTimer* Owner;
+        uint64_t DelayUs;
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> Handle) noexcept {
+            Owner->Waiter.Handle = Handle;
+            CxPlatTimerSet(Owner->Timer, DelayUs);
+        }
+        void await_resume() noexcept { }
+    };
+
+    CxPlatCoTimer(_In_ CXPLAT_THREAD_POOL* Pool) noexcept : Pool(Pool) {
+        CXPLAT_DBG_ASSERT(Pool != nullptr);
+        if (CXPLAT_FAILED(CxPlatTimerCreate(TimerCallback, this, &Timer))) {
+            Timer = nullptr;
+        }
+    }
+    ~CxPlatCoTimer() noexcept { if (Timer) { CxPlatTimerDelete(Timer); } }
+    CxPlatCoTimer(const CxPlatCoTimer&) = delete;
+    CxPlatCoTimer& operator=(const CxPlatCoTimer&) = delete;
+
+    bool IsValid() const noexcept { return Timer != nullptr; }
+
+    Awaiter Sleep(uint64_t DelayUs) noexcept { return Awaiter{this, DelayUs}; }
+};
+
+class CxPlatCoResumeOnPool {
+private:
+    CXPLAT_THREAD_POOL* Pool;
+    CxPlatCoWaiter Waiter;
+
+public:
+    explicit CxPlatCoResumeOnPool(_In_ CXPLAT_THREAD_POOL* Pool) noexcept : Pool(Pool) { }
+    bool await_ready() noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> Handle) noexcept {
+        Waiter.Handle = Handle;
+        Waiter.Resume(Pool);
+    }
+    void await_resume() noexcept { }
+};
+
+class CxPlatCoResumeOnProc {
+private:
+    CXPLAT_WORKER_POOL* Pool;
+    uint32_t ProcIndex;
+    CXPLAT_EXECUTION_CONTEXT Context;
+    std::coroutine_handle<> Handle;
+
+    //
+    // Unregisters as it resumes, so the worker doesn't touch the context
+    // again and the coroutine is free to move on or complete.
+    //
+    static BOOLEAN Run(_Inout_ CXPLAT_EXECUTION_CONTEXT* Context, _In_ const CXPLAT_EXECUTION_STATE*) {
+        ((CxPlatCoResumeOnProc*)Context->Context)->Handle.resume();
+        return FALSE;
+    }
+
+public:
+    CxPlatCoResumeOnProc(_In_ CXPLAT_WORKER_POOL* Pool, _In_ uint32_t ProcIndex) noexcept
+        : Pool(Pool), ProcIndex(ProcIndex) { }
+    bool await_ready() noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> NewHandle) noexcept {
+        Handle = NewHandle;
+        CxPlatExecutionContextInitialize(&Context, Run, this);
+        CxPlatWorkerPoolAddExecutionContext(Pool, &Context, ProcIndex);
+    }
+    void await_resume() noexcept { }
+};
+
+#endif // !_KERNEL_MODE && __cpp_impl_coroutine
+
 #endif
@@ -219,15 +219,141 @@ CxPlatGetAbsoluteTime(
     _Out_ struct timespec *Time
     );
 
+void
+CxPlatGetAbsoluteTimeUs(
+    _In_ uint64_t DeltaUs,
+    _Out_ struct timespec *Time
+    );
+
+//
+// Platform time is read directly from the CPU's invariant counter (TSC on
+// x86-64, CNTVCT on arm64) when CxPlatInitialize finds it reliable. Otherwise
+// it is CLOCK_MONOTONIC in microseconds.
+//
+#if defined(__x86_64__) || defined(__aarch64__)
+#define CXPLAT_TIME_CPU_COUNTER 1
+#endif
+
+//
+// Performance counter frequency.
+//
+extern uint64_t CxPlatPerfFreq;
+
+#ifdef CXPLAT_TIME_CPU_COUNTER
+
+//
+// TRUE if platform time is read from the CPU counter.
+//
+extern BOOLEAN CxPlatTimeCpuCounterEnabled;
+
+//
+// Fixed point (64.64) multiplier converting CPU counter ticks to microseconds.
+//
+extern uint64_t CxPlatTimeCpuCounterToUsMult;
+
+inline
 uint64_t
-CxPlatTimeUs64(
+CxPlatTimeReadCpuCounter(
     void
-    );
+    )
+{
+#if defined(__x86_64__)
+    return __builtin_ia32_rdtsc();
+#else
+    uint64_t Count;
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(Count) :: "memory");
+    return Count;
+#endif
+}
+
+#endif // CXPLAT_TIME_CPU_COUNTER
+
+//
+// Returns the current time in platform specific time units.
+//
+inline
+uint64_t
+CxPlatTimePlat(
+    void
+    )
+{
+#ifdef CXPLAT_TIME_CPU_COUNTER
+    if (CxPlatTimeCpuCounterEnabled) {
+        return CxPlatTimeReadCpuCounter();
+    }
+#endif
+    struct timespec CurrTime;
+    clock_gettime(CLOCK_MONOTONIC, &CurrTime);
+    return
+        ((uint64_t)CurrTime.tv_sec * CXPLAT_MICROSEC_PER_SEC) +
+        ((uint64_t)CurrTime.tv_nsec / CXPLAT_NANOSEC_PER_MICROSEC);
+}
 
+//
+// Converts platform time to microseconds.
+//
+inline
+uint64_t
+CxPlatTimePlatToUs64(
+    uint64_t Count
+    )
+{
+#ifdef CXPLAT_TIME_CPU_COUNTER
+    if (CxPlatTimeCpuCounterEnabled) {
+        return (uint64_t)(((__uint128_t)Count * CxPlatTimeCpuCounterToUsMult) >> 64);
+    }
+#endif
+    return Count;
+}
+
+//
+// Converts microseconds to platform time.
+//
+inline
+uint64_t
+CxPlatTimeUs64ToPlat(
+    uint64_t TimeUs
+    )
+{
+#ifdef CXPLAT_TIME_CPU_COUNTER
+    if (CxPlatTimeCpuCounterEnabled) {
+        return (uint64_t)(((__uint128_t)TimeUs * CxPlatPerfFreq) / CXPLAT_MICROSEC_PER_SEC);
+    }
+#endif
+    return TimeUs;
+}
+
+#define CxPlatTimeUs64() CxPlatTimePlatToUs64(CxPlatTimePlat())
 #define CxPlatTimeUs32() (uint32_t)CxPlatTimeUs64()
 #define CxPlatTimeMs64()  (CxPlatTimeUs64() / CXPLAT_MICROSEC_PER_MS)
 #define CxPlatTimeMs32() (uint32_t)CxPlatTimeMs64()
-#define CxPlatTimeUs64ToPlat(x) (x)
+
+//
+// Fallback for CxPlatTimeCoarseUs64 when the ticker isn't running. On Linux,
+// CLOCK_MONOTONIC_COARSE shares its base with CLOCK_MONOTONIC and is read
+// without touching the clocksource, so use it unless platform time already
+// comes from the CPU counter (which is cheaper still).
+//
+inline
+uint64_t
+CxPlatInternalTimeCoarseUs64(
+    void
+    )
+{
+#if defined(CLOCK_MONOTONIC_COARSE)
+#ifdef CXPLAT_TIME_CPU_COUNTER
+    if (!CxPlatTimeCpuCounterEnabled)
+#endif
+    {
+        struct timespec CurrTime;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &CurrTime);
+        return
+            ((uint64_t)CurrTime.tv_sec * CXPLAT_MICROSEC_PER_SEC) +
+            ((uint64_t)CurrTime.tv_nsec / CXPLAT_NANOSEC_PER_MICROSEC);
+    }
+#endif
+    return CxPlatTimeUs64();
+}
 
 inline
 int64_t
@@ -241,6 +367,21 @@ CxPlatTimeEpochMs64(
     return S_TO_MS(tv.tv_sec) + US_TO_MS(tv.tv_usec);
 }
 
+//
+// Reads the system wall clock directly. Use CxPlatTimeEpochNs64 instead.
+//
+inline
+uint64_t
+CxPlatInternalTimeEpochNs64(
+    void
+    )
+{
+    struct timespec CurrTime;
+    clock_gettime(CLOCK_REALTIME, &CurrTime);
+    return
+        ((uint64_t)CurrTime.tv_sec * CXPLAT_NANOSEC_PER_SEC) + (uint64_t)CurrTime.tv_nsec;
+}
+
 inline
 uint64_t
 CxPlatTimeDiff64(
@@ -300,6 +441,11 @@ CxPlatSleep(
     _In_ uint32_t DurationMs
     );
 
+void
+CxPlatSleepUs(
+    _In_ uint64_t DurationUs
+    );
+
 #define CxPlatSchedulerYield() sched_yield()
 
 //
@@ -442,22 +588,22 @@ CxPlatInternalEventWaitForever(
 
 inline
 BOOLEAN
-CxPlatInternalEventWaitWithTimeout(
+CxPlatInternalEventWaitWithTimeoutUs(
     _Inout_ CXPLAT_EVENT* Event,
-    _In_ uint32_t TimeoutMs
+    _In_ uint64_t TimeoutUs
     )
 {
     BOOLEAN WaitSatisfied = FALSE;
     struct timespec Ts = {0, 0};
     int Result;
 
-    CXPLAT_DBG_ASSERT(TimeoutMs != UINT32_MAX);
+    CXPLAT_DBG_ASSERT(TimeoutUs != UINT64_MAX);
 
     //
     // Get absolute time.
     //
 
-    CxPlatGetAbsoluteTime(TimeoutMs, &Ts);
+    CxPlatGetAbsoluteTimeUs(TimeoutUs, &Ts);
 
     Result = pthread_mutex_lock(&Event->Mutex);
     CXPLAT_FRE_ASSERT(Result == 0);
@@ -489,22 +635,151 @@ Exit:
     return WaitSatisfied;
 }
 
+inline
+BOOLEAN
+CxPlatInternalEventWaitWithTimeout(
+    _Inout_ CXPLAT_EVENT* Event,
+    _In_ uint32_t TimeoutMs
+    )
+{
+    CXPLAT_DBG_ASSERT(TimeoutMs != UINT32_MAX);
+    return CxPlatInternalEventWaitWithTimeoutUs(Event, MS_TO_US((uint64_t)TimeoutMs));
+}
+
+//
+// Spins for up to SpinCount iterations waiting for the event to be signaled
+// before falling back to a blocking wait. Avoids the sleep/wake latency of the
+// condition variable when the event is expected to be set very soon.
+//
+inline
+void
+CxPlatInternalEventWaitWithSpin(
+    _Inout_ CXPLAT_EVENT* Event,
+    _In_ uint32_t SpinCount
+    )
+{
+    for (uint32_t i = 0; i < SpinCount && !*(volatile BOOLEAN*)&Event->Signaled; ++i) {
+        YieldProcessor();
+    }
+
+    //
+    // Consume the signal (or block, if the spin ran out) under the lock.
+    //
+    CxPlatInternalEventWaitForever(Event);
+}
+
 #define CxPlatEventUninitialize(Event) CxPlatInternalEventUninitialize(&Event)
 #define CxPlatEventSet(Event) CxPlatInternalEventSet(&Event)
 #define CxPlatEventReset(Event) CxPlatInternalEventReset(&Event)
 #define CxPlatEventWaitForever(Event) CxPlatInternalEventWaitForever(&Event)
 #define CxPlatEventWaitWithTimeout(Event, TimeoutMs) CxPlatInternalEventWaitWithTimeout(&Event, TimeoutMs)
+#define CxPlatEventWaitWithTimeoutUs(Event, TimeoutUs) CxPlatInternalEventWaitWithTimeoutUs(&Event, TimeoutUs)
+#define CxPlatEventWaitWithSpin(Event, SpinCount) CxPlatInternalEventWaitWithSpin(&Event, SpinCount)
 
 //
 // Processor Interfaces
 //
 
+//
+// CxPlatProcCount is the number of processors the process can use, after its
+// affinity mask and any cgroup CPU quota. Processor indexes everywhere are
+// dense in [0, CxPlatProcCount()); CxPlatProcessorMap gives the OS processor
+// number for each. CxPlatProcSystemCount is every online processor.
+//
 extern uint32_t CxPlatProcessorCount;
+extern uint32_t CxPlatProcessorSystemCount;
+extern uint32_t* CxPlatProcessorMap;
 #define CxPlatProcCount() CxPlatProcessorCount
+#define CxPlatProcSystemCount() CxPlatProcessorSystemCount
 
+//
+// Maps OS processor numbers below CxPlatProcessorCpuLimit back to processor
+// indexes, or UINT32_MAX for processors the process can't use.
+//
+extern uint32_t* CxPlatProcessorIndexes;
+extern uint32_t CxPlatProcessorCpuLimit;
+
+//
+// glibc 2.35 and later register a restartable sequence (rseq) area for every
+// thread, in which the kernel keeps the current processor number up to date.
+// Reading it is a plain load from thread local storage.
+//
+#if defined(__linux__) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35)) && \
+    defined(__has_builtin)
+#if __has_builtin(__builtin_thread_pointer) && __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#define CXPLAT_PROC_RSEQ 1
+#endif
+#endif
+
+uint32_t
+CxPlatInternalProcCurrentNumber(
+    void
+    );
+
+inline
 uint32_t
 CxPlatProcCurrentNumber(
     void
+    )
+{
+#ifdef CXPLAT_PROC_RSEQ
+    //
+    // If rseq isn't registered, cpu_id holds a negative sentinel and fails
+    // the bounds check.
+    //
+    const uint32_t Cpu =
+        *(volatile uint32_t*)&((struct rseq*)
+            ((uint8_t*)__builtin_thread_pointer() + __rseq_offset))->cpu_id;
+    if (Cpu < CxPlatProcessorCpuLimit) {
+        const uint32_t Index = CxPlatProcessorIndexes[Cpu];
+        if (Index != UINT32_MAX) {
+            return Index;
+        }
+    }
+#endif
+    return CxPlatInternalProcCurrentNumber();
+}
+
+//
+// Where each processor sits in the machine, read from sysfs on Linux. Each
+// domain is identified by the lowest processor index in it, so two
+// processors share a domain exactly when their IDs match. Anything sysfs
+// doesn't report is treated as unshared.
+//
+typedef struct CXPLAT_PROCESSOR_TOPOLOGY {
+    uint32_t Core;       // Physical core (shared by SMT siblings)
+    uint32_t L2Domain;   // Processors sharing an L2 cache
+    uint32_t L3Domain;   // Processors sharing an L3 cache
+    uint32_t Package;    // Physical package (socket) ID
+    uint32_t NumaNode;   // NUMA node ID
+} CXPLAT_PROCESSOR_TOPOLOGY;
+
+extern CXPLAT_PROCESSOR_TOPOLOGY* CxPlatProcessorTopology;
+
+#ifdef CXPLAT_NUMA_AWARE
+extern uint32_t CxPlatNumaNodeCount;
+#endif
+
+typedef enum CXPLAT_PROCESSOR_RELATION {
+    CXPLAT_PROCESSOR_RELATION_CORE,
+    CXPLAT_PROCESSOR_RELATION_L2,
+    CXPLAT_PROCESSOR_RELATION_L3,
+    CXPLAT_PROCESSOR_RELATION_PACKAGE,
+    CXPLAT_PROCESSOR_RELATION_NUMA_NODE
+} CXPLAT_PROCESSOR_RELATION;
+
+//
+// Returns the number of processors related to ProcIndex (including itself)
+// and writes the first Capacity of them, in ascending order, to Procs.
+//
+uint32_t
+CxPlatProcGetRelated(
+    _In_ uint32_t ProcIndex,
+    _In_ CXPLAT_PROCESSOR_RELATION Relation,
+    _Out_writes_to_(Capacity, return) uint32_t* Procs,
+    _In_ uint32_t Capacity
     );
 
 //
@@ -529,6 +804,20 @@ typedef struct CXPLAT_THREAD_CONFIG {
     _Field_z_ const char* Name;
     LPTHREAD_START_ROUTINE Callback;
     void* Context;
+
+    //
+    // With CXPLAT_THREAD_FLAG_SET_NUMA_NODE, the thread runs on the node's
+    // processors and prefers the node's memory.
+    //
+    uint32_t NumaNode;
+
+    //
+    // With CXPLAT_THREAD_FLAG_SET_PROCESSORS, the thread runs on any of these
+    // processor indexes.
+    //
+    _Field_size_(ProcessorCount) const uint32_t* Processors;
+    uint32_t ProcessorCount;
+
 } CXPLAT_THREAD_CONFIG;
 
 #ifdef CXPLAT_USE_CUSTOM_THREAD_CONTEXT
@@ -54,6 +54,14 @@ extern "C" {
 
 typedef unsigned char BOOLEAN;
 
+#if defined(__x86_64__) || defined(__i386__)
+#define YieldProcessor() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define YieldProcessor() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define YieldProcessor() __asm__ __volatile__("" ::: "memory")
+#endif
+
 inline
 short
 InterlockedIncrement16(
@@ -115,7 +123,7 @@ InterlockedAnd(
     _In_ long Value
     )
 {
-    return __sync_and_and_fetch(Destination, Value);
+    return __sync_fetch_and_and(Destination, Value);
 }
 
 inline
@@ -125,7 +133,7 @@ InterlockedOr(
     _In_ long Value
     )
 {
-    return __sync_or_and_fetch(Destination, Value);
+    return __sync_fetch_and_or(Destination, Value);
 }
 
 inline
@@ -140,7 +148,7 @@ InterlockedCompareExchange16(
 }
 
 inline
-short
+long
 InterlockedCompareExchange(
     _Inout_ _Interlocked_operand_ long volatile *Destination,
     _In_ long ExChange,
@@ -161,6 +169,26 @@ InterlockedCompareExchange64(
     return __sync_val_compare_and_swap(Destination, Comperand, ExChange);
 }
 
+inline
+long
+InterlockedExchange(
+    _Inout_ _Interlocked_operand_ long volatile *Target,
+    _In_ long Value
+    )
+{
+    return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+}
+
+inline
+int64_t
+InterlockedExchange64(
+    _Inout_ _Interlocked_operand_ int64_t volatile *Target,
+    _In_ int64_t Value
+    )
+{
+    return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+}
+
 inline
 int64_t
 InterlockedExchangeAdd64(
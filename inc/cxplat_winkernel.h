@@ -269,6 +269,7 @@ CxPlatTimeUs64ToPlat(
 }
 
 #define CxPlatTimeUs64() CxPlatTimePlatToUs64(CxPlatTimePlat())
+#define CxPlatInternalTimeCoarseUs64() CxPlatTimeUs64()
 #define CxPlatTimeUs32() (uint32_t)CxPlatTimeUs64()
 #define CxPlatTimeMs64() US_TO_MS(CxPlatTimeUs64())
 #define CxPlatTimeMs32() (uint32_t)CxPlatTimeMs64()
@@ -285,6 +286,20 @@ CxPlatTimeEpochMs64(
     return NS100_TO_MS(SystemTime.QuadPart - UNIX_EPOCH_AS_FILE_TIME);
 }
 
+//
+// Reads the system wall clock directly. Use CxPlatTimeEpochNs64 instead.
+//
+inline
+uint64_t
+CxPlatInternalTimeEpochNs64(
+    void
+    )
+{
+    LARGE_INTEGER SystemTime;
+    KeQuerySystemTimePrecise(&SystemTime);
+    return (uint64_t)(SystemTime.QuadPart - UNIX_EPOCH_AS_FILE_TIME) * 100;
+}
+
 //
 // Returns the difference between two timestamps.
 //
@@ -366,6 +381,12 @@ CxPlatSleep(
     KeWaitForSingleObject(&SleepTimer, Executive, KernelMode, FALSE, NULL);
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatSleepUs(
+    _In_ uint64_t DurationUs
+    );
+
 #define CxPlatSchedulerYield() // no-op
 
 //
@@ -397,14 +418,77 @@ CxPlatInternalEventWaitWithTimeout(
 #define CxPlatEventWaitWithTimeout(Event, TimeoutMs) \
     (STATUS_SUCCESS == CxPlatInternalEventWaitWithTimeout(&Event, TimeoutMs))
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+CxPlatInternalEventWaitWithTimeoutUs(
+    _In_ CXPLAT_EVENT* Event,
+    _In_ uint64_t TimeoutUs
+    );
+
+#define CxPlatEventWaitWithTimeoutUs(Event, TimeoutUs) \
+    CxPlatInternalEventWaitWithTimeoutUs(&Event, TimeoutUs)
+
+inline
+void
+CxPlatInternalEventWaitWithSpin(
+    _In_ CXPLAT_EVENT* Event,
+    _In_ uint32_t SpinCount
+    )
+{
+    for (uint32_t i = 0; i < SpinCount && !KeReadStateEvent(Event); ++i) {
+        YieldProcessor();
+    }
+    KeWaitForSingleObject(Event, Executive, KernelMode, FALSE, NULL);
+}
+
+#define CxPlatEventWaitWithSpin(Event, SpinCount) \
+    CxPlatInternalEventWaitWithSpin(&Event, SpinCount)
+
 //
 // Processor Interfaces
 //
 
 extern uint32_t CxPlatProcessorCount;
 #define CxPlatProcCount() CxPlatProcessorCount
+#define CxPlatProcSystemCount() CxPlatProcessorCount
 #define CxPlatProcCurrentNumber() (KeGetCurrentProcessorIndex() % CxPlatProcessorCount)
 
+//
+// Rundown Protection Interfaces
+//
+
+typedef EX_RUNDOWN_REF CXPLAT_RUNDOWN_REF;
+#define CxPlatRundownInitialize(Rundown) ExInitializeRundownProtection(Rundown)
+#define CxPlatRundownUninitialize(Rundown) UNREFERENCED_PARAMETER(Rundown)
+#define CxPlatRundownReinitialize(Rundown) ExReInitializeRundownProtection(Rundown)
+#define CxPlatRundownAcquire(Rundown) ExAcquireRundownProtection(Rundown)
+#define CxPlatRundownRelease(Rundown) ExReleaseRundownProtection(Rundown)
+#define CxPlatRundownWait(Rundown) ExWaitForRundownProtectionRelease(Rundown)
+
+typedef PEX_RUNDOWN_REF_CACHE_AWARE CXPLAT_RUNDOWN_REF_CACHE_AWARE;
+
+inline
+CXPLAT_STATUS
+CxPlatRundownCacheAwareInitialize(
+    _Out_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    *Rundown =
+        ExAllocateCacheAwareRundownProtection(NonPagedPoolNx, CXPLAT_POOL_RUNDOWN);
+    return *Rundown == NULL ? CXPLAT_STATUS_OUT_OF_MEMORY : CXPLAT_STATUS_SUCCESS;
+}
+
+#define CxPlatRundownCacheAwareUninitialize(Rundown) \
+    ExFreeCacheAwareRundownProtection(*(Rundown))
+#define CxPlatRundownCacheAwareReinitialize(Rundown) \
+    ExReInitializeRundownProtectionCacheAware(*(Rundown))
+#define CxPlatRundownCacheAwareAcquire(Rundown) \
+    ExAcquireRundownProtectionCacheAware(*(Rundown))
+#define CxPlatRundownCacheAwareRelease(Rundown) \
+    ExReleaseRundownProtectionCacheAware(*(Rundown))
+#define CxPlatRundownCacheAwareWait(Rundown) \
+    ExWaitForRundownProtectionReleaseCacheAware(*(Rundown))
+
 //
 // Create Thread Interfaces
 //
@@ -290,10 +290,11 @@ CxPlatTimeUs64ToPlat(
     uint64_t Low = (TimeUs & 0xFFFFFFFF) * CxPlatPerfFreq;
     return
         ((High / 1000000) << 32) +
-        ((Low + ((High % 1000000) << 32)) / CxPlatPerfFreq);
+        ((Low + ((High % 1000000) << 32)) / 1000000);
 }
 
 #define CxPlatTimeUs64() CxPlatTimePlatToUs64(CxPlatTimePlat())
+#define CxPlatInternalTimeCoarseUs64() CxPlatTimeUs64()
 #define CxPlatTimeUs32() (uint32_t)CxPlatTimeUs64()
 #define CxPlatTimeMs64() US_TO_MS(CxPlatTimeUs64())
 #define CxPlatTimeMs32() (uint32_t)CxPlatTimeMs64()
@@ -310,6 +311,20 @@ CxPlatTimeEpochMs64(
     return NS100_TO_MS(FileTime.QuadPart - UNIX_EPOCH_AS_FILE_TIME);
 }
 
+//
+// Reads the system wall clock directly. Use CxPlatTimeEpochNs64 instead.
+//
+inline
+uint64_t
+CxPlatInternalTimeEpochNs64(
+    void
+    )
+{
+    LARGE_INTEGER FileTime;
+    GetSystemTimePreciseAsFileTime((FILETIME*) &FileTime);
+    return (uint64_t)(FileTime.QuadPart - UNIX_EPOCH_AS_FILE_TIME) * 100;
+}
+
 //
 // Returns the difference between two timestamps.
 //
@@ -374,6 +389,15 @@ CxPlatTimeAtOrBefore32(
 
 #define CxPlatSleep(ms) Sleep(ms)
 
+//
+// Sleeps using a high resolution waitable timer, where available, so that
+// sub-millisecond durations aren't rounded up to the system timer tick.
+//
+void
+CxPlatSleepUs(
+    _In_ uint64_t DurationUs
+    );
+
 #define CxPlatSchedulerYield() Sleep(0)
 
 
@@ -401,6 +425,27 @@ CxPlatEventWaitWithTimeout(
     return WAIT_OBJECT_0 == WaitForSingleObject(Event, TimeoutMs);
 }
 
+BOOLEAN
+CxPlatEventWaitWithTimeoutUs(
+    _In_ CXPLAT_EVENT Event,
+    _In_ uint64_t TimeoutUs
+    );
+
+//
+// The event's state lives in the kernel, so each poll would cost as much as
+// the blocking wait it's trying to avoid. Just block.
+//
+inline
+void
+CxPlatEventWaitWithSpin(
+    _In_ CXPLAT_EVENT Event,
+    _In_ uint32_t SpinCount
+    )
+{
+    UNREFERENCED_PARAMETER(SpinCount);
+    WaitForSingleObject(Event, INFINITE);
+}
+
 //
 // Processor Interfaces
 //
@@ -421,6 +466,7 @@ extern CXPLAT_PROCESSOR_GROUP_INFO* CxPlatProcessorGroupInfo;
 
 extern uint32_t CxPlatProcessorCount;
 #define CxPlatProcCount() CxPlatProcessorCount
+#define CxPlatProcSystemCount() CxPlatProcessorCount
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
 inline
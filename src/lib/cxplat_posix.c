@@ -10,6 +10,9 @@
 #include <limits.h>
 #include <sched.h>
 #include <syslog.h>
+#if __linux__
+#include <linux/futex.h>
+#endif
 
 typedef struct CX_PLATFORM {
 
@@ -33,7 +36,6 @@ typedef struct CX_PLATFORM {
 #ifdef CXPLAT_NUMA_AWARE
 #include <numa.h>               // If missing: `apt-get install -y libnuma-dev`
 uint32_t CxPlatNumaNodeCount;
-cpu_set_t* CxPlatNumaNodeMasks;
 #endif // CXPLAT_NUMA_AWARE
 
 CX_PLATFORM CxPlatform = { NULL };
@@ -44,6 +46,18 @@ CX_PLATFORM CxPlatform = { NULL };
 int RandomFd = -1;
 
 uint32_t CxPlatProcessorCount;
+uint32_t CxPlatProcessorSystemCount;
+uint32_t* CxPlatProcessorMap;
+uint32_t* CxPlatProcessorIndexes;
+uint32_t CxPlatProcessorCpuLimit;
+CXPLAT_PROCESSOR_TOPOLOGY* CxPlatProcessorTopology;
+
+uint64_t CxPlatPerfFreq = CXPLAT_MICROSEC_PER_SEC;
+#ifdef CXPLAT_TIME_CPU_COUNTER
+BOOLEAN CxPlatTimeCpuCounterEnabled;
+uint64_t CxPlatTimeCpuCounterToUsMult;
+static void CxPlatTimeInitialize(void);
+#endif
 
 #ifdef __clang__
 __attribute__((noinline, noreturn, optnone))
@@ -97,50 +111,418 @@ CxPlatLogAssert(
         Expr);
 }
 
+#if __linux__
+
+//
+// Reads a single unsigned integer from a sysfs file.
+//
+static
+BOOLEAN
+CxPlatSysfsReadUInt32(
+    _In_z_ const char* Path,
+    _Out_ uint32_t* Value
+    )
+{
+    BOOLEAN Result = FALSE;
+    FILE* File = fopen(Path, "r");
+    if (File != NULL) {
+        Result = fscanf(File, "%u", Value) == 1;
+        fclose(File);
+    }
+    return Result;
+}
+
+//
+// Reads a sysfs list, such as "0-3,8-11", into a set.
+//
+static
+BOOLEAN
+CxPlatSysfsReadCpuList(
+    _In_z_ const char* Path,
+    _Out_ cpu_set_t* Set
+    )
+{
+    char Buffer[1024];
+    FILE* File = fopen(Path, "r");
+    CPU_ZERO(Set);
+    if (File == NULL) {
+        return FALSE;
+    }
+    const BOOLEAN Read = fgets(Buffer, sizeof(Buffer), File) != NULL;
+    fclose(File);
+    if (!Read) {
+        return FALSE;
+    }
+
+    const char* Str = Buffer;
+    while (*Str >= '0' && *Str <= '9') {
+        char* End;
+        const unsigned long First = strtoul(Str, &End, 10);
+        unsigned long Last = First;
+        if (*End == '-') {
+            Last = strtoul(End + 1, &End, 10);
+        }
+        for (unsigned long i = First; i <= Last && i < CPU_SETSIZE; ++i) {
+            CPU_SET(i, Set);
+        }
+        Str = *End == ',' ? End + 1 : End;
+    }
+    return CPU_COUNT(Set) != 0;
+}
+
+//
+// Returns the lowest processor index in a set of OS processor numbers.
+//
+static
+uint32_t
+CxPlatCpuSetFirst(
+    _In_ const cpu_set_t* Set,
+    _In_ uint32_t Default
+    )
+{
+    for (uint32_t Cpu = 0; Cpu < CxPlatProcessorCpuLimit; ++Cpu) {
+        if (CPU_ISSET(Cpu, Set) && CxPlatProcessorIndexes[Cpu] != UINT32_MAX) {
+            return CxPlatProcessorIndexes[Cpu];
+        }
+    }
+    return Default;
+}
+
+//
+// Returns the fewest processors that any cgroup v2 cpu.max quota, from the
+// process's cgroup up to the root, lets the process keep busy, or zero if
+// there is no quota.
+//
+static
+uint32_t
+CxPlatCgroupCpuLimit(
+    void
+    )
+{
+    char Line[256];
+    char Path[sizeof(Line) + 32];
+    char* Group = NULL;
+    uint32_t Limit = 0;
+
+    FILE* File = fopen("/proc/self/cgroup", "r");
+    if (File == NULL) {
+        return 0;
+    }
+    while (fgets(Line, sizeof(Line), File) != NULL) {
+        if (strncmp(Line, "0::", 3) == 0) {
+            Group = Line + 3;
+            Group[strcspn(Group, "\n")] = '\0';
+            break;
+        }
+    }
+    fclose(File);
+    if (Group == NULL || Group[0] != '/') {
+        return 0; // Not on cgroup v2.
+    }
+
+    for (;;) {
+        snprintf(Path, sizeof(Path), "/sys/fs/cgroup%s/cpu.max", Group);
+        if ((File = fopen(Path, "r")) != NULL) {
+            char Quota[32];
+            unsigned long long Period;
+            if (fscanf(File, "%31s %llu", Quota, &Period) == 2 &&
+                strcmp(Quota, "max") != 0 && Period != 0) {
+                unsigned long long Procs =
+                    (strtoull(Quota, NULL, 10) + Period - 1) / Period;
+                if (Procs == 0) {
+                    Procs = 1;
+                }
+                if (Limit == 0 || Procs < Limit) {
+                    Limit = Procs > UINT32_MAX ? UINT32_MAX : (uint32_t)Procs;
+                }
+            }
+            fclose(File);
+        }
+
+        char* Parent = strrchr(Group, '/');
+        if (Parent == Group) {
+            if (Group[1] == '\0') {
+                break;
+            }
+            Group[1] = '\0';
+        } else {
+            *Parent = '\0';
+        }
+    }
+
+    return Limit;
+}
+
+#endif // __linux__
+
+static
+void
+CxPlatProcessorTopologyInitialize(
+    void
+    )
+{
+    for (uint32_t i = 0; i < CxPlatProcessorCount; ++i) {
+        CxPlatProcessorTopology[i].Core = i;
+        CxPlatProcessorTopology[i].L2Domain = i;
+        CxPlatProcessorTopology[i].L3Domain = i;
+        CxPlatProcessorTopology[i].Package = 0;
+        CxPlatProcessorTopology[i].NumaNode = 0;
+    }
+
+#if __linux__
+    char Path[128];
+    cpu_set_t Set;
+
+    for (uint32_t i = 0; i < CxPlatProcessorCount; ++i) {
+        CXPLAT_PROCESSOR_TOPOLOGY* Topology = &CxPlatProcessorTopology[i];
+        const uint32_t Cpu = CxPlatProcessorMap[i];
+
+        snprintf(Path, sizeof(Path),
+            "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", Cpu);
+        if (CxPlatSysfsReadCpuList(Path, &Set)) {
+            Topology->Core = CxPlatCpuSetFirst(&Set, i);
+        }
+
+        snprintf(Path, sizeof(Path),
+            "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", Cpu);
+        (void)CxPlatSysfsReadUInt32(Path, &Topology->Package);
+
+        //
+        // Cache indexes are listed from the closest cache outwards, and stop
+        // at the first missing one.
+        //
+        for (uint32_t Index = 0; ; ++Index) {
+            uint32_t Level;
+            snprintf(Path, sizeof(Path),
+                "/sys/devices/system/cpu/cpu%u/cache/index%u/level", Cpu, Index);
+            if (!CxPlatSysfsReadUInt32(Path, &Level)) {
+                break;
+            }
+            if (Level != 2 && Level != 3) {
+                continue;
+            }
+            snprintf(Path, sizeof(Path),
+                "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", Cpu, Index);
+            if (CxPlatSysfsReadCpuList(Path, &Set)) {
+                if (Level == 2) {
+                    Topology->L2Domain = CxPlatCpuSetFirst(&Set, i);
+                } else {
+                    Topology->L3Domain = CxPlatCpuSetFirst(&Set, i);
+                }
+            }
+        }
+    }
+
+    //
+    // Node IDs can be sparse, so walk the online list rather than counting.
+    //
+    cpu_set_t Nodes;
+    if (CxPlatSysfsReadCpuList("/sys/devices/system/node/online", &Nodes)) {
+        for (uint32_t Node = 0; Node < CPU_SETSIZE; ++Node) {
+            if (!CPU_ISSET(Node, &Nodes)) {
+                continue;
+            }
+            snprintf(Path, sizeof(Path), "/sys/devices/system/node/node%u/cpulist", Node);
+            if (CxPlatSysfsReadCpuList(Path, &Set)) {
+                for (uint32_t Cpu = 0; Cpu < CxPlatProcessorCpuLimit; ++Cpu) {
+                    if (CPU_ISSET(Cpu, &Set) && CxPlatProcessorIndexes[Cpu] != UINT32_MAX) {
+                        CxPlatProcessorTopology[CxPlatProcessorIndexes[Cpu]].NumaNode = Node;
+                    }
+                }
+            }
+        }
+    }
+#endif // __linux__
+}
+
+static
+uint32_t
+CxPlatProcTopologyDomain(
+    _In_ uint32_t ProcIndex,
+    _In_ CXPLAT_PROCESSOR_RELATION Relation
+    )
+{
+    const CXPLAT_PROCESSOR_TOPOLOGY* Topology = &CxPlatProcessorTopology[ProcIndex];
+    switch (Relation) {
+    case CXPLAT_PROCESSOR_RELATION_CORE:    return Topology->Core;
+    case CXPLAT_PROCESSOR_RELATION_L2:      return Topology->L2Domain;
+    case CXPLAT_PROCESSOR_RELATION_L3:      return Topology->L3Domain;
+    case CXPLAT_PROCESSOR_RELATION_PACKAGE: return Topology->Package;
+    default:                                return Topology->NumaNode;
+    }
+}
+
+uint32_t
+CxPlatProcGetRelated(
+    _In_ uint32_t ProcIndex,
+    _In_ CXPLAT_PROCESSOR_RELATION Relation,
+    _Out_writes_to_(Capacity, return) uint32_t* Procs,
+    _In_ uint32_t Capacity
+    )
+{
+    CXPLAT_DBG_ASSERT(ProcIndex < CxPlatProcessorCount);
+    const uint32_t Domain = CxPlatProcTopologyDomain(ProcIndex, Relation);
+    uint32_t Count = 0;
+    for (uint32_t i = 0; i < CxPlatProcessorCount; ++i) {
+        if (CxPlatProcTopologyDomain(i, Relation) == Domain) {
+            if (Count < Capacity) {
+                Procs[Count] = i;
+            }
+            ++Count;
+        }
+    }
+    return Count;
+}
+
+//
+// Processor indexes are dense over the processors the process may use: those
+// in its affinity mask, thinned out to what its cgroup CPU quota can keep busy.
+// The rest of the library, including affinitization, works in these indexes
+// rather than OS processor numbers.
+//
+static
 CXPLAT_STATUS
-CxPlatInitialize(
+CxPlatProcessorsInitialize(
     void
     )
 {
-#if DEBUG
-    CxPlatform.AllocFailDenominator = 0;
-    CxPlatform.AllocCounter = 0;
-#endif
+    CxPlatProcessorSystemCount = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
 
 #if __linux__
-    CxPlatProcessorCount = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t Usable;
+    if (sched_getaffinity(0, sizeof(Usable), &Usable) != 0 || CPU_COUNT(&Usable) == 0) {
+        CPU_ZERO(&Usable);
+        for (uint32_t Cpu = 0; Cpu < CxPlatProcessorSystemCount && Cpu < CPU_SETSIZE; ++Cpu) {
+            CPU_SET(Cpu, &Usable);
+        }
+    }
+    const uint32_t UsableCount = (uint32_t)CPU_COUNT(&Usable);
+    CxPlatProcessorCount = UsableCount;
+
+    const uint32_t CgroupLimit = CxPlatCgroupCpuLimit();
+    if (CgroupLimit != 0 && CgroupLimit < CxPlatProcessorCount) {
+        CxPlatTraceLogInfo(
+            "[ lib] Using %u of %u processors for the cgroup CPU quota",
+            CgroupLimit,
+            CxPlatProcessorCount);
+        CxPlatProcessorCount = CgroupLimit;
+    }
+
+    //
+    // A quota limits CPU time, not placement, so when trimming keep processors
+    // spread evenly across the mask rather than packing every quota limited
+    // process onto the lowest numbered ones. Sibling hardware threads are
+    // usually numbered far apart, so this also tends to keep one per core.
+    //
+    CxPlatProcessorCpuLimit = 0;
+    for (uint32_t Cpu = 0, Position = 0, Kept = 0; Cpu < CPU_SETSIZE; ++Cpu) {
+        if (!CPU_ISSET(Cpu, &Usable)) {
+            continue;
+        }
+        if (Kept < CxPlatProcessorCount &&
+            Position == (uint32_t)(((uint64_t)Kept * UsableCount) / CxPlatProcessorCount)) {
+            CxPlatProcessorCpuLimit = Cpu + 1;
+            ++Kept;
+        } else {
+            CPU_CLR(Cpu, &Usable);
+        }
+        ++Position;
+    }
 #else
     //
     // arm64 macOS has no way to get the current proc, so treat as single core.
     // Intel macOS can return incorrect values for CPUID, so treat as single core.
     //
     CxPlatProcessorCount = 1;
+    CxPlatProcessorCpuLimit = 1;
+#endif
+
+    const size_t AllocSize =
+        (CxPlatProcessorCount + CxPlatProcessorCpuLimit) * sizeof(uint32_t) +
+        CxPlatProcessorCount * sizeof(CXPLAT_PROCESSOR_TOPOLOGY);
+    CxPlatProcessorMap = CXPLAT_ALLOC_NONPAGED(AllocSize, CXPLAT_POOL_PROC);
+    if (CxPlatProcessorMap == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CxPlatProcessorMap",
+            (unsigned long long)AllocSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+    CxPlatProcessorTopology =
+        (CXPLAT_PROCESSOR_TOPOLOGY*)(CxPlatProcessorMap + CxPlatProcessorCount);
+    CxPlatProcessorIndexes =
+        (uint32_t*)(CxPlatProcessorTopology + CxPlatProcessorCount);
+
+    for (uint32_t Cpu = 0, Index = 0; Cpu < CxPlatProcessorCpuLimit; ++Cpu) {
+#if __linux__
+        if (!CPU_ISSET(Cpu, &Usable)) {
+            CxPlatProcessorIndexes[Cpu] = UINT32_MAX;
+            continue;
+        }
 #endif
+        CxPlatProcessorMap[Index] = Cpu;
+        CxPlatProcessorIndexes[Cpu] = Index++;
+    }
+
+    CxPlatProcessorTopologyInitialize();
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+static
+void
+CxPlatProcessorsUninitialize(
+    void
+    )
+{
+    CXPLAT_FREE(CxPlatProcessorMap, CXPLAT_POOL_PROC);
+    CxPlatProcessorMap = NULL;
+    CxPlatProcessorIndexes = NULL;
+    CxPlatProcessorTopology = NULL;
+}
+
+CXPLAT_STATUS
+CxPlatInitialize(
+    void
+    )
+{
+#if DEBUG
+    CxPlatform.AllocFailDenominator = 0;
+    CxPlatform.AllocCounter = 0;
+#endif
+
+    CXPLAT_STATUS Status = CxPlatProcessorsInitialize();
+    if (CXPLAT_FAILED(Status)) {
+        return Status;
+    }
 
 #ifdef CXPLAT_NUMA_AWARE
     if (numa_available() >= 0) {
         CxPlatNumaNodeCount = (uint32_t)numa_num_configured_nodes();
-        CxPlatNumaNodeMasks =
-            CXPLAT_ALLOC_NONPAGED(sizeof(cpu_set_t) * CxPlatNumaNodeCount, CXPLAT_POOL_PROC);
-        CXPLAT_FRE_ASSERT(CxPlatNumaNodeMasks);
-        for (uint32_t n = 0; n < CxPlatNumaNodeCount; ++n) {
-            CPU_ZERO(&CxPlatNumaNodeMasks[n]);
-            CXPLAT_FRE_ASSERT(numa_node_to_cpus_compat((int)n, CxPlatNumaNodeMasks[n].__bits, sizeof(cpu_set_t)) >= 0);
-        }
     } else {
         CxPlatNumaNodeCount = 0;
     }
 #endif // CXPLAT_NUMA_AWARE
 
+#ifdef CXPLAT_TIME_CPU_COUNTER
+    CxPlatTimeInitialize();
+#endif
+
     RandomFd = open("/dev/urandom", O_RDONLY|O_CLOEXEC);
     if (RandomFd == -1) {
         CxPlatTraceEvent(
             "[ lib] ERROR, %u, %s.",
             errno,
             "open(/dev/urandom, O_RDONLY|O_CLOEXEC) failed");
-        return (CXPLAT_STATUS)errno;
+        Status = (CXPLAT_STATUS)errno;
+        CxPlatProcessorsUninitialize();
+        return Status;
     }
 
+    CxPlatTimeCoarseInitialize();
+    CxPlatTimerServiceInitialize();
+    CxPlatThreadCacheInitialize();
+
     CxPlatTraceLogInfo(
         "[ dso] Initialized");
 
@@ -152,11 +534,13 @@ CxPlatUninitialize(
     void
     )
 {
+    CxPlatThreadCacheUninitialize();
+    CxPlatTimerServiceUninitialize();
+    CxPlatTimeCoarseUninitialize();
+
     close(RandomFd);
 
-#ifdef CXPLAT_NUMA_AWARE
-    CXPLAT_FREE(CxPlatNumaNodeMasks, CXPLAT_POOL_PROC);
-#endif
+    CxPlatProcessorsUninitialize();
 
     CxPlatTraceLogInfo(
         "[ dso] Uninitialized");
@@ -228,23 +612,155 @@ CxPlatGetTimerResolution(
     return CxPlatTimespecToUs(&Res);
 }
 
+#ifdef CXPLAT_TIME_CPU_COUNTER
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+
+//
+// The TSC is only used if the CPU reports it as invariant (constant rate in
+// all P/C-states) and the kernel itself trusts it as its clocksource, which
+// means it also found it synchronized across processors.
+//
+static
+BOOLEAN
+CxPlatTimeCpuCounterReliable(
+    void
+    )
+{
+    uint32_t Eax, Ebx, Ecx, Edx;
+    if (__get_cpuid_max(0x80000000, NULL) < 0x80000007) {
+        return FALSE;
+    }
+    __cpuid(0x80000007, Eax, Ebx, Ecx, Edx);
+    if (!(Edx & (1 << 8))) {
+        return FALSE;
+    }
+
+    BOOLEAN Reliable = FALSE;
+    FILE* File =
+        fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+    if (File != NULL) {
+        char Source[32] = {0};
+        if (fgets(Source, sizeof(Source), File) != NULL) {
+            Reliable = strncmp(Source, "tsc", 3) == 0;
+        }
+        fclose(File);
+    }
+    return Reliable;
+}
+
+//
+// The TSC frequency isn't generally exposed, so measure it against
+// CLOCK_MONOTONIC. Each sample brackets clock_gettime with two TSC reads and
+// keeps the tightest bracket, so scheduling noise doesn't skew the result.
+//
+static
+void
+CxPlatTimeCpuCounterSample(
+    _Out_ uint64_t* Ticks,
+    _Out_ uint64_t* Ns
+    )
+{
+    uint64_t BestWindow = UINT64_MAX;
+    *Ticks = 0;
+    *Ns = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        struct timespec Ts;
+        const uint64_t Before = CxPlatTimeReadCpuCounter();
+        clock_gettime(CLOCK_MONOTONIC, &Ts);
+        const uint64_t After = CxPlatTimeReadCpuCounter();
+        if (After - Before < BestWindow) {
+            BestWindow = After - Before;
+            *Ticks = Before + (After - Before) / 2;
+            *Ns = (uint64_t)Ts.tv_sec * CXPLAT_NANOSEC_PER_SEC + (uint64_t)Ts.tv_nsec;
+        }
+    }
+}
+
+static
 uint64_t
-CxPlatTimeUs64(
+CxPlatTimeCpuCounterFrequency(
     void
     )
 {
-    struct timespec CurrTime = {0};
-    int ErrorCode = clock_gettime(CLOCK_MONOTONIC, &CurrTime);
-    CXPLAT_DBG_ASSERT(ErrorCode == 0);
-    UNREFERENCED_PARAMETER(ErrorCode);
-    return CxPlatTimespecToUs(&CurrTime);
+    uint64_t Ticks1, Ns1, Ticks2, Ns2;
+    CxPlatTimeCpuCounterSample(&Ticks1, &Ns1);
+    CxPlatSleepUs(10 * 1000);
+    CxPlatTimeCpuCounterSample(&Ticks2, &Ns2);
+    return
+        (uint64_t)(((__uint128_t)(Ticks2 - Ticks1) * CXPLAT_NANOSEC_PER_SEC) / (Ns2 - Ns1));
 }
 
+#else // __aarch64__
+
+//
+// The arm64 generic timer is architecturally constant rate and synchronized,
+// and its frequency is published by firmware.
+//
+static
+BOOLEAN
+CxPlatTimeCpuCounterReliable(
+    void
+    )
+{
+    return TRUE;
+}
+
+static
+uint64_t
+CxPlatTimeCpuCounterFrequency(
+    void
+    )
+{
+    uint64_t Freq;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(Freq));
+    return Freq;
+}
+
+#endif
+
+static
+void
+CxPlatTimeInitialize(
+    void
+    )
+{
+    if (CxPlatTimeCpuCounterEnabled || !CxPlatTimeCpuCounterReliable()) {
+        return;
+    }
+
+    const uint64_t Freq = CxPlatTimeCpuCounterFrequency();
+    if (Freq <= CXPLAT_MICROSEC_PER_SEC) {
+        return; // Too coarse to be worth using.
+    }
+
+    CxPlatPerfFreq = Freq;
+    CxPlatTimeCpuCounterToUsMult =
+        (uint64_t)(((__uint128_t)CXPLAT_MICROSEC_PER_SEC << 64) / Freq);
+    CxPlatTimeCpuCounterEnabled = TRUE;
+
+    CxPlatTraceLogInfo(
+        "[ lib] Using CPU counter for time, %llu Hz",
+        (unsigned long long)Freq);
+}
+
+#endif // CXPLAT_TIME_CPU_COUNTER
+
 void
 CxPlatGetAbsoluteTime(
     _In_ unsigned long DeltaMs,
     _Out_ struct timespec *Time
     )
+{
+    CxPlatGetAbsoluteTimeUs(MS_TO_US((uint64_t)DeltaMs), Time);
+}
+
+void
+CxPlatGetAbsoluteTimeUs(
+    _In_ uint64_t DeltaUs,
+    _Out_ struct timespec *Time
+    )
 {
     int ErrorCode = 0;
 
@@ -263,8 +779,8 @@ CxPlatGetAbsoluteTime(
     CXPLAT_DBG_ASSERT(ErrorCode == 0);
     UNREFERENCED_PARAMETER(ErrorCode);
 
-    Time->tv_sec += (DeltaMs / CXPLAT_MS_PER_SECOND);
-    Time->tv_nsec += ((DeltaMs % CXPLAT_MS_PER_SECOND) * CXPLAT_NANOSEC_PER_MS);
+    Time->tv_sec += (time_t)(DeltaUs / CXPLAT_MICROSEC_PER_SEC);
+    Time->tv_nsec += (long)((DeltaUs % CXPLAT_MICROSEC_PER_SEC) * CXPLAT_NANOSEC_PER_MICROSEC);
 
     if (Time->tv_nsec >= CXPLAT_NANOSEC_PER_SEC)
     {
@@ -293,13 +809,51 @@ CxPlatSleep(
     UNREFERENCED_PARAMETER(ErrorCode);
 }
 
+void
+CxPlatSleepUs(
+    _In_ uint64_t DurationUs
+    )
+{
+    int ErrorCode = 0;
+
+#if __linux__
+    //
+    // Sleep until an absolute deadline so that restarting after a signal
+    // doesn't extend the total sleep time.
+    //
+    struct timespec Deadline;
+    CxPlatGetAbsoluteTimeUs(DurationUs, &Deadline);
+    do {
+        ErrorCode = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Deadline, NULL);
+    } while (ErrorCode == EINTR);
+#else
+    struct timespec TS = {
+        .tv_sec = (time_t)(DurationUs / CXPLAT_MICROSEC_PER_SEC),
+        .tv_nsec = (long)(CXPLAT_NANOSEC_PER_MICROSEC * (DurationUs % CXPLAT_MICROSEC_PER_SEC))
+    };
+    while ((ErrorCode = nanosleep(&TS, &TS)) != 0 && errno == EINTR) {
+    }
+#endif
+
+    CXPLAT_DBG_ASSERT(ErrorCode == 0);
+    UNREFERENCED_PARAMETER(ErrorCode);
+}
+
 uint32_t
-CxPlatProcCurrentNumber(
+CxPlatInternalProcCurrentNumber(
     void
     )
 {
 #if __linux__
-    return (uint32_t)sched_getcpu() % CxPlatProcessorCount;
+    //
+    // Threads can still run outside the usable set if the affinity mask was
+    // changed, or the set was trimmed for a cgroup quota.
+    //
+    const uint32_t Cpu = (uint32_t)sched_getcpu();
+    if (Cpu < CxPlatProcessorCpuLimit && CxPlatProcessorIndexes[Cpu] != UINT32_MAX) {
+        return CxPlatProcessorIndexes[Cpu];
+    }
+    return Cpu % CxPlatProcessorCount;
 #else
     //
     // arm64 macOS has no way to get the current proc, so treat as single core.
@@ -311,6 +865,91 @@ CxPlatProcCurrentNumber(
 
 #if __linux__
 
+//
+// Builds the set of OS processors the thread should run on. Returns FALSE if
+// the thread shouldn't be restricted, including when none of the requested
+// processors are usable.
+//
+static
+BOOLEAN
+CxPlatThreadGetAffinity(
+    _In_ const CXPLAT_THREAD_CONFIG* Config,
+    _Out_ cpu_set_t* CpuSet
+    )
+{
+    CPU_ZERO(CpuSet);
+
+    if (Config->Flags & CXPLAT_THREAD_FLAG_SET_AFFINITIZE) {
+        CXPLAT_DBG_ASSERT(Config->IdealProcessor < CxPlatProcessorCount);
+        if (Config->IdealProcessor < CxPlatProcessorCount) {
+            CPU_SET(CxPlatProcessorMap[Config->IdealProcessor], CpuSet);
+        }
+    } else if (Config->Flags & CXPLAT_THREAD_FLAG_SET_PROCESSORS) {
+        for (uint32_t i = 0; i < Config->ProcessorCount; ++i) {
+            if (Config->Processors[i] < CxPlatProcessorCount) {
+                CPU_SET(CxPlatProcessorMap[Config->Processors[i]], CpuSet);
+            }
+        }
+    } else {
+        uint32_t Node;
+        if (Config->Flags & CXPLAT_THREAD_FLAG_SET_NUMA_NODE) {
+            Node = Config->NumaNode;
+#ifdef CXPLAT_NUMA_AWARE
+        } else if (CxPlatNumaNodeCount > 1 && Config->IdealProcessor < CxPlatProcessorCount) {
+            Node = CxPlatProcessorTopology[Config->IdealProcessor].NumaNode;
+#endif
+        } else {
+            return FALSE;
+        }
+        for (uint32_t i = 0; i < CxPlatProcessorCount; ++i) {
+            if (CxPlatProcessorTopology[i].NumaNode == Node) {
+                CPU_SET(CxPlatProcessorMap[i], CpuSet);
+            }
+        }
+    }
+
+    if (CPU_COUNT(CpuSet) == 0) {
+        CxPlatTraceLogWarning(
+            "[ lib] No usable processors for thread %s, not affinitizing",
+            Config->Name);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+#define CXPLAT_MPOL_PREFERRED 1 // From linux/mempolicy.h, which conflicts with numaif.h
+
+typedef struct CXPLAT_THREAD_NUMA_CONTEXT {
+    LPTHREAD_START_ROUTINE Callback;
+    void* Context;
+    uint32_t NumaNode;
+} CXPLAT_THREAD_NUMA_CONTEXT;
+
+//
+// Memory policy is per thread, so it has to be set from the new thread
+// before the callback runs and touches any memory.
+//
+static
+CXPLAT_THREAD_CALLBACK(CxPlatThreadNumaStart, Context)
+{
+    CXPLAT_THREAD_NUMA_CONTEXT NumaContext = *(CXPLAT_THREAD_NUMA_CONTEXT*)Context;
+    CXPLAT_FREE(Context, CXPLAT_POOL_CUSTOM_THREAD);
+
+    unsigned long NodeMask[CPU_SETSIZE / (8 * sizeof(unsigned long))] = {0};
+    if (NumaContext.NumaNode < CPU_SETSIZE) {
+        NodeMask[NumaContext.NumaNode / (8 * sizeof(unsigned long))] =
+            1ul << (NumaContext.NumaNode % (8 * sizeof(unsigned long)));
+        if (syscall(SYS_set_mempolicy, CXPLAT_MPOL_PREFERRED, NodeMask, CPU_SETSIZE + 1) != 0) {
+            CxPlatTraceEvent(
+                "[ lib] ERROR, %u, %s.",
+                errno,
+                "set_mempolicy failed");
+        }
+    }
+
+    return NumaContext.Callback(NumaContext.Context);
+}
+
 CXPLAT_STATUS
 CxPlatThreadCreate(
     _In_ CXPLAT_THREAD_CONFIG* Config,
@@ -328,22 +967,41 @@ CxPlatThreadCreate(
         return errno;
     }
 
+    //
+    // Set the affinity up front where possible, so the thread never runs (or
+    // first touches its stack) anywhere else.
+    //
+    cpu_set_t CpuSet;
+    const BOOLEAN Affinitize = CxPlatThreadGetAffinity(Config, &CpuSet);
 #ifdef __GLIBC__
-    if (Config->Flags & CXPLAT_THREAD_FLAG_SET_AFFINITIZE) {
-        cpu_set_t CpuSet;
-        CPU_ZERO(&CpuSet);
-        CPU_SET(Config->IdealProcessor, &CpuSet);
-        if (pthread_attr_setaffinity_np(&Attr, sizeof(CpuSet), &CpuSet)) {
-            CxPlatTraceEvent(
-                "[ lib] ERROR, %s.",
-                "pthread_attr_setaffinity_np failed");
-        }
-    } else {
-        // TODO - Set Linux equivalent of NUMA affinity.
+    if (Affinitize && pthread_attr_setaffinity_np(&Attr, sizeof(CpuSet), &CpuSet)) {
+        CxPlatTraceEvent(
+            "[ lib] ERROR, %s.",
+            "pthread_attr_setaffinity_np failed");
     }
     // There is no way to set an ideal processor in Linux.
 #endif
 
+    LPTHREAD_START_ROUTINE Callback = Config->Callback;
+    void* Context = Config->Context;
+    if (Config->Flags & CXPLAT_THREAD_FLAG_SET_NUMA_NODE) {
+        CXPLAT_THREAD_NUMA_CONTEXT* NumaContext =
+            CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_THREAD_NUMA_CONTEXT), CXPLAT_POOL_CUSTOM_THREAD);
+        if (NumaContext == NULL) {
+            CxPlatTraceEvent(
+                "Allocation of '%s' failed. (%llu bytes)",
+                "NUMA thread context",
+                (unsigned long long)sizeof(CXPLAT_THREAD_NUMA_CONTEXT));
+            pthread_attr_destroy(&Attr);
+            return CXPLAT_STATUS_OUT_OF_MEMORY;
+        }
+        NumaContext->Callback = Callback;
+        NumaContext->Context = Context;
+        NumaContext->NumaNode = Config->NumaNode;
+        Callback = CxPlatThreadNumaStart;
+        Context = NumaContext;
+    }
+
     if (Config->Flags & CXPLAT_THREAD_FLAG_HIGH_PRIORITY) {
         struct sched_param Params;
         Params.sched_priority = sched_get_priority_max(SCHED_FIFO);
@@ -366,8 +1024,8 @@ CxPlatThreadCreate(
             "Custom thread context",
             sizeof(CXPLAT_THREAD_CUSTOM_CONTEXT));
     }
-    CustomContext->Callback = Config->Callback;
-    CustomContext->Context = Config->Context;
+    CustomContext->Callback = Callback;
+    CustomContext->Context = Context;
 
     if (pthread_create(Thread, &Attr, CxPlatThreadCustomStart, CustomContext)) {
         Status = errno;
@@ -376,6 +1034,9 @@ CxPlatThreadCreate(
             Status,
             "pthread_create failed");
         CXPLAT_FREE(CustomContext, CXPLAT_POOL_CUSTOM_THREAD);
+        if (Callback == CxPlatThreadNumaStart) {
+            CXPLAT_FREE(Context, CXPLAT_POOL_CUSTOM_THREAD);
+        }
     }
 
 #else // CXPLAT_USE_CUSTOM_THREAD_CONTEXT
@@ -384,40 +1045,29 @@ CxPlatThreadCreate(
     // If pthread_create fails with an error code, then try again without the attribute
     // because the CPU might be offline.
     //
-    if (pthread_create(Thread, &Attr, Config->Callback, Config->Context)) {
+    if (pthread_create(Thread, &Attr, Callback, Context)) {
         CxPlatTraceLogWarning(
             "[ lib] pthread_create failed, retrying without affinitization");
-        if (pthread_create(Thread, NULL, Config->Callback, Config->Context)) {
+        if (pthread_create(Thread, NULL, Callback, Context)) {
             Status = errno;
             CxPlatTraceEvent(
                 "[ lib] ERROR, %u, %s.",
                 Status,
                 "pthread_create failed");
+            if (Callback == CxPlatThreadNumaStart) {
+                CXPLAT_FREE(Context, CXPLAT_POOL_CUSTOM_THREAD);
+            }
         }
     }
 
 #endif // !CXPLAT_USE_CUSTOM_THREAD_CONTEXT
 
-#if !defined(__ANDROID__)
-    if (Status == CXPLAT_STATUS_SUCCESS) {
-        if (Config->Flags & CXPLAT_THREAD_FLAG_SET_AFFINITIZE) {
-            cpu_set_t CpuSet;
-            CPU_ZERO(&CpuSet);
-            CPU_SET(Config->IdealProcessor, &CpuSet);
-            if (pthread_setaffinity_np(*Thread, sizeof(CpuSet), &CpuSet)) {
-                CxPlatTraceEvent(
-                    "[ lib] ERROR, %s.",
-                    "pthread_setaffinity_np failed");
-            }
-#ifdef CXPLAT_NUMA_AWARE
-        } else if (CxPlatNumaNodeCount != 0) {
-            int IdealNumaNode = numa_node_of_cpu((int)Config->IdealProcessor);
-            if (pthread_setaffinity_np(*Thread, sizeof(cpu_set_t), &CxPlatNumaNodeMasks[IdealNumaNode])) {
-                CxPlatTraceEvent(
-                    "[ lib] ERROR, %s.",
-                    "pthread_setaffinity_np failed");
-            }
-#endif
+#if !defined(__GLIBC__) && !defined(__ANDROID__)
+    if (Status == CXPLAT_STATUS_SUCCESS && Affinitize) {
+        if (pthread_setaffinity_np(*Thread, sizeof(CpuSet), &CpuSet)) {
+            CxPlatTraceEvent(
+                "[ lib] ERROR, %s.",
+                "pthread_setaffinity_np failed");
         }
     }
 #endif
@@ -524,3 +1174,178 @@ CxPlatRandom(
     }
     return CXPLAT_STATUS_SUCCESS;
 }
+
+#if __linux__
+
+//
+// Wait on address is implemented directly with futexes.
+//
+
+static
+int
+CxPlatFutex(
+    _In_ volatile uint32_t* Address,
+    _In_ int Op,
+    _In_ uint32_t Value,
+    _In_opt_ const struct timespec* Timeout
+    )
+{
+    return (int)syscall(SYS_futex, Address, Op, Value, Timeout, NULL, 0);
+}
+
+void
+CxPlatWaitOnAddressForever(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue
+    )
+{
+    (void)CxPlatFutex(Address, FUTEX_WAIT_PRIVATE, CompareValue, NULL);
+}
+
+BOOLEAN
+CxPlatWaitOnAddressWithTimeoutUs(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue,
+    _In_ uint64_t TimeoutUs
+    )
+{
+    //
+    // FUTEX_WAIT takes a relative timeout, measured against CLOCK_MONOTONIC.
+    //
+    struct timespec Timeout = {
+        .tv_sec = (time_t)(TimeoutUs / CXPLAT_MICROSEC_PER_SEC),
+        .tv_nsec = (long)(CXPLAT_NANOSEC_PER_MICROSEC * (TimeoutUs % CXPLAT_MICROSEC_PER_SEC))
+    };
+    if (CxPlatFutex(Address, FUTEX_WAIT_PRIVATE, CompareValue, &Timeout) == -1 &&
+        errno == ETIMEDOUT) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void
+CxPlatWakeByAddressSingle(
+    _In_ volatile uint32_t* Address
+    )
+{
+    (void)CxPlatFutex(Address, FUTEX_WAKE_PRIVATE, 1, NULL);
+}
+
+void
+CxPlatWakeByAddressAll(
+    _In_ volatile uint32_t* Address
+    )
+{
+    (void)CxPlatFutex(Address, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL);
+}
+
+#else // __linux__
+
+//
+// Without futexes, waiters park on one of a fixed set of mutex/condition
+// pairs selected by hashing the address. Unrelated addresses may share a
+// bucket, so wakes are always broadcast and waiters re-check their value.
+//
+
+#define CXPLAT_PARKING_LOT_SIZE 64
+
+typedef struct CXPLAT_PARKING_BUCKET {
+    alignas(CXPLAT_CACHE_LINE_SIZE) pthread_mutex_t Mutex;
+    pthread_cond_t Cond;
+} CXPLAT_PARKING_BUCKET;
+
+static CXPLAT_PARKING_BUCKET CxPlatParkingLot[CXPLAT_PARKING_LOT_SIZE];
+static pthread_once_t CxPlatParkingLotOnce = PTHREAD_ONCE_INIT;
+
+static
+void
+CxPlatParkingLotInitialize(
+    void
+    )
+{
+    for (uint32_t i = 0; i < CXPLAT_PARKING_LOT_SIZE; ++i) {
+        CXPLAT_FRE_ASSERT(pthread_mutex_init(&CxPlatParkingLot[i].Mutex, NULL) == 0);
+        CXPLAT_FRE_ASSERT(pthread_cond_init(&CxPlatParkingLot[i].Cond, NULL) == 0);
+    }
+}
+
+static
+CXPLAT_PARKING_BUCKET*
+CxPlatParkingLotGetBucket(
+    _In_ volatile uint32_t* Address
+    )
+{
+    pthread_once(&CxPlatParkingLotOnce, CxPlatParkingLotInitialize);
+    const uintptr_t Hash = ((uintptr_t)Address >> 2) * (uintptr_t)0x9E3779B97F4A7C15ull;
+    return &CxPlatParkingLot[(Hash >> 16) % CXPLAT_PARKING_LOT_SIZE];
+}
+
+static
+BOOLEAN
+CxPlatParkingLotWait(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue,
+    _In_opt_ const struct timespec* Deadline
+    )
+{
+    CXPLAT_PARKING_BUCKET* Bucket = CxPlatParkingLotGetBucket(Address);
+    BOOLEAN Woken = TRUE;
+
+    CXPLAT_FRE_ASSERT(pthread_mutex_lock(&Bucket->Mutex) == 0);
+    if (*Address == CompareValue) {
+        if (Deadline == NULL) {
+            CXPLAT_FRE_ASSERT(pthread_cond_wait(&Bucket->Cond, &Bucket->Mutex) == 0);
+        } else if (pthread_cond_timedwait(&Bucket->Cond, &Bucket->Mutex, Deadline) == ETIMEDOUT) {
+            Woken = FALSE;
+        }
+    }
+    CXPLAT_FRE_ASSERT(pthread_mutex_unlock(&Bucket->Mutex) == 0);
+
+    return Woken;
+}
+
+void
+CxPlatWaitOnAddressForever(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue
+    )
+{
+    (void)CxPlatParkingLotWait(Address, CompareValue, NULL);
+}
+
+BOOLEAN
+CxPlatWaitOnAddressWithTimeoutUs(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue,
+    _In_ uint64_t TimeoutUs
+    )
+{
+    struct timespec Deadline;
+    CxPlatGetAbsoluteTimeUs(TimeoutUs, &Deadline);
+    return CxPlatParkingLotWait(Address, CompareValue, &Deadline);
+}
+
+void
+CxPlatWakeByAddressSingle(
+    _In_ volatile uint32_t* Address
+    )
+{
+    CxPlatWakeByAddressAll(Address);
+}
+
+void
+CxPlatWakeByAddressAll(
+    _In_ volatile uint32_t* Address
+    )
+{
+    //
+    // Taking the lock orders this wake after any waiter that has already
+    // compared the value but not yet blocked.
+    //
+    CXPLAT_PARKING_BUCKET* Bucket = CxPlatParkingLotGetBucket(Address);
+    CXPLAT_FRE_ASSERT(pthread_mutex_lock(&Bucket->Mutex) == 0);
+    CXPLAT_FRE_ASSERT(pthread_cond_broadcast(&Bucket->Cond) == 0);
+    CXPLAT_FRE_ASSERT(pthread_mutex_unlock(&Bucket->Mutex) == 0);
+}
+
+#endif // __linux__
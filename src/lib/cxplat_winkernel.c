@@ -8,6 +8,11 @@ typedef struct CX_PLATFORM {
     //
     BCRYPT_ALG_HANDLE RngAlgorithm;
 
+    //
+    // High resolution timers not currently in use by a wait.
+    //
+    SLIST_HEADER HighResTimers;
+
 #if DEBUG
     //
     // 1/Denominator of allocations to fail.
@@ -27,6 +32,12 @@ uint64_t CxPlatPerfFreq;
 uint32_t CxPlatProcessorCount;
 CX_PLATFORM CxPlatform = { NULL };
 
+static
+void
+CxPlatHighResTimersUninitialize(
+    void
+    );
+
 PAGEDX
 _IRQL_requires_max_(PASSIVE_LEVEL)
 CXPLAT_STATUS
@@ -56,6 +67,12 @@ CxPlatInitialize(
     }
     CXPLAT_DBG_ASSERT(CxPlatform.RngAlgorithm != NULL);
 
+    InitializeSListHead(&CxPlatform.HighResTimers);
+
+    CxPlatTimeCoarseInitialize();
+    CxPlatTimerServiceInitialize();
+    CxPlatThreadCacheInitialize();
+
     CxPlatTraceLogInfo(
         "[ sys] Initialized");
 
@@ -79,6 +96,10 @@ CxPlatUninitialize(
     )
 {
     PAGED_CODE();
+    CxPlatThreadCacheUninitialize();
+    CxPlatTimerServiceUninitialize();
+    CxPlatTimeCoarseUninitialize();
+    CxPlatHighResTimersUninitialize();
     BCryptCloseAlgorithmProvider(CxPlatform.RngAlgorithm, 0);
     CxPlatform.RngAlgorithm = NULL;
     CxPlatTraceLogInfo(
@@ -140,3 +161,114 @@ CxPlatRandom(
             BufferLen,
             0);
 }
+
+//
+// High resolution timers are too expensive to allocate for every wait, so
+// each one is put back on a lock-free list once its wait is done and reused
+// by the next.
+//
+typedef struct CXPLAT_HIGH_RES_TIMER {
+    SLIST_ENTRY Link;
+    PEX_TIMER Timer;
+} CXPLAT_HIGH_RES_TIMER;
+
+//
+// Takes a one-shot high resolution timer and sets it to fire after
+// DurationUs. Returns NULL if a new timer can't be allocated, in which case
+// callers fall back to the regular (system tick granularity) relative
+// timeouts.
+//
+static
+CXPLAT_HIGH_RES_TIMER*
+CxPlatHighResTimerAcquire(
+    _In_ uint64_t DurationUs
+    )
+{
+    CXPLAT_HIGH_RES_TIMER* Timer =
+        (CXPLAT_HIGH_RES_TIMER*)InterlockedPopEntrySList(&CxPlatform.HighResTimers);
+    if (Timer == NULL) {
+        Timer = CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_HIGH_RES_TIMER), CXPLAT_POOL_HIGH_RES_TIMER);
+        if (Timer == NULL) {
+            return NULL;
+        }
+        Timer->Timer = ExAllocateTimer(NULL, NULL, EX_TIMER_HIGH_RESOLUTION);
+        if (Timer->Timer == NULL) {
+            CXPLAT_FREE(Timer, CXPLAT_POOL_HIGH_RES_TIMER);
+            return NULL;
+        }
+    }
+    ExSetTimer(Timer->Timer, -(LONGLONG)US_TO_NS100(DurationUs), 0, NULL);
+    return Timer;
+}
+
+static
+void
+CxPlatHighResTimerRelease(
+    _In_ CXPLAT_HIGH_RES_TIMER* Timer
+    )
+{
+    (void)ExCancelTimer(Timer->Timer, NULL);
+    InterlockedPushEntrySList(&CxPlatform.HighResTimers, &Timer->Link);
+}
+
+static
+void
+CxPlatHighResTimersUninitialize(
+    void
+    )
+{
+    CXPLAT_HIGH_RES_TIMER* Timer;
+    while ((Timer =
+            (CXPLAT_HIGH_RES_TIMER*)InterlockedPopEntrySList(&CxPlatform.HighResTimers)) != NULL) {
+        ExDeleteTimer(Timer->Timer, TRUE, FALSE, NULL);
+        CXPLAT_FREE(Timer, CXPLAT_POOL_HIGH_RES_TIMER);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+CxPlatSleepUs(
+    _In_ uint64_t DurationUs
+    )
+{
+    CXPLAT_HIGH_RES_TIMER* Timer = CxPlatHighResTimerAcquire(DurationUs);
+    if (Timer == NULL) {
+        LARGE_INTEGER Delay;
+        Delay.QuadPart = -(LONGLONG)US_TO_NS100(DurationUs);
+        KeDelayExecutionThread(KernelMode, FALSE, &Delay);
+        return;
+    }
+    KeWaitForSingleObject(Timer->Timer, Executive, KernelMode, FALSE, NULL);
+    CxPlatHighResTimerRelease(Timer);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+CxPlatInternalEventWaitWithTimeoutUs(
+    _In_ CXPLAT_EVENT* Event,
+    _In_ uint64_t TimeoutUs
+    )
+{
+    CXPLAT_DBG_ASSERT(TimeoutUs != UINT64_MAX);
+
+    LARGE_INTEGER Timeout100Ns;
+    Timeout100Ns.QuadPart = -(LONGLONG)US_TO_NS100(TimeoutUs);
+
+    CXPLAT_HIGH_RES_TIMER* Timer =
+        TimeoutUs == 0 ? NULL : CxPlatHighResTimerAcquire(TimeoutUs);
+    if (Timer == NULL) {
+        return
+            STATUS_SUCCESS ==
+            KeWaitForSingleObject(Event, Executive, KernelMode, FALSE, &Timeout100Ns);
+    }
+
+    //
+    // The event is listed first so that it wins if both are signaled.
+    //
+    PVOID Objects[2] = { Event, Timer->Timer };
+    NTSTATUS Status =
+        KeWaitForMultipleObjects(
+            2, Objects, WaitAny, Executive, KernelMode, FALSE, NULL, NULL);
+    CxPlatHighResTimerRelease(Timer);
+    return Status == STATUS_WAIT_0;
+}
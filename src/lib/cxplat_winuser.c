@@ -9,6 +9,11 @@ typedef struct CX_PLATFORM {
     //
     HANDLE Heap;
 
+    //
+    // Fiber local slot caching each thread's high resolution timer.
+    //
+    DWORD HighResTimerFlsIndex;
+
 #if DEBUG
     //
     // 1/Denominator of allocations to fail.
@@ -25,11 +30,18 @@ typedef struct CX_PLATFORM {
 } CX_PLATFORM;
 
 uint64_t CxPlatPerfFreq;
-CX_PLATFORM CxPlatform = { NULL };
+CX_PLATFORM CxPlatform = { NULL, FLS_OUT_OF_INDEXES };
 CXPLAT_PROCESSOR_INFO* CxPlatProcessorInfo;
 CXPLAT_PROCESSOR_GROUP_INFO* CxPlatProcessorGroupInfo;
 uint32_t CxPlatProcessorCount;
 
+static
+VOID
+WINAPI
+CxPlatHighResTimerFlsCleanup(
+    _In_opt_ PVOID Timer
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 CXPLAT_STATUS
@@ -235,6 +247,11 @@ CxPlatInitialize(
     CxPlatform.AllocCounter = 0;
 #endif
 
+    //
+    // Without a slot, high resolution waits just create a timer each time.
+    //
+    CxPlatform.HighResTimerFlsIndex = FlsAlloc(CxPlatHighResTimerFlsCleanup);
+
     if (CXPLAT_FAILED(Status = CxPlatProcessorInfoInit())) {
         CxPlatTraceEvent(
             "[ lib] ERROR, %s.",
@@ -243,6 +260,10 @@ CxPlatInitialize(
     }
     ProcInfoInitialized = TRUE;
 
+    CxPlatTimeCoarseInitialize();
+    CxPlatTimerServiceInitialize();
+    CxPlatThreadCacheInitialize();
+
     CxPlatTraceLogInfo(
         "[ dll] Initialized");
 
@@ -254,6 +275,10 @@ Error:
         if (ProcInfoInitialized) {
             CxPlatProcessorInfoUnInit();
         }
+        if (CxPlatform.HighResTimerFlsIndex != FLS_OUT_OF_INDEXES) {
+            FlsFree(CxPlatform.HighResTimerFlsIndex);
+            CxPlatform.HighResTimerFlsIndex = FLS_OUT_OF_INDEXES;
+        }
         if (CxPlatform.Heap) {
             HeapDestroy(CxPlatform.Heap);
             CxPlatform.Heap = NULL;
@@ -269,7 +294,14 @@ CxPlatUninitialize(
     void
     )
 {
+    CxPlatThreadCacheUninitialize();
+    CxPlatTimerServiceUninitialize();
+    CxPlatTimeCoarseUninitialize();
     CxPlatProcessorInfoUnInit();
+    if (CxPlatform.HighResTimerFlsIndex != FLS_OUT_OF_INDEXES) {
+        FlsFree(CxPlatform.HighResTimerFlsIndex); // Closes every thread's timer.
+        CxPlatform.HighResTimerFlsIndex = FLS_OUT_OF_INDEXES;
+    }
     HeapDestroy(CxPlatform.Heap);
     CxPlatform.Heap = NULL;
 
@@ -385,3 +417,155 @@ CxPlatRandom(
             BufferLen,
             BCRYPT_USE_SYSTEM_PREFERRED_RNG);
 }
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+static
+VOID
+WINAPI
+CxPlatHighResTimerFlsCleanup(
+    _In_opt_ PVOID Timer
+    )
+{
+    if (Timer != NULL) {
+        CloseHandle((HANDLE)Timer);
+    }
+}
+
+//
+// Sets the calling thread's high resolution timer to fire once after
+// DurationUs. The timer is created on the thread's first such wait and closed
+// when the thread exits. Returns NULL if high resolution timers aren't
+// supported on this OS version, or the timer can't be cached.
+//
+static
+HANDLE
+CxPlatArmHighResTimer(
+    _In_ uint64_t DurationUs
+    )
+{
+    if (CxPlatform.HighResTimerFlsIndex == FLS_OUT_OF_INDEXES) {
+        return NULL;
+    }
+
+    HANDLE Timer = (HANDLE)FlsGetValue(CxPlatform.HighResTimerFlsIndex);
+    if (Timer == NULL) {
+        Timer =
+            CreateWaitableTimerExW(
+                NULL,
+                NULL,
+                CREATE_WAITABLE_TIMER_MANUAL_RESET | CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                TIMER_ALL_ACCESS);
+        if (Timer == NULL) {
+            return NULL;
+        }
+        if (!FlsSetValue(CxPlatform.HighResTimerFlsIndex, Timer)) {
+            CloseHandle(Timer);
+            return NULL;
+        }
+    }
+
+    //
+    // Setting the timer also resets it, whether it fired or was left pending
+    // by a wait that ended early.
+    //
+    LARGE_INTEGER DueTime;
+    DueTime.QuadPart = -(LONGLONG)US_TO_NS100(DurationUs);
+    if (!SetWaitableTimer(Timer, &DueTime, 0, NULL, NULL, FALSE)) {
+        return NULL;
+    }
+    return Timer;
+}
+
+//
+// Fallback for when high resolution timers aren't available. Rounds up so the
+// wait is never shorter than requested.
+//
+#define CXPLAT_US_TO_WAIT_MS(Us) \
+    ((Us) >= (uint64_t)(INFINITE - 1) * 1000 ? INFINITE - 1 : (DWORD)(((Us) + 999) / 1000))
+
+void
+CxPlatSleepUs(
+    _In_ uint64_t DurationUs
+    )
+{
+    HANDLE Timer = CxPlatArmHighResTimer(DurationUs);
+    if (Timer == NULL) {
+        Sleep(CXPLAT_US_TO_WAIT_MS(DurationUs));
+        return;
+    }
+    WaitForSingleObject(Timer, INFINITE);
+}
+
+BOOLEAN
+CxPlatEventWaitWithTimeoutUs(
+    _In_ CXPLAT_EVENT Event,
+    _In_ uint64_t TimeoutUs
+    )
+{
+    CXPLAT_DBG_ASSERT(TimeoutUs != UINT64_MAX);
+
+    if (TimeoutUs == 0) {
+        return WAIT_OBJECT_0 == WaitForSingleObject(Event, 0);
+    }
+
+    HANDLE Timer = CxPlatArmHighResTimer(TimeoutUs);
+    if (Timer == NULL) {
+        return WAIT_OBJECT_0 == WaitForSingleObject(Event, CXPLAT_US_TO_WAIT_MS(TimeoutUs));
+    }
+
+    //
+    // The event is listed first so that it wins if both are signaled.
+    //
+    HANDLE Handles[2] = { Event, Timer };
+    DWORD Result = WaitForMultipleObjects(2, Handles, FALSE, INFINITE);
+    return Result == WAIT_OBJECT_0;
+}
+
+void
+CxPlatWaitOnAddressForever(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue
+    )
+{
+    (void)WaitOnAddress(Address, &CompareValue, sizeof(CompareValue), INFINITE);
+}
+
+BOOLEAN
+CxPlatWaitOnAddressWithTimeoutUs(
+    _In_ volatile uint32_t* Address,
+    _In_ uint32_t CompareValue,
+    _In_ uint64_t TimeoutUs
+    )
+{
+    //
+    // WaitOnAddress only has millisecond granularity, so round up to avoid
+    // returning before the requested timeout.
+    //
+    if (!WaitOnAddress(
+            Address,
+            &CompareValue,
+            sizeof(CompareValue),
+            CXPLAT_US_TO_WAIT_MS(TimeoutUs))) {
+        return GetLastError() != ERROR_TIMEOUT;
+    }
+    return TRUE;
+}
+
+void
+CxPlatWakeByAddressSingle(
+    _In_ volatile uint32_t* Address
+    )
+{
+    WakeByAddressSingle((PVOID)Address);
+}
+
+void
+CxPlatWakeByAddressAll(
+    _In_ volatile uint32_t* Address
+    )
+{
+    WakeByAddressAll((PVOID)Address);
+}
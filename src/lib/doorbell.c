@@ -0,0 +1,90 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Doorbell (coalescing wakeup channel) consumer side implementation.
+
+--*/
+
+#include "cxplat.h"
+
+uint32_t
+CxPlatDoorbellDrain(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    )
+{
+    int64_t Value = *(volatile int64_t*)&Doorbell->State;
+    while (Value >= CXPLAT_DOORBELL_RING) {
+        const int64_t Prev = InterlockedCompareExchange64(&Doorbell->State, 0, Value);
+        if (Prev == Value) {
+            return (uint32_t)(Value / CXPLAT_DOORBELL_RING);
+        }
+        Value = Prev;
+    }
+    return 0;
+}
+
+//
+// Marks the consumer as parked if there are no pending rings. Returns FALSE if
+// a ring arrived first, in which case the caller should drain instead.
+//
+static
+BOOLEAN
+CxPlatDoorbellPark(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    )
+{
+    return
+        InterlockedCompareExchange64(
+            &Doorbell->State, CXPLAT_DOORBELL_PARKED, 0) == 0;
+}
+
+uint32_t
+CxPlatDoorbellWait(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    )
+{
+    for (;;) {
+        uint32_t Rings = CxPlatDoorbellDrain(Doorbell);
+        if (Rings != 0) {
+            return Rings;
+        }
+        if (CxPlatDoorbellPark(Doorbell)) {
+            CxPlatEventWaitForever(Doorbell->Event);
+        }
+    }
+}
+
+uint32_t
+CxPlatDoorbellWaitWithTimeoutUs(
+    _Inout_ CXPLAT_DOORBELL* Doorbell,
+    _In_ uint64_t TimeoutUs
+    )
+{
+    uint32_t Rings = CxPlatDoorbellDrain(Doorbell);
+    if (Rings != 0 || TimeoutUs == 0 || !CxPlatDoorbellPark(Doorbell)) {
+        //
+        // Either rings were already pending, the caller doesn't want to block,
+        // or a ring raced with parking. In all cases just drain what's there.
+        //
+        return Rings != 0 ? Rings : CxPlatDoorbellDrain(Doorbell);
+    }
+
+    if (!CxPlatEventWaitWithTimeoutUs(Doorbell->Event, TimeoutUs)) {
+        //
+        // Timed out. Try to unpark; if that fails, a ring has already seen the
+        // parked state and will set the event, which must be consumed here so
+        // it doesn't spuriously wake a later wait.
+        //
+        if (InterlockedCompareExchange64(
+                &Doorbell->State, 0, CXPLAT_DOORBELL_PARKED) == CXPLAT_DOORBELL_PARKED) {
+            return 0;
+        }
+        CxPlatEventWaitForever(Doorbell->Event);
+    }
+
+    return CxPlatDoorbellDrain(Doorbell);
+}
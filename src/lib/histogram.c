@@ -0,0 +1,271 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Log-linear histogram with per-processor counters.
+
+    Values below 2^SignificantBits get a bucket each. Above that, the range
+    [2^N, 2^(N+1)) is split into 2^SignificantBits buckets of equal width, so
+    the bucket index is the value's exponent followed by its top
+    SignificantBits bits after the leading one.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+#define CXPLAT_HISTOGRAM_COUNTERS_PER_LINE (CXPLAT_CACHE_LINE_SIZE / sizeof(int64_t))
+
+static
+uint32_t
+CxPlatHistogramHighestSetBit(
+    _In_ uint64_t Value
+    )
+{
+    CXPLAT_DBG_ASSERT(Value != 0);
+#ifdef _WIN32
+    unsigned long Index;
+    _BitScanReverse64(&Index, Value);
+    return (uint32_t)Index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(Value);
+#endif
+}
+
+static
+uint32_t
+CxPlatHistogramBucketIndex(
+    _In_ const CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint64_t Value
+    )
+{
+    const uint32_t SignificantBits = Histogram->SignificantBits;
+
+    if (Histogram->MaxValueBits < 64 && (Value >> Histogram->MaxValueBits) != 0) {
+        Value = (1ull << Histogram->MaxValueBits) - 1;
+    }
+
+    if (Value < (1ull << SignificantBits)) {
+        return (uint32_t)Value;
+    }
+
+    const uint32_t Group = CxPlatHistogramHighestSetBit(Value) - SignificantBits + 1;
+    return
+        (Group << SignificantBits) +
+        (uint32_t)((Value >> (Group - 1)) - (1ull << SignificantBits));
+}
+
+//
+// Returns the largest value that maps to the bucket.
+//
+static
+uint64_t
+CxPlatHistogramBucketHighestValue(
+    _In_ const CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint32_t Index
+    )
+{
+    const uint32_t SignificantBits = Histogram->SignificantBits;
+    const uint32_t Group = Index >> SignificantBits;
+    const uint64_t Offset = Index & ((1u << SignificantBits) - 1);
+
+    if (Group == 0) {
+        return Offset;
+    }
+
+    return
+        (((1ull << SignificantBits) + Offset) << (Group - 1)) +
+        ((1ull << (Group - 1)) - 1);
+}
+
+static
+int64_t
+CxPlatHistogramReadCounter(
+    _In_ const CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint32_t Counter
+    )
+{
+    int64_t Total = 0;
+    for (uint32_t i = 0; i < Histogram->ShardCount; ++i) {
+        Total +=
+            *(volatile const int64_t*)
+                &Histogram->Shards[(size_t)i * Histogram->ShardStride + Counter];
+    }
+    return Total;
+}
+
+CXPLAT_STATUS
+CxPlatHistogramInitialize(
+    _Out_ CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint32_t SignificantBits,
+    _In_ uint32_t MaxValueBits
+    )
+{
+    CXPLAT_DBG_ASSERT(SignificantBits != 0);
+    CXPLAT_DBG_ASSERT(SignificantBits <= CXPLAT_HISTOGRAM_MAX_SIGNIFICANT_BITS);
+    CXPLAT_DBG_ASSERT(MaxValueBits > SignificantBits && MaxValueBits <= 64);
+
+    if (SignificantBits == 0) {
+        SignificantBits = 1;
+    } else if (SignificantBits > CXPLAT_HISTOGRAM_MAX_SIGNIFICANT_BITS) {
+        SignificantBits = CXPLAT_HISTOGRAM_MAX_SIGNIFICANT_BITS;
+    }
+    if (MaxValueBits <= SignificantBits) {
+        MaxValueBits = SignificantBits + 1;
+    } else if (MaxValueBits > 64) {
+        MaxValueBits = 64;
+    }
+
+    const uint32_t BucketCount = (MaxValueBits - SignificantBits + 1) << SignificantBits;
+
+    //
+    // Room for the sum after the buckets, rounded up to whole cache lines.
+    //
+    const uint32_t ShardStride =
+        (uint32_t)(((BucketCount + 1) + CXPLAT_HISTOGRAM_COUNTERS_PER_LINE - 1) &
+            ~(CXPLAT_HISTOGRAM_COUNTERS_PER_LINE - 1));
+    const uint32_t ShardCount = CxPlatProcCount();
+    const size_t ShardsSize = (size_t)ShardCount * ShardStride * sizeof(int64_t);
+
+    Histogram->Shards = CXPLAT_ALLOC_NONPAGED(ShardsSize, CXPLAT_POOL_HISTOGRAM);
+    if (Histogram->Shards == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_HISTOGRAM shards",
+            (unsigned long long)ShardsSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(Histogram->Shards, ShardsSize);
+    Histogram->SignificantBits = SignificantBits;
+    Histogram->MaxValueBits = MaxValueBits;
+    Histogram->BucketCount = BucketCount;
+    Histogram->ShardStride = ShardStride;
+    Histogram->ShardCount = ShardCount;
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+void
+CxPlatHistogramUninitialize(
+    _Inout_ CXPLAT_HISTOGRAM* Histogram
+    )
+{
+    CXPLAT_FREE(Histogram->Shards, CXPLAT_POOL_HISTOGRAM);
+    Histogram->Shards = NULL;
+}
+
+void
+CxPlatHistogramRecord(
+    _Inout_ CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint64_t Value
+    )
+{
+    int64_t* Shard =
+        Histogram->Shards +
+        (size_t)(CxPlatProcCurrentNumber() % Histogram->ShardCount) * Histogram->ShardStride;
+
+    InterlockedIncrement64(&Shard[CxPlatHistogramBucketIndex(Histogram, Value)]);
+    InterlockedExchangeAdd64(&Shard[Histogram->BucketCount], (int64_t)Value);
+}
+
+void
+CxPlatHistogramReset(
+    _Inout_ CXPLAT_HISTOGRAM* Histogram
+    )
+{
+    const size_t CounterCount = (size_t)Histogram->ShardCount * Histogram->ShardStride;
+    for (size_t i = 0; i < CounterCount; ++i) {
+        InterlockedExchange64(&Histogram->Shards[i], 0);
+    }
+}
+
+void
+CxPlatHistogramMerge(
+    _Inout_ CXPLAT_HISTOGRAM* Destination,
+    _In_ const CXPLAT_HISTOGRAM* Source
+    )
+{
+    CXPLAT_DBG_ASSERT(Destination->SignificantBits == Source->SignificantBits);
+    CXPLAT_DBG_ASSERT(Destination->MaxValueBits == Source->MaxValueBits);
+
+    //
+    // The sum is stored right after the buckets, so it's merged along with
+    // them.
+    //
+    for (uint32_t i = 0; i <= Source->BucketCount; ++i) {
+        const int64_t Count = CxPlatHistogramReadCounter(Source, i);
+        if (Count != 0) {
+            InterlockedExchangeAdd64(&Destination->Shards[i], Count);
+        }
+    }
+}
+
+uint64_t
+CxPlatHistogramCount(
+    _In_ const CXPLAT_HISTOGRAM* Histogram
+    )
+{
+    uint64_t Total = 0;
+    for (uint32_t i = 0; i < Histogram->BucketCount; ++i) {
+        Total += (uint64_t)CxPlatHistogramReadCounter(Histogram, i);
+    }
+    return Total;
+}
+
+uint64_t
+CxPlatHistogramMean(
+    _In_ const CXPLAT_HISTOGRAM* Histogram
+    )
+{
+    const uint64_t Count = CxPlatHistogramCount(Histogram);
+    if (Count == 0) {
+        return 0;
+    }
+    return
+        (uint64_t)CxPlatHistogramReadCounter(Histogram, Histogram->BucketCount) / Count;
+}
+
+uint64_t
+CxPlatHistogramValueAtPercentile(
+    _In_ const CXPLAT_HISTOGRAM* Histogram,
+    _In_ uint32_t PercentilePpm
+    )
+{
+    const uint64_t Million = 1000000;
+    const uint64_t Count = CxPlatHistogramCount(Histogram);
+    if (Count == 0) {
+        return 0;
+    }
+
+    if (PercentilePpm > Million) {
+        PercentilePpm = (uint32_t)Million;
+    }
+
+    //
+    // The rank of the value we're after, rounded up, computed in two parts so
+    // large counts don't overflow.
+    //
+    uint64_t Rank =
+        (Count / Million) * PercentilePpm +
+        ((Count % Million) * PercentilePpm + Million - 1) / Million;
+    if (Rank == 0) {
+        Rank = 1;
+    }
+
+    uint64_t Seen = 0;
+    for (uint32_t i = 0; i < Histogram->BucketCount; ++i) {
+        Seen += (uint64_t)CxPlatHistogramReadCounter(Histogram, i);
+        if (Seen >= Rank) {
+            return CxPlatHistogramBucketHighestValue(Histogram, i);
+        }
+    }
+
+    //
+    // Only reachable if values were recorded while counting.
+    //
+    return CxPlatHistogramBucketHighestValue(Histogram, Histogram->BucketCount - 1);
+}
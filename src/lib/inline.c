@@ -66,7 +66,7 @@ InterlockedCompareExchange16(
     _In_ short Comperand
     );
 
-short
+long
 InterlockedCompareExchange(
     _Inout_ _Interlocked_operand_ long volatile *Destination,
     _In_ long ExChange,
@@ -80,6 +80,18 @@ InterlockedCompareExchange64(
     _In_ int64_t Comperand
     );
 
+long
+InterlockedExchange(
+    _Inout_ _Interlocked_operand_ long volatile *Target,
+    _In_ long Value
+    );
+
+int64_t
+InterlockedExchange64(
+    _Inout_ _Interlocked_operand_ int64_t volatile *Target,
+    _In_ int64_t Value
+    );
+
 int64_t
 InterlockedExchangeAdd64(
     _Inout_ _Interlocked_operand_ int64_t volatile *Addend,
@@ -107,11 +119,53 @@ InterlockedFetchAndSetBoolean(
     _Inout_ _Interlocked_operand_ BOOLEAN volatile *Target
     );
 
+uint32_t
+CxPlatProcCurrentNumber(
+    void
+    );
+
+#ifdef CXPLAT_TIME_CPU_COUNTER
+uint64_t
+CxPlatTimeReadCpuCounter(
+    void
+    );
+#endif
+
+uint64_t
+CxPlatTimePlat(
+    void
+    );
+
+uint64_t
+CxPlatTimePlatToUs64(
+    uint64_t Count
+    );
+
+uint64_t
+CxPlatTimeUs64ToPlat(
+    uint64_t TimeUs
+    );
+
+uint64_t
+CxPlatInternalTimeCoarseUs64(
+    void
+    );
+
+uint64_t
+CxPlatTimeCoarseUs64(
+    void
+    );
+
 int64_t
 CxPlatTimeEpochMs64(
     void
     );
 
+uint64_t
+CxPlatInternalTimeEpochNs64(
+    void
+    );
+
 uint64_t
 CxPlatTimeDiff64(
     _In_ uint64_t T1,
@@ -168,3 +222,159 @@ CxPlatInternalEventWaitWithTimeout(
     _Inout_ CXPLAT_EVENT* Event,
     _In_ uint32_t TimeoutMs
     );
+
+BOOLEAN
+CxPlatInternalEventWaitWithTimeoutUs(
+    _Inout_ CXPLAT_EVENT* Event,
+    _In_ uint64_t TimeoutUs
+    );
+
+void
+CxPlatInternalEventWaitWithSpin(
+    _Inout_ CXPLAT_EVENT* Event,
+    _In_ uint32_t SpinCount
+    );
+
+void
+CxPlatListInitializeHead(
+    _Out_ CXPLAT_LIST_ENTRY* ListHead
+    );
+
+BOOLEAN
+CxPlatListIsEmpty(
+    _In_ const CXPLAT_LIST_ENTRY* ListHead
+    );
+
+void
+CxPlatListInsertHead(
+    _Inout_ CXPLAT_LIST_ENTRY* ListHead,
+    _Out_ CXPLAT_LIST_ENTRY* Entry
+    );
+
+void
+CxPlatListInsertTail(
+    _Inout_ CXPLAT_LIST_ENTRY* ListHead,
+    _Out_ CXPLAT_LIST_ENTRY* Entry
+    );
+
+BOOLEAN
+CxPlatListEntryRemove(
+    _Inout_ CXPLAT_LIST_ENTRY* Entry
+    );
+
+CXPLAT_LIST_ENTRY*
+CxPlatListRemoveHead(
+    _Inout_ CXPLAT_LIST_ENTRY* ListHead
+    );
+
+void
+CxPlatListMoveItems(
+    _Inout_ CXPLAT_LIST_ENTRY* Source,
+    _Inout_ CXPLAT_LIST_ENTRY* Destination
+    );
+
+void
+CxPlatTimerEntryInitialize(
+    _Out_ CXPLAT_TIMER_ENTRY* Entry
+    );
+
+BOOLEAN
+CxPlatTimerEntryIsQueued(
+    _In_ const CXPLAT_TIMER_ENTRY* Entry
+    );
+
+void
+CxPlatDoorbellInitialize(
+    _Out_ CXPLAT_DOORBELL* Doorbell
+    );
+
+void
+CxPlatDoorbellUninitialize(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    );
+
+void
+CxPlatDoorbellRing(
+    _Inout_ CXPLAT_DOORBELL* Doorbell
+    );
+
+void*
+CxPlatPerProcGet(
+    _In_ const CXPLAT_PER_PROC* PerProc,
+    _In_ uint32_t ProcIndex
+    );
+
+void*
+CxPlatPerProcGetCurrent(
+    _In_ const CXPLAT_PER_PROC* PerProc
+    );
+
+void
+CxPlatExecutionContextInitialize(
+    _Out_ CXPLAT_EXECUTION_CONTEXT* Context,
+    _In_ CXPLAT_EXECUTION_CONTEXT_RUN* Run,
+    _In_opt_ void* UserContext
+    );
+
+void
+CxPlatThreadPoolWorkInitialize(
+    _Out_ CXPLAT_THREAD_POOL_WORK* Work,
+    _In_ CXPLAT_THREAD_POOL_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _In_opt_ CXPLAT_THREAD_POOL_GROUP* Group
+    );
+
+void
+CxPlatThreadPoolGroupInitialize(
+    _Out_ CXPLAT_THREAD_POOL_GROUP* Group
+    );
+
+void
+CxPlatThreadPoolGroupUninitialize(
+    _Inout_ CXPLAT_THREAD_POOL_GROUP* Group
+    );
+
+void
+CxPlatRundownInitialize(
+    _Out_ CXPLAT_RUNDOWN_REF* Rundown
+    );
+
+void
+CxPlatRundownUninitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    );
+
+void
+CxPlatRundownReinitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    );
+
+BOOLEAN
+CxPlatInternalRundownCountAcquire(
+    _Inout_ int64_t* Count
+    );
+
+BOOLEAN
+CxPlatRundownAcquire(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    );
+
+void
+CxPlatRundownRelease(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    );
+
+void
+CxPlatRundownWait(
+    _Inout_ CXPLAT_RUNDOWN_REF* Rundown
+    );
+
+BOOLEAN
+CxPlatRundownCacheAwareAcquire(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    );
+
+void
+CxPlatRundownCacheAwareRelease(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    );
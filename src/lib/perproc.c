@@ -0,0 +1,180 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Per-processor storage.
+
+    The slot pointer table and the slots themselves share one allocation, so
+    uninitializing is a single free. Slots are laid out at a cache line
+    multiple stride. When NUMA aware, each node's slots are grouped together
+    starting on a page boundary, and each group's pages are bound to its node
+    before anything touches them.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+#ifdef CXPLAT_NUMA_AWARE
+#include <numa.h>
+#endif
+
+#define CXPLAT_PER_PROC_ALIGN_UP(Value, Alignment) \
+    (((Value) + (Alignment) - 1) & ~((size_t)(Alignment) - 1))
+
+#ifdef CXPLAT_NUMA_AWARE
+
+static
+BOOLEAN
+CxPlatPerProcIsFirstOnNode(
+    _In_ uint32_t ProcIndex
+    )
+{
+    for (uint32_t i = 0; i < ProcIndex; ++i) {
+        if (CxPlatProcessorTopology[i].NumaNode == CxPlatProcessorTopology[ProcIndex].NumaNode) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static
+CXPLAT_STATUS
+CxPlatPerProcInitializeNuma(
+    _Inout_ CXPLAT_PER_PROC* PerProc,
+    _In_ size_t Stride
+    )
+{
+    const uint32_t Count = PerProc->Count;
+    const size_t PageSize = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t TableSize = CXPLAT_PER_PROC_ALIGN_UP(Count * sizeof(void*), PageSize);
+    size_t Offset;
+    uint32_t Group, i;
+
+    //
+    // Size the allocation by laying out each node's group, in order of each
+    // node's first processor.
+    //
+    Offset = TableSize;
+    for (Group = 0; Group < Count; ++Group) {
+        const uint32_t Node = CxPlatProcessorTopology[Group].NumaNode;
+        if (!CxPlatPerProcIsFirstOnNode(Group)) {
+            continue;
+        }
+        Offset = CXPLAT_PER_PROC_ALIGN_UP(Offset, PageSize);
+        for (i = Group; i < Count; ++i) {
+            if (CxPlatProcessorTopology[i].NumaNode == Node) {
+                Offset += Stride;
+            }
+        }
+    }
+    const size_t AllocSize = CXPLAT_PER_PROC_ALIGN_UP(Offset, PageSize);
+
+    void* Allocation = NULL;
+    if (posix_memalign(&Allocation, PageSize, AllocSize) != 0) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_PER_PROC",
+            (unsigned long long)AllocSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+    PerProc->Slots = (void**)Allocation;
+
+    //
+    // Lay the groups out again, this time binding and filling them in.
+    //
+    Offset = TableSize;
+    for (Group = 0; Group < Count; ++Group) {
+        const uint32_t Node = CxPlatProcessorTopology[Group].NumaNode;
+        if (!CxPlatPerProcIsFirstOnNode(Group)) {
+            continue;
+        }
+        Offset = CXPLAT_PER_PROC_ALIGN_UP(Offset, PageSize);
+        const size_t GroupStart = Offset;
+        for (i = Group; i < Count; ++i) {
+            if (CxPlatProcessorTopology[i].NumaNode == Node) {
+                PerProc->Slots[i] = (uint8_t*)Allocation + Offset;
+                Offset += Stride;
+            }
+        }
+        numa_tonode_memory(
+            (uint8_t*)Allocation + GroupStart,
+            CXPLAT_PER_PROC_ALIGN_UP(Offset - GroupStart, PageSize),
+            (int)Node);
+    }
+
+    //
+    // Nothing touched the slots' pages until they were bound, so they are
+    // first faulted in here, on the right node.
+    //
+    for (i = 0; i < Count; ++i) {
+        CxPlatZeroMemory(PerProc->Slots[i], Stride);
+    }
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+#endif // CXPLAT_NUMA_AWARE
+
+CXPLAT_STATUS
+CxPlatPerProcInitialize(
+    _Out_ CXPLAT_PER_PROC* PerProc,
+    _In_ uint32_t SlotSize
+    )
+{
+    CXPLAT_DBG_ASSERT(SlotSize != 0);
+    const size_t Stride = CXPLAT_PER_PROC_ALIGN_UP((size_t)SlotSize, CXPLAT_CACHE_LINE_SIZE);
+
+    PerProc->Count = CxPlatProcCount();
+    PerProc->SlotSize = SlotSize;
+
+#ifdef CXPLAT_NUMA_AWARE
+    if (CxPlatNumaNodeCount > 1) {
+        return CxPlatPerProcInitializeNuma(PerProc, Stride);
+    }
+#endif
+
+    //
+    // The allocation is only guaranteed pointer alignment, so leave room to
+    // align the first slot to a cache line.
+    //
+    const size_t TableSize = PerProc->Count * sizeof(void*);
+    const size_t AllocSize = TableSize + CXPLAT_CACHE_LINE_SIZE + PerProc->Count * Stride;
+    PerProc->Slots = CXPLAT_ALLOC_NONPAGED(AllocSize, CXPLAT_POOL_PER_PROC);
+    if (PerProc->Slots == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_PER_PROC",
+            (unsigned long long)AllocSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    uint8_t* Slot =
+        (uint8_t*)CXPLAT_PER_PROC_ALIGN_UP(
+            (uintptr_t)PerProc->Slots + TableSize, CXPLAT_CACHE_LINE_SIZE);
+    CxPlatZeroMemory(Slot, PerProc->Count * Stride);
+    for (uint32_t i = 0; i < PerProc->Count; ++i, Slot += Stride) {
+        PerProc->Slots[i] = Slot;
+    }
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+void
+CxPlatPerProcUninitialize(
+    _Inout_ CXPLAT_PER_PROC* PerProc
+    )
+{
+#ifdef CXPLAT_NUMA_AWARE
+    if (CxPlatNumaNodeCount > 1) {
+        free(PerProc->Slots);
+        PerProc->Slots = NULL;
+        return;
+    }
+#endif
+    CXPLAT_FREE(PerProc->Slots, CXPLAT_POOL_PER_PROC);
+    PerProc->Slots = NULL;
+}
@@ -0,0 +1,205 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Lock-free token bucket rate limiter.
+
+    The bucket is tracked as the time at which it would be full again (the
+    theoretical arrival time, TAT). Taking N tokens pushes TAT out by N token
+    intervals, and is allowed as long as that doesn't put TAT more than the
+    burst size worth of intervals ahead of now. Refill is implicit in time
+    moving forward.
+
+    Times are kept in units of one token interval rather than nanoseconds,
+    so every rate is exact, however far it is from a whole number of
+    nanoseconds per token.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+//
+// Returns the current time in token intervals, and in microseconds. Whole
+// seconds are split off so the products stay within 64 bits.
+//
+static
+int64_t
+CxPlatRateLimiterNow(
+    _In_ const CXPLAT_RATE_LIMITER* Limiter,
+    _Out_opt_ uint64_t* NowUs
+    )
+{
+    const uint64_t TimeUs = CxPlatTimeUs64();
+    const uint64_t Seconds = US_TO_S(TimeUs);
+    if (NowUs != NULL) {
+        *NowUs = TimeUs;
+    }
+    return (int64_t)(
+        Seconds * Limiter->TokensPerSecond +
+        (TimeUs - S_TO_US(Seconds)) * Limiter->TokensPerSecond / S_TO_US(1));
+}
+
+//
+// Takes Tokens from the shared bucket.
+//
+static
+BOOLEAN
+CxPlatRateLimiterAcquireShared(
+    _Inout_ CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint64_t Tokens
+    )
+{
+    if (Tokens > Limiter->Burst) {
+        return FALSE;
+    }
+
+    const int64_t Now = CxPlatRateLimiterNow(Limiter, NULL);
+    int64_t Tat = *(volatile int64_t*)&Limiter->TheoreticalArrival;
+
+    for (;;) {
+        const int64_t NewTat = (Tat > Now ? Tat : Now) + (int64_t)Tokens;
+        if (NewTat - Now > (int64_t)Limiter->Burst) {
+            return FALSE;
+        }
+        const int64_t Prev =
+            InterlockedCompareExchange64(&Limiter->TheoreticalArrival, NewTat, Tat);
+        if (Prev == Tat) {
+            return TRUE;
+        }
+        Tat = Prev;
+    }
+}
+
+CXPLAT_STATUS
+CxPlatRateLimiterInitialize(
+    _Out_ CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint64_t TokensPerSecond,
+    _In_ uint32_t Burst,
+    _In_ uint32_t CacheSize
+    )
+{
+    CXPLAT_DBG_ASSERT(TokensPerSecond != 0);
+    CXPLAT_DBG_ASSERT(Burst != 0);
+
+    Limiter->Shards = NULL;
+    Limiter->ShardCount = 0;
+
+    if (TokensPerSecond == 0 || TokensPerSecond > CXPLAT_RATE_LIMITER_MAX_RATE) {
+        return CXPLAT_STATUS_NOT_SUPPORTED;
+    }
+
+    Limiter->TokensPerSecond = TokensPerSecond;
+    Limiter->Burst = Burst;
+    Limiter->TheoreticalArrival = 0;
+    Limiter->CacheSize = CacheSize < Burst ? CacheSize : Burst;
+
+    if (Limiter->CacheSize != 0) {
+        const uint32_t ShardCount = CxPlatProcCount();
+        const size_t ShardsSize = ShardCount * sizeof(CXPLAT_RATE_LIMITER_SHARD);
+
+        Limiter->Shards = CXPLAT_ALLOC_NONPAGED(ShardsSize, CXPLAT_POOL_RATE_LIMITER);
+        if (Limiter->Shards == NULL) {
+            CxPlatTraceEvent(
+                "Allocation of '%s' failed. (%llu bytes)",
+                "CXPLAT_RATE_LIMITER_SHARD",
+                (unsigned long long)ShardsSize);
+            return CXPLAT_STATUS_OUT_OF_MEMORY;
+        }
+
+        CxPlatZeroMemory(Limiter->Shards, ShardsSize);
+        Limiter->ShardCount = ShardCount;
+    }
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+void
+CxPlatRateLimiterUninitialize(
+    _Inout_ CXPLAT_RATE_LIMITER* Limiter
+    )
+{
+    if (Limiter->Shards != NULL) {
+        CXPLAT_FREE(Limiter->Shards, CXPLAT_POOL_RATE_LIMITER);
+        Limiter->Shards = NULL;
+    }
+}
+
+BOOLEAN
+CxPlatRateLimiterTryAcquire(
+    _Inout_ CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint32_t Tokens
+    )
+{
+    if (Limiter->Shards == NULL) {
+        return CxPlatRateLimiterAcquireShared(Limiter, Tokens);
+    }
+
+    int64_t* Cached =
+        &Limiter->Shards[CxPlatProcCurrentNumber() % Limiter->ShardCount].Tokens;
+    int64_t Value = *(volatile int64_t*)Cached;
+
+    //
+    // Take from this processor's cache if it has enough. The thread may have
+    // moved to another processor since picking the shard, which is harmless.
+    //
+    while (Value >= (int64_t)Tokens) {
+        const int64_t Prev =
+            InterlockedCompareExchange64(Cached, Value - Tokens, Value);
+        if (Prev == Value) {
+            return TRUE;
+        }
+        Value = Prev;
+    }
+
+    //
+    // Otherwise refill the cache along the way, falling back to just what's
+    // needed if the bucket can't cover a whole batch.
+    //
+    if (CxPlatRateLimiterAcquireShared(Limiter, (uint64_t)Tokens + Limiter->CacheSize)) {
+        InterlockedExchangeAdd64(Cached, Limiter->CacheSize);
+        return TRUE;
+    }
+
+    return CxPlatRateLimiterAcquireShared(Limiter, Tokens);
+}
+
+uint64_t
+CxPlatRateLimiterTimeUntilUs(
+    _In_ const CXPLAT_RATE_LIMITER* Limiter,
+    _In_ uint32_t Tokens
+    )
+{
+    if (Tokens > Limiter->Burst) {
+        return UINT64_MAX;
+    }
+
+    if (Limiter->Shards != NULL &&
+        *(volatile int64_t*)&Limiter->Shards[CxPlatProcCurrentNumber() % Limiter->ShardCount].Tokens >=
+            (int64_t)Tokens) {
+        return 0;
+    }
+
+    uint64_t NowUs;
+    const int64_t Now = CxPlatRateLimiterNow(Limiter, &NowUs);
+    const int64_t Tat = *(volatile const int64_t*)&Limiter->TheoreticalArrival;
+    const int64_t Ready = (Tat > Now ? Tat : Now) + (int64_t)Tokens - (int64_t)Limiter->Burst;
+    if (Ready <= Now) {
+        return 0;
+    }
+
+    //
+    // The first microsecond at which the time in token intervals reaches
+    // Ready, converted the same way round as CxPlatRateLimiterNow.
+    //
+    const uint64_t Seconds = (uint64_t)Ready / Limiter->TokensPerSecond;
+    const uint64_t Remainder = (uint64_t)Ready - Seconds * Limiter->TokensPerSecond;
+    const uint64_t ReadyUs =
+        S_TO_US(Seconds) +
+        (Remainder * S_TO_US(1) + Limiter->TokensPerSecond - 1) / Limiter->TokensPerSecond;
+
+    return ReadyUs <= NowUs ? 0 : ReadyUs - NowUs;
+}
@@ -0,0 +1,99 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    User mode implementation of cache aware rundown protection. Kernel mode
+    maps directly onto the ExRundown*CacheAware routines.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+CXPLAT_STATUS
+CxPlatRundownCacheAwareInitialize(
+    _Out_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    const uint32_t ShardCount = CxPlatProcCount();
+    const size_t ShardsSize = ShardCount * sizeof(CXPLAT_RUNDOWN_REF_SHARD);
+
+    Rundown->Shards = CXPLAT_ALLOC_NONPAGED(ShardsSize, CXPLAT_POOL_RUNDOWN);
+    if (Rundown->Shards == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_RUNDOWN_REF_SHARD",
+            (unsigned long long)ShardsSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(Rundown->Shards, ShardsSize);
+    Rundown->ShardCount = ShardCount;
+    Rundown->Remaining = 0;
+    CxPlatEventInitialize(&Rundown->RundownComplete, FALSE, FALSE);
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+void
+CxPlatRundownCacheAwareUninitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    CxPlatEventUninitialize(Rundown->RundownComplete);
+    CXPLAT_FREE(Rundown->Shards, CXPLAT_POOL_RUNDOWN);
+    Rundown->Shards = NULL;
+}
+
+void
+CxPlatRundownCacheAwareReinitialize(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    CXPLAT_DBG_ASSERT(Rundown->Remaining == 0);
+    for (uint32_t i = 0; i < Rundown->ShardCount; ++i) {
+        CXPLAT_DBG_ASSERT(Rundown->Shards[i].Count & CXPLAT_RUNDOWN_ACTIVE);
+        Rundown->Shards[i].Count = 0;
+    }
+}
+
+void
+CxPlatRundownCacheAwareWait(
+    _Inout_ CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown
+    )
+{
+    int64_t Outstanding = 0;
+
+    //
+    // Freeze each shard, collecting the references it still holds. Acquires on
+    // shards that haven't been frozen yet can still succeed, but they are then
+    // included in the total when their shard is frozen.
+    //
+    for (uint32_t i = 0; i < Rundown->ShardCount; ++i) {
+        int64_t* Count = &Rundown->Shards[i].Count;
+        int64_t Value = *(volatile int64_t*)Count;
+        for (;;) {
+            CXPLAT_DBG_ASSERT(!(Value & CXPLAT_RUNDOWN_ACTIVE));
+            const int64_t Prev =
+                InterlockedCompareExchange64(Count, Value | CXPLAT_RUNDOWN_ACTIVE, Value);
+            if (Prev == Value) {
+                break;
+            }
+            Value = Prev;
+        }
+        Outstanding += Value / CXPLAT_RUNDOWN_COUNT_INC;
+    }
+
+    //
+    // Releases against frozen shards have been decrementing Remaining from
+    // zero, so it can't have reached zero on its own. Adding the collected
+    // total yields the true number of references still outstanding.
+    //
+    CXPLAT_DBG_ASSERT(Outstanding >= 0);
+    if (InterlockedExchangeAdd64(&Rundown->Remaining, Outstanding) + Outstanding != 0) {
+        CxPlatEventWaitForever(Rundown->RundownComplete);
+    }
+}
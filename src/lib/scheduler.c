@@ -0,0 +1,550 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Earliest deadline first task scheduler.
+
+    Scheduled tasks are kept in a binary min-heap ordered by deadline. Idle
+    threads sleep until the deadline at the top of the heap, and are woken
+    when a task with an earlier deadline is added.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+#define CXPLAT_SCHEDULER_HEAP_INDEX_NONE UINT32_MAX
+
+#define CXPLAT_SCHEDULER_HEAP_MIN_CAPACITY 16
+
+typedef struct CXPLAT_SCHEDULER_WORKER {
+
+    CXPLAT_SCHEDULER* Scheduler;
+
+    //
+    // The task whose callback is currently running, if any. Cleared if the
+    // task deletes itself from the callback.
+    //
+    CXPLAT_SCHEDULER_TASK* Running;
+
+    //
+    // Set when Running's callback returns, for a delete waiting on it.
+    //
+    CXPLAT_EVENT* RunningDone;
+
+    CXPLAT_THREAD_ID ThreadId;
+
+    CXPLAT_THREAD Thread;
+
+} CXPLAT_SCHEDULER_WORKER;
+
+struct CXPLAT_SCHEDULER {
+
+    CXPLAT_LOCK Lock;
+
+    //
+    // Min-heap of scheduled tasks, with room for every task that exists.
+    //
+    CXPLAT_SCHEDULER_TASK** Heap;
+    uint32_t HeapCount;
+    uint32_t HeapCapacity;
+
+    uint32_t TaskCount;
+
+    BOOLEAN Stop;
+
+    CXPLAT_SCHEDULER_STATS Stats;
+
+    //
+    // Wakes one idle thread to look at the heap again.
+    //
+    CXPLAT_EVENT WakeEvent;
+
+    //
+    // Allocated along with the scheduler.
+    //
+    uint32_t WorkerCount;
+    CXPLAT_SCHEDULER_WORKER* Workers;
+
+};
+
+struct CXPLAT_SCHEDULER_TASK {
+
+    CXPLAT_SCHEDULER* Scheduler;
+
+    CXPLAT_SCHEDULER_TASK_CALLBACK* Callback;
+
+    void* Context;
+
+    uint64_t DeadlineUs;
+
+    //
+    // Zero for one-shot tasks.
+    //
+    uint64_t PeriodUs;
+
+    uint32_t HeapIndex;
+
+    //
+    // TRUE while the task should run again at DeadlineUs. A running task is
+    // put back on the heap when its callback returns.
+    //
+    BOOLEAN Armed;
+
+    BOOLEAN Running;
+
+};
+
+static
+BOOLEAN
+CxPlatSchedulerTaskIsQueued(
+    _In_ const CXPLAT_SCHEDULER_TASK* Task
+    )
+{
+    return Task->HeapIndex != CXPLAT_SCHEDULER_HEAP_INDEX_NONE;
+}
+
+static
+void
+CxPlatSchedulerHeapSet(
+    _Inout_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ uint32_t Index,
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    )
+{
+    Scheduler->Heap[Index] = Task;
+    Task->HeapIndex = Index;
+}
+
+//
+// Moves the task at Index up or down until the heap is ordered again.
+//
+static
+void
+CxPlatSchedulerHeapFix(
+    _Inout_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ uint32_t Index
+    )
+{
+    CXPLAT_SCHEDULER_TASK* Task = Scheduler->Heap[Index];
+
+    while (Index > 0) {
+        const uint32_t Parent = (Index - 1) / 2;
+        if (Scheduler->Heap[Parent]->DeadlineUs <= Task->DeadlineUs) {
+            break;
+        }
+        CxPlatSchedulerHeapSet(Scheduler, Index, Scheduler->Heap[Parent]);
+        Index = Parent;
+    }
+
+    for (;;) {
+        uint32_t Child = Index * 2 + 1;
+        if (Child >= Scheduler->HeapCount) {
+            break;
+        }
+        if (Child + 1 < Scheduler->HeapCount &&
+            Scheduler->Heap[Child + 1]->DeadlineUs < Scheduler->Heap[Child]->DeadlineUs) {
+            ++Child;
+        }
+        if (Task->DeadlineUs <= Scheduler->Heap[Child]->DeadlineUs) {
+            break;
+        }
+        CxPlatSchedulerHeapSet(Scheduler, Index, Scheduler->Heap[Child]);
+        Index = Child;
+    }
+
+    CxPlatSchedulerHeapSet(Scheduler, Index, Task);
+}
+
+//
+// Returns TRUE if the task is now the earliest.
+//
+static
+BOOLEAN
+CxPlatSchedulerHeapInsert(
+    _Inout_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    )
+{
+    CXPLAT_DBG_ASSERT(Scheduler->HeapCount < Scheduler->HeapCapacity);
+    CxPlatSchedulerHeapSet(Scheduler, Scheduler->HeapCount++, Task);
+    CxPlatSchedulerHeapFix(Scheduler, Task->HeapIndex);
+    return Task->HeapIndex == 0;
+}
+
+static
+void
+CxPlatSchedulerHeapRemove(
+    _Inout_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    )
+{
+    const uint32_t Index = Task->HeapIndex;
+    CXPLAT_SCHEDULER_TASK* Last = Scheduler->Heap[--Scheduler->HeapCount];
+    Task->HeapIndex = CXPLAT_SCHEDULER_HEAP_INDEX_NONE;
+    if (Last != Task) {
+        CxPlatSchedulerHeapSet(Scheduler, Index, Last);
+        CxPlatSchedulerHeapFix(Scheduler, Index);
+    }
+}
+
+static
+CXPLAT_THREAD_CALLBACK(CxPlatSchedulerThread, Context)
+{
+    CXPLAT_SCHEDULER_WORKER* Worker = (CXPLAT_SCHEDULER_WORKER*)Context;
+    CXPLAT_SCHEDULER* Scheduler = Worker->Scheduler;
+    Worker->ThreadId = CxPlatCurThreadID();
+
+    CxPlatLockAcquire(&Scheduler->Lock);
+
+    while (!Scheduler->Stop) {
+        uint64_t NowUs = CxPlatTimeUs64();
+        CXPLAT_SCHEDULER_TASK* Task =
+            Scheduler->HeapCount != 0 ? Scheduler->Heap[0] : NULL;
+
+        if (Task == NULL || Task->DeadlineUs > NowUs) {
+            CxPlatLockRelease(&Scheduler->Lock);
+            if (Task == NULL) {
+                CxPlatEventWaitForever(Scheduler->WakeEvent);
+            } else {
+                CxPlatEventWaitWithTimeoutUs(Scheduler->WakeEvent, Task->DeadlineUs - NowUs);
+            }
+            CxPlatLockAcquire(&Scheduler->Lock);
+            continue;
+        }
+
+        const uint64_t LatenessUs = NowUs - Task->DeadlineUs;
+        CxPlatSchedulerHeapRemove(Scheduler, Task);
+
+        //
+        // Work out the next deadline now, so Start and Cancel calls from the
+        // callback override it.
+        //
+        if (Task->PeriodUs != 0) {
+            Task->DeadlineUs += Task->PeriodUs;
+            if (Task->DeadlineUs <= NowUs) {
+                const uint64_t Missed = (NowUs - Task->DeadlineUs) / Task->PeriodUs + 1;
+                Task->DeadlineUs += Missed * Task->PeriodUs;
+                Scheduler->Stats.MissedPeriods += Missed;
+            }
+        } else {
+            Task->Armed = FALSE;
+        }
+
+        Scheduler->Stats.Runs++;
+        Scheduler->Stats.TotalLatenessUs += LatenessUs;
+        if (LatenessUs > Scheduler->Stats.MaxLatenessUs) {
+            Scheduler->Stats.MaxLatenessUs = LatenessUs;
+        }
+
+        //
+        // Another task may be due too, and idle threads are asleep until
+        // this one's deadline at best.
+        //
+        if (Scheduler->HeapCount != 0 && Scheduler->Heap[0]->DeadlineUs <= NowUs) {
+            CxPlatEventSet(Scheduler->WakeEvent);
+        }
+
+        Task->Running = TRUE;
+        Worker->Running = Task;
+        CxPlatLockRelease(&Scheduler->Lock);
+
+        Task->Callback(Task, Task->Context, LatenessUs);
+
+        CxPlatLockAcquire(&Scheduler->Lock);
+        if (Worker->Running == Task) {
+            Worker->Running = NULL;
+            Task->Running = FALSE;
+            if (Worker->RunningDone != NULL) {
+                CxPlatEventSet(*Worker->RunningDone);
+                Worker->RunningDone = NULL;
+            } else if (Task->Armed && !CxPlatSchedulerTaskIsQueued(Task)) {
+                (void)CxPlatSchedulerHeapInsert(Scheduler, Task);
+            }
+        }
+    }
+
+    CxPlatLockRelease(&Scheduler->Lock);
+
+    //
+    // Pass the stop on to the next thread.
+    //
+    CxPlatEventSet(Scheduler->WakeEvent);
+
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+CxPlatSchedulerStop(
+    _Inout_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ uint32_t WorkerCount
+    )
+{
+    CxPlatLockAcquire(&Scheduler->Lock);
+    Scheduler->Stop = TRUE;
+    CxPlatLockRelease(&Scheduler->Lock);
+    CxPlatEventSet(Scheduler->WakeEvent);
+
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        CxPlatThreadWaitForever(&Scheduler->Workers[i].Thread);
+        CxPlatThreadDelete(&Scheduler->Workers[i].Thread);
+    }
+}
+
+CXPLAT_STATUS
+CxPlatSchedulerCreate(
+    _In_ uint32_t ThreadCount,
+    _In_ uint16_t ThreadFlags,
+    _Out_ CXPLAT_SCHEDULER** Scheduler
+    )
+{
+    CXPLAT_STATUS Status = CXPLAT_STATUS_SUCCESS;
+    const uint32_t ProcCount = CxPlatProcCount();
+    uint32_t i;
+
+    if (ThreadCount == 0) {
+        ThreadCount = 1;
+    }
+
+    const size_t SchedulerSize =
+        sizeof(CXPLAT_SCHEDULER) + ThreadCount * sizeof(CXPLAT_SCHEDULER_WORKER);
+    CXPLAT_SCHEDULER* NewScheduler =
+        CXPLAT_ALLOC_NONPAGED(SchedulerSize, CXPLAT_POOL_SCHEDULER);
+    if (NewScheduler == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_SCHEDULER",
+            (unsigned long long)SchedulerSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(NewScheduler, SchedulerSize);
+    NewScheduler->Workers = (CXPLAT_SCHEDULER_WORKER*)(NewScheduler + 1);
+    CxPlatLockInitialize(&NewScheduler->Lock);
+    CxPlatEventInitialize(&NewScheduler->WakeEvent, FALSE, FALSE);
+
+    for (i = 0; i < ThreadCount; ++i) {
+        CXPLAT_SCHEDULER_WORKER* Worker = &NewScheduler->Workers[i];
+        CXPLAT_THREAD_CONFIG Config = {
+            ThreadFlags,
+            (uint16_t)(i % ProcCount),
+            "cxplat_scheduler",
+            CxPlatSchedulerThread,
+            Worker
+        };
+
+        Worker->Scheduler = NewScheduler;
+        Status = CxPlatThreadCreate(&Config, &Worker->Thread);
+        if (CXPLAT_FAILED(Status)) {
+            CxPlatSchedulerStop(NewScheduler, i);
+            CxPlatEventUninitialize(NewScheduler->WakeEvent);
+            CxPlatLockUninitialize(&NewScheduler->Lock);
+            CXPLAT_FREE(NewScheduler, CXPLAT_POOL_SCHEDULER);
+            return Status;
+        }
+    }
+
+    NewScheduler->WorkerCount = ThreadCount;
+    *Scheduler = NewScheduler;
+
+    return Status;
+}
+
+void
+CxPlatSchedulerDelete(
+    _In_ CXPLAT_SCHEDULER* Scheduler
+    )
+{
+    CXPLAT_DBG_ASSERT(Scheduler->TaskCount == 0);
+
+    CxPlatSchedulerStop(Scheduler, Scheduler->WorkerCount);
+    CxPlatEventUninitialize(Scheduler->WakeEvent);
+    CxPlatLockUninitialize(&Scheduler->Lock);
+    if (Scheduler->Heap != NULL) {
+        CXPLAT_FREE(Scheduler->Heap, CXPLAT_POOL_SCHEDULER);
+    }
+    CXPLAT_FREE(Scheduler, CXPLAT_POOL_SCHEDULER);
+}
+
+CXPLAT_STATUS
+CxPlatSchedulerTaskCreate(
+    _In_ CXPLAT_SCHEDULER* Scheduler,
+    _In_ CXPLAT_SCHEDULER_TASK_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _Out_ CXPLAT_SCHEDULER_TASK** Task
+    )
+{
+    CXPLAT_SCHEDULER_TASK* NewTask =
+        CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_SCHEDULER_TASK), CXPLAT_POOL_SCHEDULER);
+    if (NewTask == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_SCHEDULER_TASK",
+            (unsigned long long)sizeof(CXPLAT_SCHEDULER_TASK));
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatLockAcquire(&Scheduler->Lock);
+
+    //
+    // Grow the heap up front, so scheduling a task never needs to allocate.
+    //
+    if (Scheduler->TaskCount == Scheduler->HeapCapacity) {
+        const uint32_t NewCapacity =
+            Scheduler->HeapCapacity == 0 ?
+                CXPLAT_SCHEDULER_HEAP_MIN_CAPACITY : Scheduler->HeapCapacity * 2;
+        const size_t HeapSize = NewCapacity * sizeof(CXPLAT_SCHEDULER_TASK*);
+        CXPLAT_SCHEDULER_TASK** NewHeap =
+            CXPLAT_ALLOC_NONPAGED(HeapSize, CXPLAT_POOL_SCHEDULER);
+        if (NewHeap == NULL) {
+            CxPlatLockRelease(&Scheduler->Lock);
+            CxPlatTraceEvent(
+                "Allocation of '%s' failed. (%llu bytes)",
+                "CXPLAT_SCHEDULER heap",
+                (unsigned long long)HeapSize);
+            CXPLAT_FREE(NewTask, CXPLAT_POOL_SCHEDULER);
+            return CXPLAT_STATUS_OUT_OF_MEMORY;
+        }
+        if (Scheduler->Heap != NULL) {
+            CxPlatCopyMemory(
+                NewHeap, Scheduler->Heap, Scheduler->HeapCount * sizeof(CXPLAT_SCHEDULER_TASK*));
+            CXPLAT_FREE(Scheduler->Heap, CXPLAT_POOL_SCHEDULER);
+        }
+        Scheduler->Heap = NewHeap;
+        Scheduler->HeapCapacity = NewCapacity;
+    }
+    Scheduler->TaskCount++;
+
+    CxPlatLockRelease(&Scheduler->Lock);
+
+    NewTask->Scheduler = Scheduler;
+    NewTask->Callback = Callback;
+    NewTask->Context = Context;
+    NewTask->DeadlineUs = 0;
+    NewTask->PeriodUs = 0;
+    NewTask->HeapIndex = CXPLAT_SCHEDULER_HEAP_INDEX_NONE;
+    NewTask->Armed = FALSE;
+    NewTask->Running = FALSE;
+    *Task = NewTask;
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+void
+CxPlatSchedulerTaskDelete(
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    )
+{
+    CXPLAT_SCHEDULER* Scheduler = Task->Scheduler;
+    const CXPLAT_THREAD_ID ThreadId = CxPlatCurThreadID();
+
+    CxPlatLockAcquire(&Scheduler->Lock);
+
+    Task->Armed = FALSE;
+    if (CxPlatSchedulerTaskIsQueued(Task)) {
+        CxPlatSchedulerHeapRemove(Scheduler, Task);
+    }
+
+    //
+    // If this is the task's own callback, tell its thread not to touch the
+    // task again. Otherwise have its thread signal us when a callback that's
+    // already running returns.
+    //
+    if (Task->Running) {
+        CXPLAT_SCHEDULER_WORKER* Worker = NULL;
+        for (uint32_t i = 0; i < Scheduler->WorkerCount; ++i) {
+            if (Scheduler->Workers[i].Running == Task) {
+                Worker = &Scheduler->Workers[i];
+                break;
+            }
+        }
+        CXPLAT_DBG_ASSERT(Worker != NULL);
+        if (Worker->ThreadId == ThreadId) {
+            Worker->Running = NULL;
+            Task->Running = FALSE;
+        } else {
+            CXPLAT_EVENT RunningDone;
+            CXPLAT_DBG_ASSERT(Worker->RunningDone == NULL);
+            CxPlatEventInitialize(&RunningDone, FALSE, FALSE);
+            Worker->RunningDone = &RunningDone;
+            CxPlatLockRelease(&Scheduler->Lock);
+            CxPlatEventWaitForever(RunningDone);
+            CxPlatEventUninitialize(RunningDone);
+            CxPlatLockAcquire(&Scheduler->Lock);
+            CXPLAT_DBG_ASSERT(!Task->Running);
+        }
+    }
+
+    CXPLAT_DBG_ASSERT(Scheduler->TaskCount > 0);
+    Scheduler->TaskCount--;
+
+    CxPlatLockRelease(&Scheduler->Lock);
+
+    CXPLAT_FREE(Task, CXPLAT_POOL_SCHEDULER);
+}
+
+void
+CxPlatSchedulerTaskStart(
+    _In_ CXPLAT_SCHEDULER_TASK* Task,
+    _In_ uint64_t DelayUs,
+    _In_ uint64_t PeriodUs
+    )
+{
+    CXPLAT_SCHEDULER* Scheduler = Task->Scheduler;
+    const uint64_t NowUs = CxPlatTimeUs64();
+    BOOLEAN Wake = FALSE;
+
+    CxPlatLockAcquire(&Scheduler->Lock);
+
+    Task->DeadlineUs = DelayUs > UINT64_MAX - NowUs ? UINT64_MAX : NowUs + DelayUs;
+    Task->PeriodUs = PeriodUs;
+    Task->Armed = TRUE;
+
+    if (CxPlatSchedulerTaskIsQueued(Task)) {
+        CxPlatSchedulerHeapFix(Scheduler, Task->HeapIndex);
+        Wake = Task->HeapIndex == 0;
+    } else if (!Task->Running) {
+        Wake = CxPlatSchedulerHeapInsert(Scheduler, Task);
+    }
+
+    CxPlatLockRelease(&Scheduler->Lock);
+
+    if (Wake) {
+        CxPlatEventSet(Scheduler->WakeEvent);
+    }
+}
+
+BOOLEAN
+CxPlatSchedulerTaskCancel(
+    _In_ CXPLAT_SCHEDULER_TASK* Task
+    )
+{
+    CXPLAT_SCHEDULER* Scheduler = Task->Scheduler;
+
+    CxPlatLockAcquire(&Scheduler->Lock);
+
+    const BOOLEAN Cancelled = Task->Armed;
+    Task->Armed = FALSE;
+    if (CxPlatSchedulerTaskIsQueued(Task)) {
+        CxPlatSchedulerHeapRemove(Scheduler, Task);
+    }
+
+    CxPlatLockRelease(&Scheduler->Lock);
+
+    return Cancelled;
+}
+
+void
+CxPlatSchedulerGetStats(
+    _In_ CXPLAT_SCHEDULER* Scheduler,
+    _Out_ CXPLAT_SCHEDULER_STATS* Stats
+    )
+{
+    CxPlatLockAcquire(&Scheduler->Lock);
+    *Stats = Scheduler->Stats;
+    CxPlatLockRelease(&Scheduler->Lock);
+}
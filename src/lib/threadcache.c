@@ -0,0 +1,217 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Cache of parked threads for running one-off callbacks.
+
+    Each cached thread loops waiting on its own start event, runs the callback
+    it was given and sets its done event. Its owner waits on the done event
+    and then puts the thread back on the idle stack, so a completing thread
+    never touches anything its owner might be freeing.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+//
+// Released threads exit instead of parking once the single, process-wide idle
+// stack holds this many threads per processor (CxPlatProcCount() times this,
+// in total). Parked threads aren't tied to any processor.
+//
+#define CXPLAT_THREAD_CACHE_IDLE_PER_PROC 4
+
+struct CXPLAT_CACHED_THREAD {
+
+    //
+    // Links the thread into the idle stack while parked.
+    //
+    CXPLAT_LIST_ENTRY Link;
+
+    //
+    // Set by the owner to hand over a callback, or with a NULL callback to
+    // make the thread exit. Auto reset.
+    //
+    CXPLAT_EVENT Start;
+
+    //
+    // Set by the thread when the callback returns. Manual reset, so any
+    // number of waits see it.
+    //
+    CXPLAT_EVENT Done;
+
+    CXPLAT_CACHED_THREAD_CALLBACK* Callback;
+    void* Context;
+
+    CXPLAT_THREAD Thread;
+
+};
+
+typedef struct CXPLAT_THREAD_CACHE {
+
+    CXPLAT_LOCK Lock;
+    CXPLAT_LIST_ENTRY Idle;
+    uint32_t IdleCount;
+
+} CXPLAT_THREAD_CACHE;
+
+static CXPLAT_THREAD_CACHE CxPlatThreadCache;
+
+static
+CXPLAT_THREAD_CALLBACK(CxPlatCachedThreadMain, Context)
+{
+    CXPLAT_CACHED_THREAD* Thread = (CXPLAT_CACHED_THREAD*)Context;
+
+    for (;;) {
+        CxPlatEventWaitForever(Thread->Start);
+        if (Thread->Callback == NULL) {
+            break;
+        }
+        Thread->Callback(Thread->Context);
+        CxPlatEventSet(Thread->Done);
+    }
+
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+CxPlatCachedThreadStop(
+    _In_ CXPLAT_CACHED_THREAD* Thread
+    )
+{
+    Thread->Callback = NULL;
+    CxPlatEventSet(Thread->Start);
+    CxPlatThreadWaitForever(&Thread->Thread);
+    CxPlatThreadDelete(&Thread->Thread);
+    CxPlatEventUninitialize(Thread->Start);
+    CxPlatEventUninitialize(Thread->Done);
+    CXPLAT_FREE(Thread, CXPLAT_POOL_THREAD_CACHE);
+}
+
+void
+CxPlatThreadCacheInitialize(
+    void
+    )
+{
+    CxPlatLockInitialize(&CxPlatThreadCache.Lock);
+    CxPlatListInitializeHead(&CxPlatThreadCache.Idle);
+    CxPlatThreadCache.IdleCount = 0;
+}
+
+void
+CxPlatThreadCacheUninitialize(
+    void
+    )
+{
+    while (!CxPlatListIsEmpty(&CxPlatThreadCache.Idle)) {
+        CxPlatCachedThreadStop(
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&CxPlatThreadCache.Idle), CXPLAT_CACHED_THREAD, Link));
+    }
+    CxPlatThreadCache.IdleCount = 0;
+    CxPlatLockUninitialize(&CxPlatThreadCache.Lock);
+}
+
+CXPLAT_STATUS
+CxPlatCachedThreadStart(
+    _In_ CXPLAT_CACHED_THREAD_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _Out_ CXPLAT_CACHED_THREAD** Thread
+    )
+{
+    CXPLAT_CACHED_THREAD* CachedThread = NULL;
+
+    CxPlatLockAcquire(&CxPlatThreadCache.Lock);
+    if (!CxPlatListIsEmpty(&CxPlatThreadCache.Idle)) {
+        CachedThread =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&CxPlatThreadCache.Idle), CXPLAT_CACHED_THREAD, Link);
+        --CxPlatThreadCache.IdleCount;
+    }
+    CxPlatLockRelease(&CxPlatThreadCache.Lock);
+
+    if (CachedThread == NULL) {
+        CachedThread =
+            CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_CACHED_THREAD), CXPLAT_POOL_THREAD_CACHE);
+        if (CachedThread == NULL) {
+            CxPlatTraceEvent(
+                "Allocation of '%s' failed. (%llu bytes)",
+                "CXPLAT_CACHED_THREAD",
+                (unsigned long long)sizeof(CXPLAT_CACHED_THREAD));
+            return CXPLAT_STATUS_OUT_OF_MEMORY;
+        }
+
+        CxPlatZeroMemory(CachedThread, sizeof(*CachedThread));
+        CxPlatEventInitialize(&CachedThread->Start, FALSE, FALSE);
+        CxPlatEventInitialize(&CachedThread->Done, TRUE, FALSE);
+
+        CXPLAT_THREAD_CONFIG Config = {
+            0,
+            0,
+            "cxplat_cached",
+            CxPlatCachedThreadMain,
+            CachedThread
+        };
+
+        CXPLAT_STATUS Status = CxPlatThreadCreate(&Config, &CachedThread->Thread);
+        if (CXPLAT_FAILED(Status)) {
+            CxPlatEventUninitialize(CachedThread->Start);
+            CxPlatEventUninitialize(CachedThread->Done);
+            CXPLAT_FREE(CachedThread, CXPLAT_POOL_THREAD_CACHE);
+            return Status;
+        }
+    } else {
+        CxPlatEventReset(CachedThread->Done);
+    }
+
+    CachedThread->Callback = Callback;
+    CachedThread->Context = Context;
+    CxPlatEventSet(CachedThread->Start);
+
+    *Thread = CachedThread;
+
+    return CXPLAT_STATUS_SUCCESS;
+}
+
+void
+CxPlatCachedThreadWait(
+    _In_ CXPLAT_CACHED_THREAD* Thread
+    )
+{
+    CxPlatEventWaitForever(Thread->Done);
+}
+
+BOOLEAN
+CxPlatCachedThreadWaitWithTimeout(
+    _In_ CXPLAT_CACHED_THREAD* Thread,
+    _In_ uint32_t TimeoutMs
+    )
+{
+    return (BOOLEAN)CxPlatEventWaitWithTimeout(Thread->Done, TimeoutMs);
+}
+
+void
+CxPlatCachedThreadRelease(
+    _In_ CXPLAT_CACHED_THREAD* Thread
+    )
+{
+    BOOLEAN Parked = FALSE;
+
+    CxPlatEventWaitForever(Thread->Done);
+
+    CxPlatLockAcquire(&CxPlatThreadCache.Lock);
+    if (CxPlatThreadCache.IdleCount < CxPlatProcCount() * CXPLAT_THREAD_CACHE_IDLE_PER_PROC) {
+        CxPlatListInsertHead(&CxPlatThreadCache.Idle, &Thread->Link);
+        ++CxPlatThreadCache.IdleCount;
+        Parked = TRUE;
+    }
+    CxPlatLockRelease(&CxPlatThreadCache.Lock);
+
+    if (!Parked) {
+        CxPlatCachedThreadStop(Thread);
+    }
+}
@@ -0,0 +1,598 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Work-stealing thread pool.
+
+    Each worker owns a fixed size Chase-Lev deque. The owner pushes and pops
+    at the bottom without locking; other workers steal from the top with a
+    compare-exchange. Work that doesn't fit, or comes from outside the pool,
+    goes on a shared locked queue.
+
+    Idle workers park on their doorbell after putting themselves on the idle
+    stack. Submitters only take the idle lock if some worker is parked. A
+    worker waiting on a group parks the same way, and is also rung when the
+    group completes.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+#define CXPLAT_THREAD_POOL_DEQUE_SIZE 1024 // Must be a power of 2
+
+#ifdef _WIN32
+#define CxPlatThreadPoolLoadAcquire(Value) ReadAcquire64(Value)
+#define CxPlatThreadPoolStoreRelease(Value, NewValue) WriteRelease64(Value, NewValue)
+#define CxPlatThreadPoolFence() MemoryBarrier()
+#else
+#define CxPlatThreadPoolLoadAcquire(Value) __atomic_load_n(Value, __ATOMIC_ACQUIRE)
+#define CxPlatThreadPoolStoreRelease(Value, NewValue) __atomic_store_n(Value, NewValue, __ATOMIC_RELEASE)
+#define CxPlatThreadPoolFence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+typedef struct CXPLAT_THREAD_POOL_DEQUE {
+
+    //
+    // Next index to steal from. Only ever incremented, by compare-exchange.
+    //
+    int64_t Top;
+    uint8_t Reserved1[CXPLAT_CACHE_LINE_SIZE - sizeof(int64_t)];
+
+    //
+    // Next index to push to. Only written by the owner.
+    //
+    int64_t Bottom;
+    uint8_t Reserved2[CXPLAT_CACHE_LINE_SIZE - sizeof(int64_t)];
+
+    CXPLAT_THREAD_POOL_WORK* Items[CXPLAT_THREAD_POOL_DEQUE_SIZE];
+
+} CXPLAT_THREAD_POOL_DEQUE;
+
+typedef struct CXPLAT_THREAD_POOL_WORKER {
+
+    CXPLAT_THREAD_POOL_DEQUE Deque;
+
+    CXPLAT_THREAD_POOL* Pool;
+
+    uint32_t Index;
+
+    //
+    // Where the next steal attempt starts, so steals spread across workers.
+    //
+    uint32_t NextVictim;
+
+    CXPLAT_THREAD_ID ThreadId;
+
+    CXPLAT_DOORBELL Doorbell;
+
+    CXPLAT_THREAD Thread;
+
+} CXPLAT_THREAD_POOL_WORKER;
+
+struct CXPLAT_THREAD_POOL {
+
+    CXPLAT_DISPATCH_LOCK Lock;
+
+    //
+    // Work submitted from outside the pool or that overflowed a deque.
+    //
+    CXPLAT_LIST_ENTRY Queue;
+    long QueueDepth;
+
+    //
+    // Stack of parked workers' indexes.
+    //
+    uint32_t* Idle;
+    long IdleCount;
+
+    BOOLEAN Stop;
+
+    uint32_t WorkerCount;
+    CXPLAT_THREAD_POOL_WORKER* Workers;
+
+};
+
+static
+BOOLEAN
+CxPlatThreadPoolDequePush(
+    _Inout_ CXPLAT_THREAD_POOL_DEQUE* Deque,
+    _In_ CXPLAT_THREAD_POOL_WORK* Work
+    )
+{
+    const int64_t Bottom = Deque->Bottom;
+    const int64_t Top = CxPlatThreadPoolLoadAcquire(&Deque->Top);
+    if (Bottom - Top >= CXPLAT_THREAD_POOL_DEQUE_SIZE) {
+        return FALSE;
+    }
+    *(CXPLAT_THREAD_POOL_WORK* volatile*)
+        &Deque->Items[Bottom & (CXPLAT_THREAD_POOL_DEQUE_SIZE - 1)] = Work;
+    CxPlatThreadPoolStoreRelease(&Deque->Bottom, Bottom + 1);
+    return TRUE;
+}
+
+static
+CXPLAT_THREAD_POOL_WORK*
+CxPlatThreadPoolDequePop(
+    _Inout_ CXPLAT_THREAD_POOL_DEQUE* Deque
+    )
+{
+    const int64_t Bottom = Deque->Bottom - 1;
+    *(volatile int64_t*)&Deque->Bottom = Bottom;
+    CxPlatThreadPoolFence();
+    const int64_t Top = *(volatile int64_t*)&Deque->Top;
+
+    if (Top > Bottom) {
+        *(volatile int64_t*)&Deque->Bottom = Bottom + 1;
+        return NULL;
+    }
+
+    CXPLAT_THREAD_POOL_WORK* Work =
+        *(CXPLAT_THREAD_POOL_WORK* volatile*)
+            &Deque->Items[Bottom & (CXPLAT_THREAD_POOL_DEQUE_SIZE - 1)];
+    if (Top == Bottom) {
+        //
+        // Last item, so race any thieves for it.
+        //
+        if (InterlockedCompareExchange64(&Deque->Top, Top + 1, Top) != Top) {
+            Work = NULL;
+        }
+        *(volatile int64_t*)&Deque->Bottom = Bottom + 1;
+    }
+    return Work;
+}
+
+static
+CXPLAT_THREAD_POOL_WORK*
+CxPlatThreadPoolDequeSteal(
+    _Inout_ CXPLAT_THREAD_POOL_DEQUE* Deque
+    )
+{
+    const int64_t Top = CxPlatThreadPoolLoadAcquire(&Deque->Top);
+    CxPlatThreadPoolFence();
+    const int64_t Bottom = CxPlatThreadPoolLoadAcquire(&Deque->Bottom);
+
+    if (Top >= Bottom) {
+        return NULL;
+    }
+
+    CXPLAT_THREAD_POOL_WORK* Work =
+        *(CXPLAT_THREAD_POOL_WORK* volatile*)
+            &Deque->Items[Top & (CXPLAT_THREAD_POOL_DEQUE_SIZE - 1)];
+    if (InterlockedCompareExchange64(&Deque->Top, Top + 1, Top) != Top) {
+        return NULL; // Lost to the owner or another thief.
+    }
+    return Work;
+}
+
+static
+BOOLEAN
+CxPlatThreadPoolDequeIsEmpty(
+    _In_ CXPLAT_THREAD_POOL_DEQUE* Deque
+    )
+{
+    return
+        *(volatile int64_t*)&Deque->Top >= *(volatile int64_t*)&Deque->Bottom;
+}
+
+#ifndef _KERNEL_MODE
+#ifdef _WIN32
+#define CXPLAT_THREAD_POOL_THREAD_LOCAL __declspec(thread)
+#else
+#define CXPLAT_THREAD_POOL_THREAD_LOCAL __thread
+#endif
+
+//
+// The worker the calling thread runs, if it's a pool worker. Workers can't
+// be found by processor, since they run unaffinitized if affinitizing them
+// failed.
+//
+static CXPLAT_THREAD_POOL_THREAD_LOCAL CXPLAT_THREAD_POOL_WORKER* CxPlatThreadPoolSelf;
+#endif
+
+//
+// Returns the worker for the calling thread, or NULL if it isn't one.
+//
+static
+CXPLAT_THREAD_POOL_WORKER*
+CxPlatThreadPoolCurrentWorker(
+    _In_ CXPLAT_THREAD_POOL* Pool
+    )
+{
+#ifdef _KERNEL_MODE
+    //
+    // Kernel threads have no thread local storage. Workers are affinitized,
+    // since thread creation fails otherwise, so only the current processor's
+    // worker can be the caller.
+    //
+    CXPLAT_THREAD_POOL_WORKER* Worker =
+        &Pool->Workers[CxPlatProcCurrentNumber() % Pool->WorkerCount];
+    return Worker->ThreadId == CxPlatCurThreadID() ? Worker : NULL;
+#else
+    CXPLAT_THREAD_POOL_WORKER* Worker = CxPlatThreadPoolSelf;
+    return Worker != NULL && Worker->Pool == Pool ? Worker : NULL;
+#endif
+}
+
+static
+CXPLAT_THREAD_POOL_WORK*
+CxPlatThreadPoolFindWork(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Inout_ CXPLAT_THREAD_POOL_WORKER* Worker
+    )
+{
+    CXPLAT_THREAD_POOL_WORK* Work = CxPlatThreadPoolDequePop(&Worker->Deque);
+    if (Work != NULL) {
+        return Work;
+    }
+
+    if (*(volatile long*)&Pool->QueueDepth != 0) {
+        CxPlatDispatchLockAcquire(&Pool->Lock);
+        if (!CxPlatListIsEmpty(&Pool->Queue)) {
+            Work =
+                CXPLAT_CONTAINING_RECORD(
+                    CxPlatListRemoveHead(&Pool->Queue), CXPLAT_THREAD_POOL_WORK, Link);
+            InterlockedDecrement(&Pool->QueueDepth);
+        }
+        CxPlatDispatchLockRelease(&Pool->Lock);
+        if (Work != NULL) {
+            return Work;
+        }
+    }
+
+    for (uint32_t i = 0; i < Pool->WorkerCount; ++i) {
+        const uint32_t Victim = (Worker->NextVictim + i) % Pool->WorkerCount;
+        if (Victim == Worker->Index) {
+            continue;
+        }
+        if ((Work = CxPlatThreadPoolDequeSteal(&Pool->Workers[Victim].Deque)) != NULL) {
+            Worker->NextVictim = Victim + 1;
+            return Work;
+        }
+    }
+
+    return NULL;
+}
+
+static
+BOOLEAN
+CxPlatThreadPoolHasWork(
+    _In_ CXPLAT_THREAD_POOL* Pool
+    )
+{
+    if (*(volatile long*)&Pool->QueueDepth != 0) {
+        return TRUE;
+    }
+    for (uint32_t i = 0; i < Pool->WorkerCount; ++i) {
+        if (!CxPlatThreadPoolDequeIsEmpty(&Pool->Workers[i].Deque)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+void
+CxPlatThreadPoolGroupComplete(
+    _Inout_ CXPLAT_THREAD_POOL_GROUP* Group
+    )
+{
+    //
+    // A waiting worker may tear the group down as soon as it sees Completed,
+    // so read the doorbell first; it belongs to the pool and outlives the
+    // group.
+    //
+    CXPLAT_DOORBELL* Waiter = Group->Waiter;
+    if (Waiter == NULL) {
+        CxPlatEventSet(Group->Done);
+    } else {
+        InterlockedExchange(&Group->Completed, TRUE);
+        CxPlatDoorbellRing(Waiter);
+    }
+}
+
+static
+void
+CxPlatThreadPoolRun(
+    _In_ CXPLAT_THREAD_POOL_WORK* Work
+    )
+{
+    //
+    // The callback may free the work item, so don't touch it afterwards.
+    //
+    CXPLAT_THREAD_POOL_GROUP* Group = Work->Group;
+    Work->Callback(Work->Context);
+    if (Group != NULL && InterlockedDecrement(&Group->Outstanding) == 0) {
+        CxPlatThreadPoolGroupComplete(Group);
+    }
+}
+
+static
+void
+CxPlatThreadPoolWakeOne(
+    _In_ CXPLAT_THREAD_POOL* Pool
+    )
+{
+    CXPLAT_THREAD_POOL_WORKER* Worker = NULL;
+
+    CxPlatDispatchLockAcquire(&Pool->Lock);
+    if (Pool->IdleCount != 0) {
+        Worker = &Pool->Workers[Pool->Idle[--Pool->IdleCount]];
+    }
+    CxPlatDispatchLockRelease(&Pool->Lock);
+
+    if (Worker != NULL) {
+        CxPlatDoorbellRing(&Worker->Doorbell);
+    }
+}
+
+//
+// Takes the worker back off the idle stack. Returns FALSE if it had already
+// been picked to be woken.
+//
+static
+BOOLEAN
+CxPlatThreadPoolUnpark(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Inout_ CXPLAT_THREAD_POOL_WORKER* Worker
+    )
+{
+    BOOLEAN Removed = FALSE;
+    CxPlatDispatchLockAcquire(&Pool->Lock);
+    for (long i = 0; i < Pool->IdleCount; ++i) {
+        if (Pool->Idle[i] == Worker->Index) {
+            Pool->Idle[i] = Pool->Idle[--Pool->IdleCount];
+            Removed = TRUE;
+            break;
+        }
+    }
+    CxPlatDispatchLockRelease(&Pool->Lock);
+    return Removed;
+}
+
+//
+// Parks the worker until new work is submitted or, if Group is given, until
+// the group completes.
+//
+static
+void
+CxPlatThreadPoolPark(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Inout_ CXPLAT_THREAD_POOL_WORKER* Worker,
+    _In_opt_ CXPLAT_THREAD_POOL_GROUP* Group
+    )
+{
+    CxPlatDispatchLockAcquire(&Pool->Lock);
+    Pool->Idle[Pool->IdleCount++] = Worker->Index;
+    CxPlatDispatchLockRelease(&Pool->Lock);
+
+    //
+    // Check again now that submitters can see this worker is idle, in case
+    // work arrived in between.
+    //
+    CxPlatThreadPoolFence();
+    if (CxPlatThreadPoolHasWork(Pool) || *(volatile BOOLEAN*)&Pool->Stop ||
+        (Group != NULL && *(volatile long*)&Group->Completed)) {
+        if (CxPlatThreadPoolUnpark(Pool, Worker)) {
+            return;
+        }
+
+        //
+        // Already picked to be woken. Take the ring now rather than leave it
+        // to cut short the next park.
+        //
+    }
+
+    (void)CxPlatDoorbellWait(&Worker->Doorbell);
+
+    //
+    // Group completion rings the worker without taking it off the idle
+    // stack, and that ring can arrive late, during a park for something else
+    // entirely. Either way the worker can't be left on the stack. If it was
+    // instead picked to be woken for new work, but is only going back to a
+    // group that has completed, pass the wake on.
+    //
+    if (!CxPlatThreadPoolUnpark(Pool, Worker) &&
+        Group != NULL && *(volatile long*)&Group->Completed) {
+        CxPlatThreadPoolWakeOne(Pool);
+    }
+}
+
+static
+CXPLAT_THREAD_CALLBACK(CxPlatThreadPoolWorkerThread, Context)
+{
+    CXPLAT_THREAD_POOL_WORKER* Worker = (CXPLAT_THREAD_POOL_WORKER*)Context;
+    CXPLAT_THREAD_POOL* Pool = Worker->Pool;
+    Worker->ThreadId = CxPlatCurThreadID();
+#ifndef _KERNEL_MODE
+    CxPlatThreadPoolSelf = Worker;
+#endif
+
+    for (;;) {
+        CXPLAT_THREAD_POOL_WORK* Work = CxPlatThreadPoolFindWork(Pool, Worker);
+        if (Work != NULL) {
+            CxPlatThreadPoolRun(Work);
+            continue;
+        }
+        if (*(volatile BOOLEAN*)&Pool->Stop) {
+            break;
+        }
+        CxPlatThreadPoolPark(Pool, Worker, NULL);
+    }
+
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+CxPlatThreadPoolStop(
+    _Inout_ CXPLAT_THREAD_POOL* Pool,
+    _In_ uint32_t WorkerCount
+    )
+{
+    *(volatile BOOLEAN*)&Pool->Stop = TRUE;
+    CxPlatThreadPoolFence();
+
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        CxPlatDoorbellRing(&Pool->Workers[i].Doorbell);
+    }
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        CxPlatThreadWaitForever(&Pool->Workers[i].Thread);
+        CxPlatThreadDelete(&Pool->Workers[i].Thread);
+        CxPlatDoorbellUninitialize(&Pool->Workers[i].Doorbell);
+    }
+}
+
+CXPLAT_STATUS
+CxPlatThreadPoolCreate(
+    _Out_ CXPLAT_THREAD_POOL** Pool
+    )
+{
+    CXPLAT_STATUS Status = CXPLAT_STATUS_SUCCESS;
+    const uint32_t WorkerCount = CxPlatProcCount();
+    const size_t PoolSize =
+        sizeof(CXPLAT_THREAD_POOL) +
+        WorkerCount * (sizeof(CXPLAT_THREAD_POOL_WORKER) + sizeof(uint32_t));
+    uint32_t i;
+
+    CXPLAT_THREAD_POOL* NewPool = CXPLAT_ALLOC_NONPAGED(PoolSize, CXPLAT_POOL_THREAD_POOL);
+    if (NewPool == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_THREAD_POOL",
+            (unsigned long long)PoolSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(NewPool, PoolSize);
+    CxPlatDispatchLockInitialize(&NewPool->Lock);
+    CxPlatListInitializeHead(&NewPool->Queue);
+    NewPool->Workers = (CXPLAT_THREAD_POOL_WORKER*)(NewPool + 1);
+    NewPool->Idle = (uint32_t*)(NewPool->Workers + WorkerCount);
+    NewPool->WorkerCount = WorkerCount;
+
+    for (i = 0; i < WorkerCount; ++i) {
+        CXPLAT_THREAD_POOL_WORKER* Worker = &NewPool->Workers[i];
+        Worker->Pool = NewPool;
+        Worker->Index = i;
+        Worker->NextVictim = i + 1;
+        CxPlatDoorbellInitialize(&Worker->Doorbell);
+    }
+
+    for (i = 0; i < WorkerCount; ++i) {
+        CXPLAT_THREAD_POOL_WORKER* Worker = &NewPool->Workers[i];
+        CXPLAT_THREAD_CONFIG Config = {
+            CXPLAT_THREAD_FLAG_SET_AFFINITIZE,
+            (uint16_t)i,
+            "cxplat_pool",
+            CxPlatThreadPoolWorkerThread,
+            Worker
+        };
+
+        Status = CxPlatThreadCreate(&Config, &Worker->Thread);
+        if (CXPLAT_FAILED(Status)) {
+            CxPlatThreadPoolStop(NewPool, i);
+            for (; i < WorkerCount; ++i) {
+                CxPlatDoorbellUninitialize(&NewPool->Workers[i].Doorbell);
+            }
+            CxPlatDispatchLockUninitialize(&NewPool->Lock);
+            CXPLAT_FREE(NewPool, CXPLAT_POOL_THREAD_POOL);
+            return Status;
+        }
+    }
+
+    *Pool = NewPool;
+
+    return Status;
+}
+
+void
+CxPlatThreadPoolDelete(
+    _In_ CXPLAT_THREAD_POOL* Pool
+    )
+{
+    CxPlatThreadPoolStop(Pool, Pool->WorkerCount);
+    CXPLAT_DBG_ASSERT(CxPlatListIsEmpty(&Pool->Queue));
+    CxPlatDispatchLockUninitialize(&Pool->Lock);
+    CXPLAT_FREE(Pool, CXPLAT_POOL_THREAD_POOL);
+}
+
+void
+CxPlatThreadPoolSubmit(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _In_ CXPLAT_THREAD_POOL_WORK* Work
+    )
+{
+    CXPLAT_THREAD_POOL_WORKER* Worker = CxPlatThreadPoolCurrentWorker(Pool);
+
+    if (Work->Group != NULL) {
+        InterlockedIncrement(&Work->Group->Outstanding);
+    }
+
+    if (Worker == NULL || !CxPlatThreadPoolDequePush(&Worker->Deque, Work)) {
+        CxPlatDispatchLockAcquire(&Pool->Lock);
+        CxPlatListInsertTail(&Pool->Queue, &Work->Link);
+        InterlockedIncrement(&Pool->QueueDepth);
+        CxPlatDispatchLockRelease(&Pool->Lock);
+    }
+
+    //
+    // Pairs with the fence in CxPlatThreadPoolPark: either the worker sees
+    // the new work, or this sees the worker parked.
+    //
+    CxPlatThreadPoolFence();
+    if (*(volatile long*)&Pool->IdleCount != 0) {
+        CxPlatThreadPoolWakeOne(Pool);
+    }
+}
+
+void
+CxPlatThreadPoolGroupWait(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Inout_ CXPLAT_THREAD_POOL_GROUP* Group
+    )
+{
+    CXPLAT_THREAD_POOL_WORKER* Worker = CxPlatThreadPoolCurrentWorker(Pool);
+
+    //
+    // Drop the wait bias. If work is still outstanding, whichever item
+    // completes last signals the waiter. Wait for that rather than just
+    // watching the count, so the group isn't torn down while it's being
+    // signaled. A worker waiting has its doorbell rung instead of the event,
+    // so it also wakes to help with any new work submitted in the meantime.
+    //
+    if (Worker != NULL) {
+        Group->Waiter = &Worker->Doorbell;
+        if (InterlockedDecrement(&Group->Outstanding) != 0) {
+            while (!*(volatile long*)&Group->Completed) {
+                CXPLAT_THREAD_POOL_WORK* Work = CxPlatThreadPoolFindWork(Pool, Worker);
+                if (Work != NULL) {
+                    CxPlatThreadPoolRun(Work);
+                } else {
+                    CxPlatThreadPoolPark(Pool, Worker, Group);
+                }
+            }
+        }
+        Group->Waiter = NULL;
+        Group->Completed = FALSE;
+    } else if (InterlockedDecrement(&Group->Outstanding) != 0) {
+        CxPlatEventWaitForever(Group->Done);
+    }
+
+    InterlockedIncrement(&Group->Outstanding);
+}
+
+void
+CxPlatThreadPoolGetStats(
+    _In_ CXPLAT_THREAD_POOL* Pool,
+    _Out_ CXPLAT_THREAD_POOL_STATS* Stats
+    )
+{
+    Stats->WorkerCount = Pool->WorkerCount;
+    CxPlatDispatchLockAcquire(&Pool->Lock);
+    Stats->IdleCount = (uint32_t)Pool->IdleCount;
+    CxPlatDispatchLockRelease(&Pool->Lock);
+}
@@ -0,0 +1,350 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Platform independent time interfaces.
+
+--*/
+
+#include "cxplat.h"
+
+//
+// Latest timestamp published by the coarse time ticker, or zero if it isn't
+// running.
+//
+uint64_t CxPlatTimeCoarseCurrentUs;
+
+#if defined(_WIN64) || defined(__LP64__)
+
+typedef struct CXPLAT_TIME_COARSE_TICKER {
+
+    //
+    // Serializes start and stop, which create and join the ticker thread.
+    //
+    CXPLAT_LOCK Lock;
+
+    uint32_t RefCount;
+    uint32_t PeriodUs;
+    CXPLAT_EVENT StopEvent;
+    CXPLAT_THREAD Thread;
+
+} CXPLAT_TIME_COARSE_TICKER;
+
+static CXPLAT_TIME_COARSE_TICKER CxPlatTimeCoarseTicker;
+
+void
+CxPlatTimeCoarseInitialize(
+    void
+    )
+{
+    CxPlatLockInitialize(&CxPlatTimeCoarseTicker.Lock);
+    CxPlatTimeCoarseTicker.RefCount = 0;
+}
+
+void
+CxPlatTimeCoarseUninitialize(
+    void
+    )
+{
+    CXPLAT_DBG_ASSERT(CxPlatTimeCoarseTicker.RefCount == 0);
+    CxPlatLockUninitialize(&CxPlatTimeCoarseTicker.Lock);
+}
+
+static
+CXPLAT_THREAD_CALLBACK(CxPlatTimeCoarseTickerThread, Context)
+{
+    UNREFERENCED_PARAMETER(Context);
+    do {
+        *(volatile uint64_t*)&CxPlatTimeCoarseCurrentUs = CxPlatTimeUs64();
+    } while (!CxPlatEventWaitWithTimeoutUs(
+                CxPlatTimeCoarseTicker.StopEvent,
+                *(volatile uint32_t*)&CxPlatTimeCoarseTicker.PeriodUs));
+    CXPLAT_THREAD_RETURN(0);
+}
+
+CXPLAT_STATUS
+CxPlatTimeCoarseStart(
+    _In_ uint32_t PeriodUs
+    )
+{
+    CXPLAT_STATUS Status = CXPLAT_STATUS_SUCCESS;
+
+    if (PeriodUs == 0) {
+        PeriodUs = CXPLAT_TIME_COARSE_DEFAULT_PERIOD_US;
+    }
+
+    CxPlatLockAcquire(&CxPlatTimeCoarseTicker.Lock);
+
+    if (CxPlatTimeCoarseTicker.RefCount == 0) {
+        CXPLAT_THREAD_CONFIG Config = {
+            0, 0, "cxplat_ticker", CxPlatTimeCoarseTickerThread, NULL
+        };
+        CxPlatTimeCoarseTicker.PeriodUs = PeriodUs;
+        CxPlatEventInitialize(&CxPlatTimeCoarseTicker.StopEvent, TRUE, FALSE);
+
+        //
+        // Publish an initial value so readers switch over immediately.
+        //
+        *(volatile uint64_t*)&CxPlatTimeCoarseCurrentUs = CxPlatTimeUs64();
+
+        Status = CxPlatThreadCreate(&Config, &CxPlatTimeCoarseTicker.Thread);
+        if (CXPLAT_FAILED(Status)) {
+            *(volatile uint64_t*)&CxPlatTimeCoarseCurrentUs = 0;
+            CxPlatEventUninitialize(CxPlatTimeCoarseTicker.StopEvent);
+            goto Exit;
+        }
+
+    } else if (PeriodUs < CxPlatTimeCoarseTicker.PeriodUs) {
+        *(volatile uint32_t*)&CxPlatTimeCoarseTicker.PeriodUs = PeriodUs;
+    }
+
+    CxPlatTimeCoarseTicker.RefCount++;
+
+Exit:
+
+    CxPlatLockRelease(&CxPlatTimeCoarseTicker.Lock);
+
+    return Status;
+}
+
+void
+CxPlatTimeCoarseStop(
+    void
+    )
+{
+    CxPlatLockAcquire(&CxPlatTimeCoarseTicker.Lock);
+
+    CXPLAT_DBG_ASSERT(CxPlatTimeCoarseTicker.RefCount > 0);
+    if (--CxPlatTimeCoarseTicker.RefCount == 0) {
+        CxPlatEventSet(CxPlatTimeCoarseTicker.StopEvent);
+        CxPlatThreadWaitForever(&CxPlatTimeCoarseTicker.Thread);
+        CxPlatThreadDelete(&CxPlatTimeCoarseTicker.Thread);
+        CxPlatEventUninitialize(CxPlatTimeCoarseTicker.StopEvent);
+        *(volatile uint64_t*)&CxPlatTimeCoarseCurrentUs = 0;
+    }
+
+    CxPlatLockRelease(&CxPlatTimeCoarseTicker.Lock);
+}
+
+#else
+
+void
+CxPlatTimeCoarseInitialize(
+    void
+    )
+{
+}
+
+void
+CxPlatTimeCoarseUninitialize(
+    void
+    )
+{
+}
+
+CXPLAT_STATUS
+CxPlatTimeCoarseStart(
+    _In_ uint32_t PeriodUs
+    )
+{
+    UNREFERENCED_PARAMETER(PeriodUs);
+    return CXPLAT_STATUS_NOT_SUPPORTED;
+}
+
+void
+CxPlatTimeCoarseStop(
+    void
+    )
+{
+}
+
+#endif
+
+//
+// Orders the snapshot loads in CxPlatTimeEpochNs64 against the sequence
+// loads around them. x86 and x64 don't reorder loads, so only the compiler
+// needs telling there.
+//
+#if defined(_M_ARM64)
+#define CxPlatTimeEpochReadFence() __dmb(_ARM64_BARRIER_ISHLD)
+#elif defined(_WIN32)
+#define CxPlatTimeEpochReadFence() _ReadBarrier()
+#else
+#define CxPlatTimeEpochReadFence() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+//
+// Pairs a platform timestamp with the wall clock time it was taken at. Odd
+// sequence numbers mean an update is in progress.
+//
+typedef struct CXPLAT_TIME_EPOCH_SNAPSHOT {
+
+    long Sequence;
+    uint64_t BasePlat;
+    uint64_t BaseNs;
+    uint64_t ExpirationPlat;
+
+} CXPLAT_TIME_EPOCH_SNAPSHOT;
+
+static CXPLAT_TIME_EPOCH_SNAPSHOT CxPlatTimeEpochSnapshot;
+
+static
+uint64_t
+CxPlatTimeEpochPlatToNs(
+    _In_ uint64_t Delta
+    )
+{
+    //
+    // Deltas are normally within the resync period, small enough to convert
+    // directly at full resolution.
+    //
+    if (Delta < (1ull << 34)) {
+        return Delta * 1000000000ull / CxPlatPerfFreq;
+    }
+    return US_TO_NS(CxPlatTimePlatToUs64(Delta));
+}
+
+//
+// Captures a new snapshot. Called with the sequence number made odd.
+//
+static
+uint64_t
+CxPlatTimeEpochResync(
+    void
+    )
+{
+    //
+    // Bracket the wall clock read with platform time reads and use the
+    // midpoint.
+    //
+    const uint64_t Before = CxPlatTimePlat();
+    const uint64_t WallNs = CxPlatInternalTimeEpochNs64();
+    const uint64_t After = CxPlatTimePlat();
+    const uint64_t BasePlat = Before + (After - Before) / 2;
+
+    *(volatile uint64_t*)&CxPlatTimeEpochSnapshot.BasePlat = BasePlat;
+    *(volatile uint64_t*)&CxPlatTimeEpochSnapshot.BaseNs = WallNs;
+    *(volatile uint64_t*)&CxPlatTimeEpochSnapshot.ExpirationPlat =
+        BasePlat + CxPlatTimeUs64ToPlat(CXPLAT_TIME_EPOCH_RESYNC_US);
+    InterlockedIncrement(&CxPlatTimeEpochSnapshot.Sequence);
+
+    return WallNs;
+}
+
+uint64_t
+CxPlatTimeEpochNs64(
+    void
+    )
+{
+    for (;;) {
+        const long Sequence = *(volatile long*)&CxPlatTimeEpochSnapshot.Sequence;
+        CxPlatTimeEpochReadFence();
+        if (Sequence & 1) {
+            YieldProcessor();
+            continue;
+        }
+
+        const uint64_t BasePlat = *(volatile uint64_t*)&CxPlatTimeEpochSnapshot.BasePlat;
+        const uint64_t BaseNs = *(volatile uint64_t*)&CxPlatTimeEpochSnapshot.BaseNs;
+        const uint64_t ExpirationPlat =
+            *(volatile uint64_t*)&CxPlatTimeEpochSnapshot.ExpirationPlat;
+        CxPlatTimeEpochReadFence();
+        if (*(volatile long*)&CxPlatTimeEpochSnapshot.Sequence != Sequence) {
+            continue;
+        }
+
+        const uint64_t NowPlat = CxPlatTimePlat();
+        if (NowPlat < ExpirationPlat) {
+            return BaseNs + (NowPlat > BasePlat ? CxPlatTimeEpochPlatToNs(NowPlat - BasePlat) : 0);
+        }
+
+        //
+        // The snapshot is stale (or was never taken). One caller refreshes it
+        // while the rest wait for the new one.
+        //
+        if (InterlockedCompareExchange(
+                &CxPlatTimeEpochSnapshot.Sequence, Sequence + 1, Sequence) == Sequence) {
+            return CxPlatTimeEpochResync();
+        }
+    }
+}
+
+uint64_t
+CxPlatTimeEpochUs64(
+    void
+    )
+{
+    return CxPlatTimeEpochNs64() / 1000;
+}
+
+void
+CxPlatSleepUntil(
+    _In_ uint64_t DeadlineUs
+    )
+{
+    const uint64_t NowUs = CxPlatTimeUs64();
+    if (NowUs < DeadlineUs) {
+        CxPlatSleepUs(DeadlineUs - NowUs);
+    }
+}
+
+//
+// Bounds on how long the precise sleep spins before its deadline.
+//
+#define CXPLAT_SLEEP_PRECISE_MIN_SPIN_US    10
+#define CXPLAT_SLEEP_PRECISE_MAX_SPIN_US    2000
+
+//
+// Moving average of how late the OS sleep returns, in 1/8 microsecond units.
+// Updated without synchronization; a lost update only delays adaptation.
+//
+static uint32_t CxPlatSleepOvershootAvg = 50 * 8;
+
+void
+CxPlatSleepUntilPrecise(
+    _In_ uint64_t DeadlineUs
+    )
+{
+    const uint32_t AvgUs = *(volatile uint32_t*)&CxPlatSleepOvershootAvg / 8;
+    uint64_t SpinUs = AvgUs + AvgUs / 2;
+    if (SpinUs < CXPLAT_SLEEP_PRECISE_MIN_SPIN_US) {
+        SpinUs = CXPLAT_SLEEP_PRECISE_MIN_SPIN_US;
+    } else if (SpinUs > CXPLAT_SLEEP_PRECISE_MAX_SPIN_US) {
+        SpinUs = CXPLAT_SLEEP_PRECISE_MAX_SPIN_US;
+    }
+
+    uint64_t NowUs = CxPlatTimeUs64();
+    if (NowUs + SpinUs < DeadlineUs) {
+        const uint64_t WakeUs = DeadlineUs - SpinUs;
+        CxPlatSleepUs(WakeUs - NowUs);
+        NowUs = CxPlatTimeUs64();
+
+        //
+        // Fold this sleep's overshoot into the average, capped so one badly
+        // delayed wakeup doesn't turn every following sleep into a long spin.
+        //
+        uint64_t Overshoot8 = NowUs > WakeUs ? (NowUs - WakeUs) * 8 : 0;
+        if (Overshoot8 > CXPLAT_SLEEP_PRECISE_MAX_SPIN_US * 8) {
+            Overshoot8 = CXPLAT_SLEEP_PRECISE_MAX_SPIN_US * 8;
+        }
+        const uint32_t Avg = *(volatile uint32_t*)&CxPlatSleepOvershootAvg;
+        *(volatile uint32_t*)&CxPlatSleepOvershootAvg =
+            (uint32_t)(Avg - Avg / 8 + Overshoot8 / 8);
+    }
+
+    while (NowUs < DeadlineUs) {
+        YieldProcessor();
+        NowUs = CxPlatTimeUs64();
+    }
+}
+
+void
+CxPlatSleepUsPrecise(
+    _In_ uint64_t DurationUs
+    )
+{
+    CxPlatSleepUntilPrecise(CxPlatTimeUs64() + DurationUs);
+}
@@ -0,0 +1,534 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Per-processor timer threads.
+
+    Each processor gets a timer thread affinitized to it, which tracks the
+    timers set on that processor in a timer wheel and sleeps until the next
+    one is due.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+typedef struct CXPLAT_TIMER_PROC {
+
+    CXPLAT_DISPATCH_LOCK Lock;
+
+    CXPLAT_TIMER_WHEEL Wheel;
+
+    //
+    // Timers that have fired and are waiting for their callbacks to run.
+    //
+    CXPLAT_LIST_ENTRY Expired;
+
+    //
+    // The timer whose callback is currently running, if any. Cleared if the
+    // timer deletes itself from the callback.
+    //
+    CXPLAT_TIMER* Running;
+
+    //
+    // Set by a CxPlatTimerDelete on another thread that is waiting for the
+    // running callback to return. There can only be one, since deletes of a
+    // given timer are serialized.
+    //
+    CXPLAT_EVENT* RunningDone;
+
+    //
+    // When the thread will next wake up on its own. Zero while it's awake,
+    // since it checks the wheel again before it goes back to sleep.
+    //
+    uint64_t WaitDeadlineUs;
+
+    BOOLEAN Stop;
+
+    CXPLAT_THREAD_ID ThreadId;
+
+    uint64_t Wakeups;
+
+    uint64_t Expirations;
+
+    CXPLAT_EVENT WakeEvent;
+
+    CXPLAT_THREAD Thread;
+
+} CXPLAT_TIMER_PROC;
+
+struct CXPLAT_TIMER {
+
+    CXPLAT_TIMER_ENTRY Entry;
+
+    CXPLAT_TIMER_CALLBACK* Callback;
+
+    void* Context;
+
+    //
+    // The processor the timer was last set on.
+    //
+    CXPLAT_TIMER_PROC* Proc;
+
+    //
+    // The processor whose thread is running the timer's callback, if any.
+    // Written under that processor's lock, and can differ from Proc if the
+    // timer was set again from another processor in the meantime.
+    //
+    CXPLAT_TIMER_PROC* RunningProc;
+
+    //
+    // TRUE while the timer is on its processor's expired list.
+    //
+    BOOLEAN Expired;
+
+};
+
+typedef struct CXPLAT_TIMER_SERVICE {
+
+    //
+    // Serializes start and stop, which create and join the timer threads.
+    //
+    CXPLAT_LOCK Lock;
+
+    //
+    // Timers that exist. The threads run while Procs is set, which is usually
+    // only while RefCount is nonzero, but deleting the last timer from a
+    // callback leaves them running, since a thread can't join itself.
+    //
+    uint32_t RefCount;
+    uint32_t ProcCount;
+    CXPLAT_TIMER_PROC* Procs;
+
+} CXPLAT_TIMER_SERVICE;
+
+static CXPLAT_TIMER_SERVICE CxPlatTimerService;
+
+static
+void
+CxPlatTimerServiceStop(
+    _In_ uint32_t ProcCount
+    );
+
+void
+CxPlatTimerServiceInitialize(
+    void
+    )
+{
+    CxPlatLockInitialize(&CxPlatTimerService.Lock);
+    CxPlatTimerService.RefCount = 0;
+    CxPlatTimerService.ProcCount = 0;
+    CxPlatTimerService.Procs = NULL;
+}
+
+void
+CxPlatTimerServiceUninitialize(
+    void
+    )
+{
+    CXPLAT_DBG_ASSERT(CxPlatTimerService.RefCount == 0);
+    if (CxPlatTimerService.Procs != NULL) {
+        CxPlatTimerServiceStop(CxPlatTimerService.ProcCount);
+    }
+    CxPlatLockUninitialize(&CxPlatTimerService.Lock);
+}
+
+static
+CXPLAT_THREAD_CALLBACK(CxPlatTimerThread, Context)
+{
+    CXPLAT_TIMER_PROC* Proc = (CXPLAT_TIMER_PROC*)Context;
+    Proc->ThreadId = CxPlatCurThreadID();
+
+    CxPlatDispatchLockAcquire(&Proc->Lock);
+
+    while (!Proc->Stop) {
+        uint64_t NowUs = CxPlatTimeUs64();
+
+        CxPlatTimerWheelProcessExpired(&Proc->Wheel, NowUs, &Proc->Expired);
+        for (CXPLAT_LIST_ENTRY* Link = Proc->Expired.Flink;
+             Link != &Proc->Expired;
+             Link = Link->Flink) {
+            CXPLAT_CONTAINING_RECORD(Link, CXPLAT_TIMER, Entry.Link)->Expired = TRUE;
+        }
+
+        //
+        // Run the callbacks without the lock held, so they're free to set the
+        // timer again. Each timer is removed from the expired list before its
+        // callback runs, so cancelling the rest still works in the meantime.
+        //
+        while (!CxPlatListIsEmpty(&Proc->Expired)) {
+            CXPLAT_TIMER* Timer =
+                CXPLAT_CONTAINING_RECORD(
+                    CxPlatListRemoveHead(&Proc->Expired), CXPLAT_TIMER, Entry.Link);
+            Timer->Expired = FALSE;
+            Timer->RunningProc = Proc;
+            Proc->Running = Timer;
+            Proc->Expirations++;
+            CxPlatDispatchLockRelease(&Proc->Lock);
+
+            Timer->Callback(Timer, Timer->Context);
+
+            CxPlatDispatchLockAcquire(&Proc->Lock);
+            if (Proc->Running == Timer) {
+                Timer->RunningProc = NULL;
+            }
+            Proc->Running = NULL;
+            if (Proc->RunningDone != NULL) {
+                CxPlatEventSet(*Proc->RunningDone);
+                Proc->RunningDone = NULL;
+            }
+        }
+
+        const uint64_t NextUs = CxPlatTimerWheelNextExpirationUs(&Proc->Wheel);
+        NowUs = CxPlatTimeUs64();
+        if (NextUs <= NowUs) {
+            continue;
+        }
+
+        Proc->WaitDeadlineUs = NextUs;
+        CxPlatDispatchLockRelease(&Proc->Lock);
+
+        if (NextUs == UINT64_MAX) {
+            CxPlatEventWaitForever(Proc->WakeEvent);
+        } else {
+            CxPlatEventWaitWithTimeoutUs(Proc->WakeEvent, NextUs - NowUs);
+        }
+
+        CxPlatDispatchLockAcquire(&Proc->Lock);
+        Proc->WaitDeadlineUs = 0;
+        Proc->Wakeups++;
+    }
+
+    CxPlatDispatchLockRelease(&Proc->Lock);
+
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+CxPlatTimerProcStop(
+    _Inout_ CXPLAT_TIMER_PROC* Proc
+    )
+{
+    CxPlatDispatchLockAcquire(&Proc->Lock);
+    Proc->Stop = TRUE;
+    CxPlatDispatchLockRelease(&Proc->Lock);
+    CxPlatEventSet(Proc->WakeEvent);
+
+    CxPlatThreadWaitForever(&Proc->Thread);
+    CxPlatThreadDelete(&Proc->Thread);
+    CxPlatEventUninitialize(Proc->WakeEvent);
+    CxPlatTimerWheelUninitialize(&Proc->Wheel);
+    CxPlatDispatchLockUninitialize(&Proc->Lock);
+}
+
+static
+void
+CxPlatTimerServiceStop(
+    _In_ uint32_t ProcCount
+    )
+{
+    for (uint32_t i = 0; i < ProcCount; ++i) {
+        CxPlatTimerProcStop(&CxPlatTimerService.Procs[i]);
+    }
+    CXPLAT_FREE(CxPlatTimerService.Procs, CXPLAT_POOL_TIMER);
+    CxPlatTimerService.Procs = NULL;
+    CxPlatTimerService.ProcCount = 0;
+}
+
+//
+// Returns TRUE if called from one of the timer threads, which is to say from
+// a timer callback.
+//
+static
+BOOLEAN
+CxPlatTimerServiceIsTimerThread(
+    void
+    )
+{
+    const CXPLAT_THREAD_ID ThreadId = CxPlatCurThreadID();
+    for (uint32_t i = 0; i < CxPlatTimerService.ProcCount; ++i) {
+        if (CxPlatTimerService.Procs[i].ThreadId == ThreadId) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static
+CXPLAT_STATUS
+CxPlatTimerServiceStart(
+    void
+    )
+{
+    CXPLAT_STATUS Status = CXPLAT_STATUS_SUCCESS;
+    const uint32_t ProcCount = CxPlatProcCount();
+    const size_t ProcsSize = ProcCount * sizeof(CXPLAT_TIMER_PROC);
+    const uint64_t NowUs = CxPlatTimeUs64();
+    uint32_t i;
+
+    CxPlatTimerService.Procs = CXPLAT_ALLOC_NONPAGED(ProcsSize, CXPLAT_POOL_TIMER);
+    if (CxPlatTimerService.Procs == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_TIMER_PROC",
+            (unsigned long long)ProcsSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    for (i = 0; i < ProcCount; ++i) {
+        CXPLAT_TIMER_PROC* Proc = &CxPlatTimerService.Procs[i];
+        CXPLAT_THREAD_CONFIG Config = {
+            CXPLAT_THREAD_FLAG_SET_AFFINITIZE,
+            (uint16_t)i,
+            "cxplat_timer",
+            CxPlatTimerThread,
+            Proc
+        };
+
+        CxPlatDispatchLockInitialize(&Proc->Lock);
+        CxPlatTimerWheelInitialize(&Proc->Wheel, 1, NowUs);
+        CxPlatListInitializeHead(&Proc->Expired);
+        Proc->Running = NULL;
+        Proc->RunningDone = NULL;
+        Proc->WaitDeadlineUs = 0;
+        Proc->Stop = FALSE;
+        Proc->ThreadId = 0;
+        Proc->Wakeups = 0;
+        Proc->Expirations = 0;
+        CxPlatEventInitialize(&Proc->WakeEvent, FALSE, FALSE);
+
+        Status = CxPlatThreadCreate(&Config, &Proc->Thread);
+        if (CXPLAT_FAILED(Status)) {
+            CxPlatEventUninitialize(Proc->WakeEvent);
+            CxPlatTimerWheelUninitialize(&Proc->Wheel);
+            CxPlatDispatchLockUninitialize(&Proc->Lock);
+            CxPlatTimerServiceStop(i);
+            return Status;
+        }
+    }
+
+    CxPlatTimerService.ProcCount = ProcCount;
+
+    return Status;
+}
+
+CXPLAT_STATUS
+CxPlatTimerCreate(
+    _In_ CXPLAT_TIMER_CALLBACK* Callback,
+    _In_opt_ void* Context,
+    _Out_ CXPLAT_TIMER** Timer
+    )
+{
+    CXPLAT_STATUS Status = CXPLAT_STATUS_SUCCESS;
+    CXPLAT_TIMER* NewTimer =
+        CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_TIMER), CXPLAT_POOL_TIMER);
+    if (NewTimer == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_TIMER",
+            (unsigned long long)sizeof(CXPLAT_TIMER));
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatLockAcquire(&CxPlatTimerService.Lock);
+    if (CxPlatTimerService.Procs == NULL) {
+        Status = CxPlatTimerServiceStart();
+    }
+    if (CXPLAT_SUCCEEDED(Status)) {
+        CxPlatTimerService.RefCount++;
+    }
+    CxPlatLockRelease(&CxPlatTimerService.Lock);
+
+    if (CXPLAT_FAILED(Status)) {
+        CXPLAT_FREE(NewTimer, CXPLAT_POOL_TIMER);
+        return Status;
+    }
+
+    CxPlatTimerEntryInitialize(&NewTimer->Entry);
+    NewTimer->Callback = Callback;
+    NewTimer->Context = Context;
+    NewTimer->Proc = NULL;
+    NewTimer->RunningProc = NULL;
+    NewTimer->Expired = FALSE;
+    *Timer = NewTimer;
+
+    return Status;
+}
+
+void
+CxPlatTimerDelete(
+    _In_ CXPLAT_TIMER* Timer
+    )
+{
+    (void)CxPlatTimerCancel(Timer);
+
+    //
+    // Once cancelled, the callback can't start again, but one may still be
+    // running, on whichever processor the timer was set on when it fired. If
+    // this is that callback, tell its thread not to touch the timer again.
+    // Otherwise wait for it to return.
+    //
+    CXPLAT_TIMER_PROC* Proc = *(CXPLAT_TIMER_PROC* volatile*)&Timer->RunningProc;
+    if (Proc != NULL) {
+        CXPLAT_EVENT RunningDone;
+        BOOLEAN Wait = FALSE;
+        CxPlatDispatchLockAcquire(&Proc->Lock);
+        if (Proc->Running == Timer) {
+            if (Proc->ThreadId == CxPlatCurThreadID()) {
+                Proc->Running = NULL;
+            } else {
+                CXPLAT_DBG_ASSERT(Proc->RunningDone == NULL);
+                CxPlatEventInitialize(&RunningDone, FALSE, FALSE);
+                Proc->RunningDone = &RunningDone;
+                Wait = TRUE;
+            }
+        }
+        CxPlatDispatchLockRelease(&Proc->Lock);
+        if (Wait) {
+            CxPlatEventWaitForever(RunningDone);
+            CxPlatEventUninitialize(RunningDone);
+        }
+    }
+
+    CXPLAT_FREE(Timer, CXPLAT_POOL_TIMER);
+
+    CxPlatLockAcquire(&CxPlatTimerService.Lock);
+    CXPLAT_DBG_ASSERT(CxPlatTimerService.RefCount > 0);
+    if (--CxPlatTimerService.RefCount == 0 && !CxPlatTimerServiceIsTimerThread()) {
+        CxPlatTimerServiceStop(CxPlatTimerService.ProcCount);
+    }
+    CxPlatLockRelease(&CxPlatTimerService.Lock);
+}
+
+//
+// Returns the time in [EarliestUs, LatestUs] with the most trailing zero bits.
+//
+static
+uint64_t
+CxPlatTimerAlignExpiration(
+    _In_ uint64_t EarliestUs,
+    _In_ uint64_t LatestUs
+    )
+{
+    if (EarliestUs == 0 || EarliestUs >= LatestUs) {
+        return EarliestUs;
+    }
+
+    //
+    // Above the highest bit where they differ, everything in the window
+    // shares LatestUs's bits. Keeping those, plus that bit (which is set in
+    // LatestUs), gives the coarsest boundary that's still in the window.
+    //
+    uint64_t Diff = (EarliestUs - 1) ^ LatestUs;
+    Diff |= Diff >> 1;
+    Diff |= Diff >> 2;
+    Diff |= Diff >> 4;
+    Diff |= Diff >> 8;
+    Diff |= Diff >> 16;
+    Diff |= Diff >> 32;
+    return LatestUs & ~(Diff >> 1);
+}
+
+void
+CxPlatTimerSet(
+    _In_ CXPLAT_TIMER* Timer,
+    _In_ uint64_t DelayUs
+    )
+{
+    CxPlatTimerSetWithTolerance(Timer, DelayUs, 0);
+}
+
+void
+CxPlatTimerSetWithTolerance(
+    _In_ CXPLAT_TIMER* Timer,
+    _In_ uint64_t DelayUs,
+    _In_ uint64_t ToleranceUs
+    )
+{
+    CXPLAT_TIMER_PROC* Proc =
+        &CxPlatTimerService.Procs[CxPlatProcCurrentNumber() % CxPlatTimerService.ProcCount];
+    const uint64_t NowUs = CxPlatTimeUs64();
+    const uint64_t EarliestUs =
+        DelayUs > UINT64_MAX - NowUs ? UINT64_MAX : NowUs + DelayUs;
+    const uint64_t LatestUs =
+        ToleranceUs > UINT64_MAX - EarliestUs ? UINT64_MAX : EarliestUs + ToleranceUs;
+    uint64_t ExpirationUs;
+    BOOLEAN Wake;
+
+    if (Timer->Proc != Proc) {
+        (void)CxPlatTimerCancel(Timer);
+        Timer->Proc = Proc;
+    }
+
+    CxPlatDispatchLockAcquire(&Proc->Lock);
+    if (Timer->Expired) {
+        (void)CxPlatListEntryRemove(&Timer->Entry.Link);
+        Timer->Expired = FALSE;
+    }
+    if (Proc->WaitDeadlineUs != UINT64_MAX &&
+        Proc->WaitDeadlineUs >= EarliestUs &&
+        Proc->WaitDeadlineUs <= LatestUs) {
+        ExpirationUs = Proc->WaitDeadlineUs;
+    } else {
+        ExpirationUs = CxPlatTimerAlignExpiration(EarliestUs, LatestUs);
+    }
+    CxPlatTimerWheelInsert(&Proc->Wheel, &Timer->Entry, ExpirationUs);
+    Wake = ExpirationUs < Proc->WaitDeadlineUs;
+    if (Wake) {
+        Proc->WaitDeadlineUs = 0;
+    }
+    CxPlatDispatchLockRelease(&Proc->Lock);
+
+    if (Wake) {
+        CxPlatEventSet(Proc->WakeEvent);
+    }
+}
+
+BOOLEAN
+CxPlatTimerCancel(
+    _In_ CXPLAT_TIMER* Timer
+    )
+{
+    CXPLAT_TIMER_PROC* Proc = Timer->Proc;
+    BOOLEAN Cancelled = FALSE;
+
+    if (Proc == NULL) {
+        return FALSE;
+    }
+
+    CxPlatDispatchLockAcquire(&Proc->Lock);
+    if (CxPlatTimerEntryIsQueued(&Timer->Entry)) {
+        CxPlatTimerWheelCancel(&Proc->Wheel, &Timer->Entry);
+        Cancelled = TRUE;
+    } else if (Timer->Expired) {
+        (void)CxPlatListEntryRemove(&Timer->Entry.Link);
+        Timer->Expired = FALSE;
+        Cancelled = TRUE;
+    }
+    CxPlatDispatchLockRelease(&Proc->Lock);
+
+    return Cancelled;
+}
+
+void
+CxPlatTimerGetStats(
+    _Out_ CXPLAT_TIMER_STATS* Stats
+    )
+{
+    Stats->Wakeups = 0;
+    Stats->Expirations = 0;
+
+    CxPlatLockAcquire(&CxPlatTimerService.Lock);
+    for (uint32_t i = 0; i < CxPlatTimerService.ProcCount; ++i) {
+        CXPLAT_TIMER_PROC* Proc = &CxPlatTimerService.Procs[i];
+        CxPlatDispatchLockAcquire(&Proc->Lock);
+        Stats->Wakeups += Proc->Wakeups;
+        Stats->Expirations += Proc->Expirations;
+        CxPlatDispatchLockRelease(&Proc->Lock);
+    }
+    CxPlatLockRelease(&CxPlatTimerService.Lock);
+}
@@ -0,0 +1,339 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Hierarchical timer wheel.
+
+    Time is divided into ticks of ResolutionUs. A timer due at tick T is queued
+    on the level given by the highest 6-bit group in which T differs from the
+    wheel's current tick, in the slot given by T's bits in that group. As the
+    current tick reaches the start of an occupied slot on a higher level, the
+    slot's timers are re-queued, which moves each of them to a lower level, and
+    they eventually expire from level 0.
+
+    Processing jumps directly between ticks that have something to do, found
+    with the per-level occupancy bitmaps, so an idle wheel costs nothing no
+    matter how much time has passed.
+
+--*/
+
+#include "cxplat.h"
+
+#define CXPLAT_TIMER_WHEEL_OVERFLOW_LEVEL CXPLAT_TIMER_WHEEL_LEVELS
+#define CXPLAT_TIMER_WHEEL_SPAN_BITS \
+    (CXPLAT_TIMER_WHEEL_LEVELS * CXPLAT_TIMER_WHEEL_SLOT_BITS)
+
+static
+uint32_t
+CxPlatTimerWheelLowestSetBit(
+    _In_ uint64_t Value
+    )
+{
+    CXPLAT_DBG_ASSERT(Value != 0);
+#ifdef _WIN32
+    unsigned long Index;
+    _BitScanForward64(&Index, Value);
+    return (uint32_t)Index;
+#else
+    return (uint32_t)__builtin_ctzll(Value);
+#endif
+}
+
+static
+uint32_t
+CxPlatTimerWheelHighestSetBit(
+    _In_ uint64_t Value
+    )
+{
+    CXPLAT_DBG_ASSERT(Value != 0);
+#ifdef _WIN32
+    unsigned long Index;
+    _BitScanReverse64(&Index, Value);
+    return (uint32_t)Index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(Value);
+#endif
+}
+
+//
+// Returns the first tick at or after ExpirationUs.
+//
+static
+uint64_t
+CxPlatTimerWheelExpirationTick(
+    _In_ const CXPLAT_TIMER_WHEEL* Wheel,
+    _In_ uint64_t ExpirationUs
+    )
+{
+    return
+        ExpirationUs / Wheel->ResolutionUs +
+        (ExpirationUs % Wheel->ResolutionUs != 0 ? 1 : 0);
+}
+
+//
+// Queues the entry on the level and slot for Tick, relative to the current
+// tick. Doesn't update the timer count.
+//
+static
+void
+CxPlatTimerWheelQueue(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _Inout_ CXPLAT_TIMER_ENTRY* Entry,
+    _In_ uint64_t Tick
+    )
+{
+    uint32_t Level = 0;
+
+    if (Tick < Wheel->CurrentTick) {
+        Tick = Wheel->CurrentTick;
+    }
+
+    const uint64_t Diff = Tick ^ Wheel->CurrentTick;
+    if (Diff != 0) {
+        Level = CxPlatTimerWheelHighestSetBit(Diff) / CXPLAT_TIMER_WHEEL_SLOT_BITS;
+    }
+
+    if (Level >= CXPLAT_TIMER_WHEEL_LEVELS) {
+        Entry->Level = CXPLAT_TIMER_WHEEL_OVERFLOW_LEVEL;
+        Entry->Slot = 0;
+        CxPlatListInsertTail(&Wheel->Overflow, &Entry->Link);
+        return;
+    }
+
+    const uint32_t Slot =
+        (uint32_t)(Tick >> (Level * CXPLAT_TIMER_WHEEL_SLOT_BITS)) &
+        (CXPLAT_TIMER_WHEEL_SLOTS - 1);
+
+    Entry->Level = (uint8_t)Level;
+    Entry->Slot = (uint8_t)Slot;
+    CxPlatListInsertTail(&Wheel->Slots[Level][Slot], &Entry->Link);
+    Wheel->Occupied[Level] |= 1ull << Slot;
+}
+
+//
+// Re-queues every entry in the list relative to the current tick.
+//
+static
+void
+CxPlatTimerWheelRequeue(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _Inout_ CXPLAT_LIST_ENTRY* List
+    )
+{
+    while (!CxPlatListIsEmpty(List)) {
+        CXPLAT_TIMER_ENTRY* Entry =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(List), CXPLAT_TIMER_ENTRY, Link);
+        CxPlatTimerWheelQueue(
+            Wheel, Entry, CxPlatTimerWheelExpirationTick(Wheel, Entry->ExpirationUs));
+    }
+}
+
+//
+// Returns the earliest tick at which a slot needs to be expired or re-queued,
+// or UINT64_MAX if the wheel is empty.
+//
+static
+uint64_t
+CxPlatTimerWheelNextEventTick(
+    _In_ const CXPLAT_TIMER_WHEEL* Wheel
+    )
+{
+    const uint64_t Current = Wheel->CurrentTick;
+    uint64_t NextTick = UINT64_MAX;
+
+    //
+    // Each level's earliest occupied slot is at or after the current slot on
+    // that level. Lower levels are usually due first, but not when the current
+    // tick is the (unprocessed) start of an occupied higher level slot, so all
+    // levels are checked.
+    //
+    for (uint32_t Level = 0; Level < CXPLAT_TIMER_WHEEL_LEVELS; ++Level) {
+        const uint32_t Shift = Level * CXPLAT_TIMER_WHEEL_SLOT_BITS;
+        const uint32_t CurrentSlot =
+            (uint32_t)(Current >> Shift) & (CXPLAT_TIMER_WHEEL_SLOTS - 1);
+        const uint64_t Occupied = Wheel->Occupied[Level] & (~0ull << CurrentSlot);
+        CXPLAT_DBG_ASSERT(Occupied == Wheel->Occupied[Level]);
+        if (Occupied != 0) {
+            const uint64_t Base =
+                (Current >> (Shift + CXPLAT_TIMER_WHEEL_SLOT_BITS)) <<
+                    (Shift + CXPLAT_TIMER_WHEEL_SLOT_BITS);
+            uint64_t Tick =
+                Base | ((uint64_t)CxPlatTimerWheelLowestSetBit(Occupied) << Shift);
+            if (Tick < Current) {
+                Tick = Current;
+            }
+            if (Tick < NextTick) {
+                NextTick = Tick;
+            }
+        }
+    }
+
+    if (!CxPlatListIsEmpty(&Wheel->Overflow)) {
+        const uint64_t Mask = (1ull << CXPLAT_TIMER_WHEEL_SPAN_BITS) - 1;
+        const uint64_t Tick = (Current + Mask) & ~Mask;
+        if (Tick < NextTick) {
+            NextTick = Tick;
+        }
+    }
+
+    return NextTick;
+}
+
+void
+CxPlatTimerWheelInitialize(
+    _Out_ CXPLAT_TIMER_WHEEL* Wheel,
+    _In_ uint32_t ResolutionUs,
+    _In_ uint64_t NowUs
+    )
+{
+    CXPLAT_DBG_ASSERT(ResolutionUs != 0);
+    if (ResolutionUs == 0) {
+        ResolutionUs = 1;
+    }
+
+    Wheel->ResolutionUs = ResolutionUs;
+    Wheel->CurrentTick = NowUs / ResolutionUs;
+    Wheel->TimerCount = 0;
+    for (uint32_t Level = 0; Level < CXPLAT_TIMER_WHEEL_LEVELS; ++Level) {
+        Wheel->Occupied[Level] = 0;
+        for (uint32_t Slot = 0; Slot < CXPLAT_TIMER_WHEEL_SLOTS; ++Slot) {
+            CxPlatListInitializeHead(&Wheel->Slots[Level][Slot]);
+        }
+    }
+    CxPlatListInitializeHead(&Wheel->Overflow);
+}
+
+void
+CxPlatTimerWheelUninitialize(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel
+    )
+{
+    CXPLAT_DBG_ASSERT(Wheel->TimerCount == 0);
+    UNREFERENCED_PARAMETER(Wheel);
+}
+
+void
+CxPlatTimerWheelInsert(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _Inout_ CXPLAT_TIMER_ENTRY* Entry,
+    _In_ uint64_t ExpirationUs
+    )
+{
+    CxPlatTimerWheelCancel(Wheel, Entry);
+
+    Entry->ExpirationUs = ExpirationUs;
+    CxPlatTimerWheelQueue(
+        Wheel, Entry, CxPlatTimerWheelExpirationTick(Wheel, ExpirationUs));
+    Wheel->TimerCount++;
+}
+
+void
+CxPlatTimerWheelCancel(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _Inout_ CXPLAT_TIMER_ENTRY* Entry
+    )
+{
+    if (!CxPlatTimerEntryIsQueued(Entry)) {
+        return;
+    }
+
+    if (CxPlatListEntryRemove(&Entry->Link) &&
+        Entry->Level != CXPLAT_TIMER_WHEEL_OVERFLOW_LEVEL) {
+        Wheel->Occupied[Entry->Level] &= ~(1ull << Entry->Slot);
+    }
+
+    Entry->Level = CXPLAT_TIMER_ENTRY_NOT_QUEUED;
+    CXPLAT_DBG_ASSERT(Wheel->TimerCount != 0);
+    Wheel->TimerCount--;
+}
+
+uint64_t
+CxPlatTimerWheelNextExpirationUs(
+    _In_ const CXPLAT_TIMER_WHEEL* Wheel
+    )
+{
+    const uint64_t Tick = CxPlatTimerWheelNextEventTick(Wheel);
+    if (Tick > UINT64_MAX / Wheel->ResolutionUs) {
+        return UINT64_MAX;
+    }
+    return Tick * Wheel->ResolutionUs;
+}
+
+uint32_t
+CxPlatTimerWheelProcessExpired(
+    _Inout_ CXPLAT_TIMER_WHEEL* Wheel,
+    _In_ uint64_t NowUs,
+    _Inout_ CXPLAT_LIST_ENTRY* ExpiredList
+    )
+{
+    const uint64_t NowTick = NowUs / Wheel->ResolutionUs;
+    uint32_t ExpiredCount = 0;
+    CXPLAT_LIST_ENTRY Pending;
+
+    if (NowTick < Wheel->CurrentTick) {
+        return 0;
+    }
+
+    CxPlatListInitializeHead(&Pending);
+
+    while (Wheel->TimerCount != 0) {
+        const uint64_t Tick = CxPlatTimerWheelNextEventTick(Wheel);
+        if (Tick > NowTick) {
+            break;
+        }
+        Wheel->CurrentTick = Tick;
+
+        //
+        // Re-queue anything whose slot starts at this tick, from the top
+        // down, since re-queuing from a higher level can land timers in a
+        // lower level slot that starts at this tick too.
+        //
+        if ((Tick & ((1ull << CXPLAT_TIMER_WHEEL_SPAN_BITS) - 1)) == 0) {
+            CxPlatListMoveItems(&Wheel->Overflow, &Pending);
+            CxPlatTimerWheelRequeue(Wheel, &Pending);
+        }
+
+        for (uint32_t Level = CXPLAT_TIMER_WHEEL_LEVELS - 1; Level > 0; --Level) {
+            const uint32_t Shift = Level * CXPLAT_TIMER_WHEEL_SLOT_BITS;
+            if ((Tick & ((1ull << Shift) - 1)) != 0) {
+                continue;
+            }
+            const uint32_t Slot =
+                (uint32_t)(Tick >> Shift) & (CXPLAT_TIMER_WHEEL_SLOTS - 1);
+            if (Wheel->Occupied[Level] & (1ull << Slot)) {
+                Wheel->Occupied[Level] &= ~(1ull << Slot);
+                CxPlatListMoveItems(&Wheel->Slots[Level][Slot], &Pending);
+                CxPlatTimerWheelRequeue(Wheel, &Pending);
+            }
+        }
+
+        const uint32_t Slot = (uint32_t)Tick & (CXPLAT_TIMER_WHEEL_SLOTS - 1);
+        if (Wheel->Occupied[0] & (1ull << Slot)) {
+            CXPLAT_LIST_ENTRY* Head = &Wheel->Slots[0][Slot];
+            Wheel->Occupied[0] &= ~(1ull << Slot);
+            while (!CxPlatListIsEmpty(Head)) {
+                CXPLAT_TIMER_ENTRY* Entry =
+                    CXPLAT_CONTAINING_RECORD(
+                        CxPlatListRemoveHead(Head), CXPLAT_TIMER_ENTRY, Link);
+                Entry->Level = CXPLAT_TIMER_ENTRY_NOT_QUEUED;
+                CxPlatListInsertTail(ExpiredList, &Entry->Link);
+                Wheel->TimerCount--;
+                ExpiredCount++;
+            }
+        }
+
+        Wheel->CurrentTick = Tick + 1;
+    }
+
+    //
+    // Nothing is due at or before NowTick, so skipping ahead can't step over
+    // the start of any occupied slot.
+    //
+    Wheel->CurrentTick = NowTick + 1;
+
+    return ExpiredCount;
+}
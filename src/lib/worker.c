@@ -0,0 +1,283 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Per-processor execution context workers.
+
+    Each worker thread owns the list of contexts registered with it and is the
+    only thread that walks it, so running contexts needs no locking. Newly
+    registered contexts go on a small locked pending list that the worker
+    adopts at the start of each pass. Wakes from other threads are a single
+    exchange on the context, plus a doorbell ring if it wasn't already ready.
+
+--*/
+
+#include "cxplat.h"
+#include "cxplat_trace.h"
+
+typedef struct CXPLAT_WORKER {
+
+    CXPLAT_WORKER_POOL* Pool;
+
+    //
+    // Contexts owned by this worker. Only touched by the worker thread.
+    //
+    CXPLAT_LIST_ENTRY Contexts;
+
+    CXPLAT_DISPATCH_LOCK Lock;
+
+    //
+    // Contexts added since the worker last looked.
+    //
+    CXPLAT_LIST_ENTRY Pending;
+    BOOLEAN HasPending;
+
+    uint32_t ProcIndex;
+
+    CXPLAT_DOORBELL Doorbell;
+
+    CXPLAT_THREAD Thread;
+
+} CXPLAT_WORKER;
+
+struct CXPLAT_WORKER_POOL {
+
+    BOOLEAN Stop;
+
+    uint32_t WorkerCount;
+    CXPLAT_WORKER* Workers;
+
+};
+
+static
+void
+CxPlatWorkerAdoptPending(
+    _Inout_ CXPLAT_WORKER* Worker
+    )
+{
+    CxPlatDispatchLockAcquire(&Worker->Lock);
+    CxPlatListMoveItems(&Worker->Pending, &Worker->Contexts);
+    Worker->HasPending = FALSE;
+    CxPlatDispatchLockRelease(&Worker->Lock);
+}
+
+//
+// Runs everything that's due. Returns TRUE if any context ran, and the
+// earliest time any remaining context asked to run at.
+//
+static
+BOOLEAN
+CxPlatWorkerRunContexts(
+    _Inout_ CXPLAT_WORKER* Worker,
+    _In_ const CXPLAT_EXECUTION_STATE* State,
+    _Out_ uint64_t* NextTimeUs
+    )
+{
+    BOOLEAN DidWork = FALSE;
+    CXPLAT_LIST_ENTRY* Entry = Worker->Contexts.Flink;
+    *NextTimeUs = UINT64_MAX;
+
+    while (Entry != &Worker->Contexts) {
+        CXPLAT_EXECUTION_CONTEXT* Context =
+            CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_EXECUTION_CONTEXT, Link);
+        CXPLAT_LIST_ENTRY* Next = Entry->Flink;
+
+        //
+        // Clear Ready before running, so a wake that arrives during Run
+        // makes it run again.
+        //
+        if ((*(volatile long*)&Context->Ready &&
+             InterlockedExchange(&Context->Ready, FALSE)) ||
+            Context->NextTimeUs <= State->TimeNowUs) {
+            DidWork = TRUE;
+
+            //
+            // Unlink while it runs, so a context that unregisters is free to
+            // delete itself from Run.
+            //
+            (void)CxPlatListEntryRemove(Entry);
+            if (!Context->Run(Context, State)) {
+                Entry = Next;
+                continue;
+            }
+            CxPlatListInsertTail(Next, Entry);
+        }
+
+        if (Context->NextTimeUs < *NextTimeUs) {
+            *NextTimeUs = Context->NextTimeUs;
+        }
+        Entry = Next;
+    }
+
+    return DidWork;
+}
+
+static
+CXPLAT_THREAD_CALLBACK(CxPlatWorkerThread, Context)
+{
+    CXPLAT_WORKER* Worker = (CXPLAT_WORKER*)Context;
+    CXPLAT_WORKER_POOL* Pool = Worker->Pool;
+    CXPLAT_EXECUTION_STATE State;
+    State.NoWorkCount = 0;
+    State.ProcIndex = Worker->ProcIndex;
+    State.ThreadId = CxPlatCurThreadID();
+
+    while (!*(volatile BOOLEAN*)&Pool->Stop) {
+        uint64_t NextTimeUs;
+        State.TimeNowUs = CxPlatTimeUs64();
+
+        if (*(volatile BOOLEAN*)&Worker->HasPending) {
+            CxPlatWorkerAdoptPending(Worker);
+        }
+
+        if (CxPlatWorkerRunContexts(Worker, &State, &NextTimeUs)) {
+            State.NoWorkCount = 0;
+            continue;
+        }
+
+        //
+        // Nothing to do. Sleep until the next timer or wake; any rings that
+        // arrived during the pass return right away.
+        //
+        ++State.NoWorkCount;
+        if (NextTimeUs == UINT64_MAX) {
+            (void)CxPlatDoorbellWait(&Worker->Doorbell);
+        } else {
+            const uint64_t Now = CxPlatTimeUs64();
+            if (NextTimeUs > Now) {
+                (void)CxPlatDoorbellWaitWithTimeoutUs(&Worker->Doorbell, NextTimeUs - Now);
+            }
+        }
+    }
+
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+CxPlatWorkerPoolStop(
+    _Inout_ CXPLAT_WORKER_POOL* Pool,
+    _In_ uint32_t WorkerCount
+    )
+{
+    *(volatile BOOLEAN*)&Pool->Stop = TRUE;
+
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        CxPlatDoorbellRing(&Pool->Workers[i].Doorbell);
+    }
+    for (uint32_t i = 0; i < WorkerCount; ++i) {
+        CxPlatThreadWaitForever(&Pool->Workers[i].Thread);
+        CxPlatThreadDelete(&Pool->Workers[i].Thread);
+        CxPlatDoorbellUninitialize(&Pool->Workers[i].Doorbell);
+        CxPlatDispatchLockUninitialize(&Pool->Workers[i].Lock);
+    }
+}
+
+CXPLAT_STATUS
+CxPlatWorkerPoolCreate(
+    _Out_ CXPLAT_WORKER_POOL** Pool
+    )
+{
+    CXPLAT_STATUS Status = CXPLAT_STATUS_SUCCESS;
+    const uint32_t WorkerCount = CxPlatProcCount();
+    const size_t PoolSize =
+        sizeof(CXPLAT_WORKER_POOL) + WorkerCount * sizeof(CXPLAT_WORKER);
+    uint32_t i;
+
+    CXPLAT_WORKER_POOL* NewPool = CXPLAT_ALLOC_NONPAGED(PoolSize, CXPLAT_POOL_WORKER);
+    if (NewPool == NULL) {
+        CxPlatTraceEvent(
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_WORKER_POOL",
+            (unsigned long long)PoolSize);
+        return CXPLAT_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(NewPool, PoolSize);
+    NewPool->Workers = (CXPLAT_WORKER*)(NewPool + 1);
+    NewPool->WorkerCount = WorkerCount;
+
+    for (i = 0; i < WorkerCount; ++i) {
+        CXPLAT_WORKER* Worker = &NewPool->Workers[i];
+        Worker->Pool = NewPool;
+        Worker->ProcIndex = i;
+        CxPlatListInitializeHead(&Worker->Contexts);
+        CxPlatListInitializeHead(&Worker->Pending);
+        CxPlatDispatchLockInitialize(&Worker->Lock);
+        CxPlatDoorbellInitialize(&Worker->Doorbell);
+    }
+
+    for (i = 0; i < WorkerCount; ++i) {
+        CXPLAT_WORKER* Worker = &NewPool->Workers[i];
+        CXPLAT_THREAD_CONFIG Config = {
+            CXPLAT_THREAD_FLAG_SET_AFFINITIZE,
+            (uint16_t)i,
+            "cxplat_worker",
+            CxPlatWorkerThread,
+            Worker
+        };
+
+        Status = CxPlatThreadCreate(&Config, &Worker->Thread);
+        if (CXPLAT_FAILED(Status)) {
+            CxPlatWorkerPoolStop(NewPool, i);
+            for (; i < WorkerCount; ++i) {
+                CxPlatDoorbellUninitialize(&NewPool->Workers[i].Doorbell);
+                CxPlatDispatchLockUninitialize(&NewPool->Workers[i].Lock);
+            }
+            CXPLAT_FREE(NewPool, CXPLAT_POOL_WORKER);
+            return Status;
+        }
+    }
+
+    *Pool = NewPool;
+
+    return Status;
+}
+
+void
+CxPlatWorkerPoolDelete(
+    _In_ CXPLAT_WORKER_POOL* Pool
+    )
+{
+    CxPlatWorkerPoolStop(Pool, Pool->WorkerCount);
+    CXPLAT_FREE(Pool, CXPLAT_POOL_WORKER);
+}
+
+void
+CxPlatWorkerPoolAddExecutionContext(
+    _In_ CXPLAT_WORKER_POOL* Pool,
+    _Inout_ CXPLAT_EXECUTION_CONTEXT* Context,
+    _In_ uint32_t ProcIndex
+    )
+{
+    CXPLAT_WORKER* Worker = &Pool->Workers[ProcIndex % Pool->WorkerCount];
+    CXPLAT_DBG_ASSERT(Context->Worker == NULL);
+
+    Context->Worker = Worker;
+    Context->Ready = TRUE;
+
+    CxPlatDispatchLockAcquire(&Worker->Lock);
+    CxPlatListInsertTail(&Worker->Pending, &Context->Link);
+    Worker->HasPending = TRUE;
+    CxPlatDispatchLockRelease(&Worker->Lock);
+
+    CxPlatDoorbellRing(&Worker->Doorbell);
+}
+
+void
+CxPlatWakeExecutionContext(
+    _In_ CXPLAT_EXECUTION_CONTEXT* Context
+    )
+{
+    CXPLAT_DBG_ASSERT(Context->Worker != NULL);
+
+    //
+    // Only the first wake since the context last ran needs to ring.
+    //
+    if (!InterlockedExchange(&Context->Ready, TRUE)) {
+        CxPlatDoorbellRing(&((CXPLAT_WORKER*)Context->Worker)->Doorbell);
+    }
+}
@@ -36,6 +36,11 @@ void CxPlatTestMemoryFailureInjection();
 //
 
 void CxPlatTestTimeBasic();
+void CxPlatTestTimeWaitUs();
+void CxPlatTestTimePlat();
+void CxPlatTestTimeCoarse();
+void CxPlatTestTimeSleepUntil();
+void CxPlatTestTimeEpoch();
 
 //
 // Event Tests
@@ -49,6 +54,8 @@ void CxPlatTestEventCpp();
 //
 
 void CxPlatTestProcBasic();
+void CxPlatTestProcTopology();
+void CxPlatTestProcCurrentNumber();
 
 //
 // Thread Tests
@@ -56,6 +63,8 @@ void CxPlatTestProcBasic();
 
 void CxPlatTestThreadBasic();
 void CxPlatTestThreadAsync();
+void CxPlatTestThreadPlacement();
+void CxPlatTestThreadCache();
 #if _WIN32
 void CxPlatTestThreadWaitTimeout();
 #endif
@@ -71,6 +80,102 @@ void VectorBasic();
 void CxPlatTestLockBasic();
 void CxPlatTestLockReadWrite();
 
+//
+// Rundown Tests
+//
+
+void CxPlatTestRundownBasic();
+void CxPlatTestRundownCacheAware();
+
+//
+// Wait On Address Tests
+//
+
+void CxPlatTestWaitOnAddressBasic();
+
+//
+// Doorbell Tests
+//
+
+void CxPlatTestDoorbellBasic();
+void CxPlatTestDoorbellStress();
+
+//
+// Timer Wheel Tests
+//
+
+void CxPlatTestTimerWheelBasic();
+void CxPlatTestTimerWheelRandom();
+
+//
+// Timer Tests
+//
+
+void CxPlatTestTimerBasic();
+void CxPlatTestTimerAffinity();
+void CxPlatTestTimerCoalesce();
+void CxPlatTestTimerDelete();
+
+//
+// Rate Limiter Tests
+//
+
+void CxPlatTestRateLimiterBasic();
+void CxPlatTestRateLimiterCached();
+void CxPlatTestRateLimiterHighRate();
+
+//
+// Histogram Tests
+//
+
+void CxPlatTestHistogramBasic();
+void CxPlatTestHistogramConcurrent();
+
+//
+// Scheduler Tests
+//
+
+void CxPlatTestSchedulerBasic();
+void CxPlatTestSchedulerOrder();
+void CxPlatTestSchedulerDelete();
+
+//
+// Thread Pool Tests
+//
+
+void CxPlatTestThreadPoolBasic();
+void CxPlatTestThreadPoolNested();
+
+//
+// Execution Context Tests
+//
+
+void CxPlatTestExecutionContextBasic();
+
+//
+// Per-Processor Storage Tests
+//
+
+void CxPlatTestPerProcBasic();
+void CxPlatTestPerProcAggregate();
+
+//
+// Future Tests
+//
+
+void CxPlatTestFutureBasic();
+void CxPlatTestFuturePipeline();
+
+//
+// Coroutine Tests
+//
+
+void CxPlatTestCoroutineTask();
+void CxPlatTestCoroutineEvent();
+void CxPlatTestCoroutineLock();
+void CxPlatTestCoroutineTimer();
+void CxPlatTestCoroutineResumeOnProc();
+
 //
 // Platform Specific Functions
 //
@@ -161,4 +266,124 @@ static const GUID CXPLAT_TEST_DEVICE_INSTANCE =
 #define IOCTL_CXPLAT_RUN_LOCK_READ_WRITE \
     CXPLAT_CTL_CODE(12, METHOD_BUFFERED, FILE_WRITE_DATA)
 
-#define CXPLAT_MAX_IOCTL_FUNC_CODE 12
+#define IOCTL_CXPLAT_RUN_RUNDOWN_BASIC \
+    CXPLAT_CTL_CODE(13, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_RUNDOWN_CACHE_AWARE \
+    CXPLAT_CTL_CODE(14, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIME_WAIT_US \
+    CXPLAT_CTL_CODE(15, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_WAIT_ON_ADDRESS_BASIC \
+    CXPLAT_CTL_CODE(16, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_DOORBELL_BASIC \
+    CXPLAT_CTL_CODE(17, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_DOORBELL_STRESS \
+    CXPLAT_CTL_CODE(18, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIME_PLAT \
+    CXPLAT_CTL_CODE(19, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIME_COARSE \
+    CXPLAT_CTL_CODE(20, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIMER_WHEEL_BASIC \
+    CXPLAT_CTL_CODE(21, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIMER_WHEEL_RANDOM \
+    CXPLAT_CTL_CODE(22, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIMER_BASIC \
+    CXPLAT_CTL_CODE(23, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIMER_AFFINITY \
+    CXPLAT_CTL_CODE(24, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIMER_DELETE \
+    CXPLAT_CTL_CODE(25, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIMER_COALESCE \
+    CXPLAT_CTL_CODE(26, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIME_SLEEP_UNTIL \
+    CXPLAT_CTL_CODE(27, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_RATE_LIMITER_BASIC \
+    CXPLAT_CTL_CODE(28, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_RATE_LIMITER_CACHED \
+    CXPLAT_CTL_CODE(29, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_HISTOGRAM_BASIC \
+    CXPLAT_CTL_CODE(30, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_HISTOGRAM_CONCURRENT \
+    CXPLAT_CTL_CODE(31, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_TIME_EPOCH \
+    CXPLAT_CTL_CODE(32, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_SCHEDULER_BASIC \
+    CXPLAT_CTL_CODE(33, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_SCHEDULER_ORDER \
+    CXPLAT_CTL_CODE(34, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_SCHEDULER_DELETE \
+    CXPLAT_CTL_CODE(35, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_THREAD_POOL_BASIC \
+    CXPLAT_CTL_CODE(36, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_THREAD_POOL_NESTED \
+    CXPLAT_CTL_CODE(37, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_EXECUTION_CONTEXT_BASIC \
+    CXPLAT_CTL_CODE(38, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_PROC_TOPOLOGY \
+    CXPLAT_CTL_CODE(39, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_PER_PROC_BASIC \
+    CXPLAT_CTL_CODE(40, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_PER_PROC_AGGREGATE \
+    CXPLAT_CTL_CODE(41, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_THREAD_PLACEMENT \
+    CXPLAT_CTL_CODE(42, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_THREAD_CACHE \
+    CXPLAT_CTL_CODE(43, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_FUTURE_BASIC \
+    CXPLAT_CTL_CODE(44, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_FUTURE_PIPELINE \
+    CXPLAT_CTL_CODE(45, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_COROUTINE_TASK \
+    CXPLAT_CTL_CODE(46, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_COROUTINE_EVENT \
+    CXPLAT_CTL_CODE(47, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_COROUTINE_LOCK \
+    CXPLAT_CTL_CODE(48, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_COROUTINE_TIMER \
+    CXPLAT_CTL_CODE(49, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_COROUTINE_RESUME_ON_PROC \
+    CXPLAT_CTL_CODE(50, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_PROC_CURRENT_NUMBER \
+    CXPLAT_CTL_CODE(51, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define IOCTL_CXPLAT_RUN_RATE_LIMITER_HIGH_RATE \
+    CXPLAT_CTL_CODE(52, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define CXPLAT_MAX_IOCTL_FUNC_CODE 52
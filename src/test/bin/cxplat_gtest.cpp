@@ -142,6 +142,51 @@ TEST(TimeSuite, Basic) {
     }
 }
 
+TEST(TimeSuite, WaitUs) {
+    TestLogger Logger("CxPlatTestTimeWaitUs");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIME_WAIT_US));
+    } else {
+        CxPlatTestTimeWaitUs();
+    }
+}
+
+TEST(TimeSuite, Plat) {
+    TestLogger Logger("CxPlatTestTimePlat");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIME_PLAT));
+    } else {
+        CxPlatTestTimePlat();
+    }
+}
+
+TEST(TimeSuite, Coarse) {
+    TestLogger Logger("CxPlatTestTimeCoarse");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIME_COARSE));
+    } else {
+        CxPlatTestTimeCoarse();
+    }
+}
+
+TEST(TimeSuite, SleepUntil) {
+    TestLogger Logger("CxPlatTestTimeSleepUntil");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIME_SLEEP_UNTIL));
+    } else {
+        CxPlatTestTimeSleepUntil();
+    }
+}
+
+TEST(TimeSuite, Epoch) {
+    TestLogger Logger("CxPlatTestTimeEpoch");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIME_EPOCH));
+    } else {
+        CxPlatTestTimeEpoch();
+    }
+}
+
 TEST(EventSuite, Basic) {
     TestLogger Logger("CxPlatTestEventBasic");
     if (TestingKernelMode) {
@@ -169,6 +214,24 @@ TEST(ProcSuite, Basic) {
     }
 }
 
+TEST(ProcSuite, Topology) {
+    TestLogger Logger("CxPlatTestProcTopology");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_PROC_TOPOLOGY));
+    } else {
+        CxPlatTestProcTopology();
+    }
+}
+
+TEST(ProcSuite, CurrentNumber) {
+    TestLogger Logger("CxPlatTestProcCurrentNumber");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_PROC_CURRENT_NUMBER));
+    } else {
+        CxPlatTestProcCurrentNumber();
+    }
+}
+
 TEST(ThreadSuite, Basic) {
     TestLogger Logger("CxPlatTestThreadBasic");
     if (TestingKernelMode) {
@@ -187,6 +250,24 @@ TEST(ThreadSuite, Async) {
     }
 }
 
+TEST(ThreadSuite, Placement) {
+    TestLogger Logger("CxPlatTestThreadPlacement");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_THREAD_PLACEMENT));
+    } else {
+        CxPlatTestThreadPlacement();
+    }
+}
+
+TEST(ThreadSuite, Cache) {
+    TestLogger Logger("CxPlatTestThreadCache");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_THREAD_CACHE));
+    } else {
+        CxPlatTestThreadCache();
+    }
+}
+
 #if _WIN32
 TEST(ThreadSuite, WithTimeout) {
     TestLogger Logger("CxPlatTestThreadWaitTimeout");
@@ -225,6 +306,285 @@ TEST(LockSuite, ReadWrite) {
     }
 }
 
+TEST(RundownSuite, Basic) {
+    TestLogger Logger("CxPlatTestRundownBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_RUNDOWN_BASIC));
+    } else {
+        CxPlatTestRundownBasic();
+    }
+}
+
+TEST(RundownSuite, CacheAware) {
+    TestLogger Logger("CxPlatTestRundownCacheAware");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_RUNDOWN_CACHE_AWARE));
+    } else {
+        CxPlatTestRundownCacheAware();
+    }
+}
+
+TEST(WaitOnAddressSuite, Basic) {
+    TestLogger Logger("CxPlatTestWaitOnAddressBasic");
+    if (TestingKernelMode) {
+        GTEST_SKIP_("Not supported in kernel mode");
+    } else {
+        CxPlatTestWaitOnAddressBasic();
+    }
+}
+
+TEST(DoorbellSuite, Basic) {
+    TestLogger Logger("CxPlatTestDoorbellBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_DOORBELL_BASIC));
+    } else {
+        CxPlatTestDoorbellBasic();
+    }
+}
+
+TEST(DoorbellSuite, Stress) {
+    TestLogger Logger("CxPlatTestDoorbellStress");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_DOORBELL_STRESS));
+    } else {
+        CxPlatTestDoorbellStress();
+    }
+}
+
+TEST(TimerWheelSuite, Basic) {
+    TestLogger Logger("CxPlatTestTimerWheelBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIMER_WHEEL_BASIC));
+    } else {
+        CxPlatTestTimerWheelBasic();
+    }
+}
+
+TEST(TimerWheelSuite, Random) {
+    TestLogger Logger("CxPlatTestTimerWheelRandom");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIMER_WHEEL_RANDOM));
+    } else {
+        CxPlatTestTimerWheelRandom();
+    }
+}
+
+TEST(TimerSuite, Basic) {
+    TestLogger Logger("CxPlatTestTimerBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIMER_BASIC));
+    } else {
+        CxPlatTestTimerBasic();
+    }
+}
+
+TEST(TimerSuite, Affinity) {
+    TestLogger Logger("CxPlatTestTimerAffinity");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIMER_AFFINITY));
+    } else {
+        CxPlatTestTimerAffinity();
+    }
+}
+
+TEST(TimerSuite, Coalesce) {
+    TestLogger Logger("CxPlatTestTimerCoalesce");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIMER_COALESCE));
+    } else {
+        CxPlatTestTimerCoalesce();
+    }
+}
+
+TEST(TimerSuite, Delete) {
+    TestLogger Logger("CxPlatTestTimerDelete");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_TIMER_DELETE));
+    } else {
+        CxPlatTestTimerDelete();
+    }
+}
+
+TEST(RateLimiterSuite, Basic) {
+    TestLogger Logger("CxPlatTestRateLimiterBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_RATE_LIMITER_BASIC));
+    } else {
+        CxPlatTestRateLimiterBasic();
+    }
+}
+
+TEST(RateLimiterSuite, Cached) {
+    TestLogger Logger("CxPlatTestRateLimiterCached");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_RATE_LIMITER_CACHED));
+    } else {
+        CxPlatTestRateLimiterCached();
+    }
+}
+
+TEST(RateLimiterSuite, HighRate) {
+    TestLogger Logger("CxPlatTestRateLimiterHighRate");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_RATE_LIMITER_HIGH_RATE));
+    } else {
+        CxPlatTestRateLimiterHighRate();
+    }
+}
+
+TEST(HistogramSuite, Basic) {
+    TestLogger Logger("CxPlatTestHistogramBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_HISTOGRAM_BASIC));
+    } else {
+        CxPlatTestHistogramBasic();
+    }
+}
+
+TEST(HistogramSuite, Concurrent) {
+    TestLogger Logger("CxPlatTestHistogramConcurrent");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_HISTOGRAM_CONCURRENT));
+    } else {
+        CxPlatTestHistogramConcurrent();
+    }
+}
+
+TEST(SchedulerSuite, Basic) {
+    TestLogger Logger("CxPlatTestSchedulerBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_SCHEDULER_BASIC));
+    } else {
+        CxPlatTestSchedulerBasic();
+    }
+}
+
+TEST(SchedulerSuite, Order) {
+    TestLogger Logger("CxPlatTestSchedulerOrder");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_SCHEDULER_ORDER));
+    } else {
+        CxPlatTestSchedulerOrder();
+    }
+}
+
+TEST(SchedulerSuite, Delete) {
+    TestLogger Logger("CxPlatTestSchedulerDelete");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_SCHEDULER_DELETE));
+    } else {
+        CxPlatTestSchedulerDelete();
+    }
+}
+
+TEST(ThreadPoolSuite, Basic) {
+    TestLogger Logger("CxPlatTestThreadPoolBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_THREAD_POOL_BASIC));
+    } else {
+        CxPlatTestThreadPoolBasic();
+    }
+}
+
+TEST(ThreadPoolSuite, Nested) {
+    TestLogger Logger("CxPlatTestThreadPoolNested");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_THREAD_POOL_NESTED));
+    } else {
+        CxPlatTestThreadPoolNested();
+    }
+}
+
+TEST(ExecutionContextSuite, Basic) {
+    TestLogger Logger("CxPlatTestExecutionContextBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_EXECUTION_CONTEXT_BASIC));
+    } else {
+        CxPlatTestExecutionContextBasic();
+    }
+}
+
+TEST(PerProcSuite, Basic) {
+    TestLogger Logger("CxPlatTestPerProcBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_PER_PROC_BASIC));
+    } else {
+        CxPlatTestPerProcBasic();
+    }
+}
+
+TEST(PerProcSuite, Aggregate) {
+    TestLogger Logger("CxPlatTestPerProcAggregate");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_PER_PROC_AGGREGATE));
+    } else {
+        CxPlatTestPerProcAggregate();
+    }
+}
+
+TEST(FutureSuite, Basic) {
+    TestLogger Logger("CxPlatTestFutureBasic");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_FUTURE_BASIC));
+    } else {
+        CxPlatTestFutureBasic();
+    }
+}
+
+TEST(FutureSuite, Pipeline) {
+    TestLogger Logger("CxPlatTestFuturePipeline");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_FUTURE_PIPELINE));
+    } else {
+        CxPlatTestFuturePipeline();
+    }
+}
+
+TEST(CoroutineSuite, Task) {
+    TestLogger Logger("CxPlatTestCoroutineTask");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_COROUTINE_TASK));
+    } else {
+        CxPlatTestCoroutineTask();
+    }
+}
+
+TEST(CoroutineSuite, Event) {
+    TestLogger Logger("CxPlatTestCoroutineEvent");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_COROUTINE_EVENT));
+    } else {
+        CxPlatTestCoroutineEvent();
+    }
+}
+
+TEST(CoroutineSuite, Lock) {
+    TestLogger Logger("CxPlatTestCoroutineLock");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_COROUTINE_LOCK));
+    } else {
+        CxPlatTestCoroutineLock();
+    }
+}
+
+TEST(CoroutineSuite, Timer) {
+    TestLogger Logger("CxPlatTestCoroutineTimer");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_COROUTINE_TIMER));
+    } else {
+        CxPlatTestCoroutineTimer();
+    }
+}
+
+TEST(CoroutineSuite, ResumeOnProc) {
+    TestLogger Logger("CxPlatTestCoroutineResumeOnProc");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_CXPLAT_RUN_COROUTINE_RESUME_ON_PROC));
+    } else {
+        CxPlatTestCoroutineResumeOnProc();
+    }
+}
+
 int main(int argc, char** argv) {
     for (int i = 0; i < argc; ++i) {
         if (strcmp("--kernel", argv[i]) == 0) {
@@ -370,6 +370,46 @@ size_t CXPLAT_IOCTL_BUFFER_SIZES[] =
     0,
     0,
     0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
 };
 
 static_assert(
@@ -528,6 +568,166 @@ CxPlatTestCtlEvtIoDeviceControl(
         CxPlatTestCtlRun(CxPlatTestLockReadWrite());
         break;
 
+    case IOCTL_CXPLAT_RUN_RUNDOWN_BASIC:
+        CxPlatTestCtlRun(CxPlatTestRundownBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_RUNDOWN_CACHE_AWARE:
+        CxPlatTestCtlRun(CxPlatTestRundownCacheAware());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIME_WAIT_US:
+        CxPlatTestCtlRun(CxPlatTestTimeWaitUs());
+        break;
+
+    case IOCTL_CXPLAT_RUN_WAIT_ON_ADDRESS_BASIC:
+        CxPlatTestCtlRun(CxPlatTestWaitOnAddressBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_DOORBELL_BASIC:
+        CxPlatTestCtlRun(CxPlatTestDoorbellBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_DOORBELL_STRESS:
+        CxPlatTestCtlRun(CxPlatTestDoorbellStress());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIME_PLAT:
+        CxPlatTestCtlRun(CxPlatTestTimePlat());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIME_COARSE:
+        CxPlatTestCtlRun(CxPlatTestTimeCoarse());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIMER_WHEEL_BASIC:
+        CxPlatTestCtlRun(CxPlatTestTimerWheelBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIMER_WHEEL_RANDOM:
+        CxPlatTestCtlRun(CxPlatTestTimerWheelRandom());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIMER_BASIC:
+        CxPlatTestCtlRun(CxPlatTestTimerBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIMER_AFFINITY:
+        CxPlatTestCtlRun(CxPlatTestTimerAffinity());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIMER_DELETE:
+        CxPlatTestCtlRun(CxPlatTestTimerDelete());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIMER_COALESCE:
+        CxPlatTestCtlRun(CxPlatTestTimerCoalesce());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIME_SLEEP_UNTIL:
+        CxPlatTestCtlRun(CxPlatTestTimeSleepUntil());
+        break;
+
+    case IOCTL_CXPLAT_RUN_RATE_LIMITER_BASIC:
+        CxPlatTestCtlRun(CxPlatTestRateLimiterBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_RATE_LIMITER_CACHED:
+        CxPlatTestCtlRun(CxPlatTestRateLimiterCached());
+        break;
+
+    case IOCTL_CXPLAT_RUN_HISTOGRAM_BASIC:
+        CxPlatTestCtlRun(CxPlatTestHistogramBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_HISTOGRAM_CONCURRENT:
+        CxPlatTestCtlRun(CxPlatTestHistogramConcurrent());
+        break;
+
+    case IOCTL_CXPLAT_RUN_TIME_EPOCH:
+        CxPlatTestCtlRun(CxPlatTestTimeEpoch());
+        break;
+
+    case IOCTL_CXPLAT_RUN_SCHEDULER_BASIC:
+        CxPlatTestCtlRun(CxPlatTestSchedulerBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_SCHEDULER_ORDER:
+        CxPlatTestCtlRun(CxPlatTestSchedulerOrder());
+        break;
+
+    case IOCTL_CXPLAT_RUN_SCHEDULER_DELETE:
+        CxPlatTestCtlRun(CxPlatTestSchedulerDelete());
+        break;
+
+    case IOCTL_CXPLAT_RUN_THREAD_POOL_BASIC:
+        CxPlatTestCtlRun(CxPlatTestThreadPoolBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_THREAD_POOL_NESTED:
+        CxPlatTestCtlRun(CxPlatTestThreadPoolNested());
+        break;
+
+    case IOCTL_CXPLAT_RUN_EXECUTION_CONTEXT_BASIC:
+        CxPlatTestCtlRun(CxPlatTestExecutionContextBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_PROC_TOPOLOGY:
+        CxPlatTestCtlRun(CxPlatTestProcTopology());
+        break;
+
+    case IOCTL_CXPLAT_RUN_PER_PROC_BASIC:
+        CxPlatTestCtlRun(CxPlatTestPerProcBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_PER_PROC_AGGREGATE:
+        CxPlatTestCtlRun(CxPlatTestPerProcAggregate());
+        break;
+
+    case IOCTL_CXPLAT_RUN_THREAD_PLACEMENT:
+        CxPlatTestCtlRun(CxPlatTestThreadPlacement());
+        break;
+
+    case IOCTL_CXPLAT_RUN_THREAD_CACHE:
+        CxPlatTestCtlRun(CxPlatTestThreadCache());
+        break;
+
+    case IOCTL_CXPLAT_RUN_FUTURE_BASIC:
+        CxPlatTestCtlRun(CxPlatTestFutureBasic());
+        break;
+
+    case IOCTL_CXPLAT_RUN_FUTURE_PIPELINE:
+        CxPlatTestCtlRun(CxPlatTestFuturePipeline());
+        break;
+
+    case IOCTL_CXPLAT_RUN_COROUTINE_TASK:
+        CxPlatTestCtlRun(CxPlatTestCoroutineTask());
+        break;
+
+    case IOCTL_CXPLAT_RUN_COROUTINE_EVENT:
+        CxPlatTestCtlRun(CxPlatTestCoroutineEvent());
+        break;
+
+    case IOCTL_CXPLAT_RUN_COROUTINE_LOCK:
+        CxPlatTestCtlRun(CxPlatTestCoroutineLock());
+        break;
+
+    case IOCTL_CXPLAT_RUN_COROUTINE_TIMER:
+        CxPlatTestCtlRun(CxPlatTestCoroutineTimer());
+        break;
+
+    case IOCTL_CXPLAT_RUN_COROUTINE_RESUME_ON_PROC:
+        CxPlatTestCtlRun(CxPlatTestCoroutineResumeOnProc());
+        break;
+
+    case IOCTL_CXPLAT_RUN_PROC_CURRENT_NUMBER:
+        CxPlatTestCtlRun(CxPlatTestProcCurrentNumber());
+        break;
+
+    case IOCTL_CXPLAT_RUN_RATE_LIMITER_HIGH_RATE:
+        CxPlatTestCtlRun(CxPlatTestRateLimiterHighRate());
+        break;
+
     default:
         Status = STATUS_NOT_IMPLEMENTED;
         break;
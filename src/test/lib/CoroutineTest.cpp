@@ -0,0 +1,206 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Coroutine test.
+
+--*/
+
+#include "precomp.h"
+
+#ifdef CXPLAT_COROUTINES
+
+#define COROUTINE_WAITER_COUNT 1000
+#define COROUTINE_LOCK_COUNT 100
+#define COROUTINE_LOCK_ITERATIONS 10
+
+static CxPlatTask<uint32_t> CoroutineAdd(CxPlatCoEvent* Event, uint32_t A, uint32_t B)
+{
+    co_await *Event;
+    co_return A + B;
+}
+
+static CxPlatTask<uint64_t> CoroutineSum(CxPlatCoEvent* Event)
+{
+    uint64_t Sum = 0;
+    for (uint32_t i = 0; i < 10; ++i) {
+        Sum += co_await CoroutineAdd(Event, i, 1);
+    }
+    co_return Sum;
+}
+
+static CxPlatTask<> CoroutineWaitAndCount(CxPlatCoEvent* Event, long* Count)
+{
+    co_await *Event;
+    InterlockedIncrement(Count);
+}
+
+struct CoroutineLockContext {
+    CxPlatCoLock* Lock;
+    CXPLAT_THREAD_POOL* Pool;
+    uint32_t Counter;
+    long Inside;
+    long Violations;
+};
+
+static CxPlatTask<> CoroutineLockIncrement(CoroutineLockContext* Ctx)
+{
+    for (uint32_t i = 0; i < COROUTINE_LOCK_ITERATIONS; ++i) {
+        co_await CxPlatCoResumeOnPool(Ctx->Pool);
+        co_await Ctx->Lock->Acquire();
+        if (InterlockedIncrement(&Ctx->Inside) != 1) {
+            InterlockedIncrement(&Ctx->Violations);
+        }
+        ++Ctx->Counter;
+
+        //
+        // Hold the lock across a suspension.
+        //
+        co_await CxPlatCoResumeOnPool(Ctx->Pool);
+        InterlockedDecrement(&Ctx->Inside);
+        Ctx->Lock->Release();
+    }
+}
+
+static CxPlatTask<uint64_t> CoroutineSleep(CxPlatCoTimer* Timer)
+{
+    const uint64_t Start = CxPlatTimeUs64();
+    co_await Timer->Sleep(10000);
+    co_await Timer->Sleep(5000);
+    co_return CxPlatTimeDiff64(Start, CxPlatTimeUs64());
+}
+
+static CxPlatTask<uint32_t> CoroutineVisitProcs(CXPLAT_WORKER_POOL* Pool)
+{
+    uint32_t Visited = 0;
+    for (uint32_t i = 0; i < CxPlatProcCount(); ++i) {
+        co_await CxPlatCoResumeOnProc(Pool, i);
+        if (CxPlatProcCurrentNumber() == i) {
+            ++Visited;
+        }
+    }
+    co_return Visited;
+}
+
+#endif // CXPLAT_COROUTINES
+
+void CxPlatTestCoroutineTask()
+{
+#ifdef CXPLAT_COROUTINES
+    //
+    // Tasks that never suspend complete before returning.
+    //
+    {
+        CxPlatCoEvent Event;
+        Event.Set();
+        CxPlatTask<uint64_t> Task = CoroutineSum(&Event);
+        TEST_TRUE(Task.IsValid());
+        TEST_TRUE(Task.IsReady());
+        TEST_EQUAL(55u, Task.Get());
+    }
+
+    //
+    // Nested tasks resume each other once another thread unblocks them.
+    //
+    {
+        CxPlatCoEvent Event;
+        CxPlatTask<uint64_t> Task = CoroutineSum(&Event);
+        TEST_FALSE(Task.IsReady());
+        CxPlatAsyncT<CxPlatCoEvent> Async([](CxPlatCoEvent* Event) {
+            Event->Set();
+        }, &Event);
+        TEST_EQUAL(55u, Task.Get());
+    }
+#endif // CXPLAT_COROUTINES
+}
+
+void CxPlatTestCoroutineEvent()
+{
+#ifdef CXPLAT_COROUTINES
+    CxPlatThreadPool Pool;
+    TEST_TRUE(Pool.IsValid());
+    CxPlatCoEvent Event(Pool);
+    long Count = 0;
+
+    {
+        CxPlatTask<> Tasks[COROUTINE_WAITER_COUNT];
+        for (uint32_t i = 0; i < COROUTINE_WAITER_COUNT; ++i) {
+            Tasks[i] = CoroutineWaitAndCount(&Event, &Count);
+            TEST_TRUE(Tasks[i].IsValid());
+            TEST_FALSE(Tasks[i].IsReady());
+        }
+        Event.Set();
+        for (uint32_t i = 0; i < COROUTINE_WAITER_COUNT; ++i) {
+            Tasks[i].Wait();
+        }
+        TEST_EQUAL(COROUTINE_WAITER_COUNT, Count);
+    }
+
+    //
+    // Waits on a set event don't suspend, and Reset makes them suspend again.
+    //
+    {
+        CxPlatTask<> Task = CoroutineWaitAndCount(&Event, &Count);
+        TEST_TRUE(Task.IsReady());
+        Event.Reset();
+        CxPlatTask<> Next = CoroutineWaitAndCount(&Event, &Count);
+        TEST_FALSE(Next.IsReady());
+        Event.Set();
+        Next.Wait();
+        TEST_EQUAL(COROUTINE_WAITER_COUNT + 2, Count);
+    }
+#endif // CXPLAT_COROUTINES
+}
+
+void CxPlatTestCoroutineLock()
+{
+#ifdef CXPLAT_COROUTINES
+    CxPlatThreadPool Pool;
+    TEST_TRUE(Pool.IsValid());
+    CxPlatCoLock Lock(Pool);
+    CoroutineLockContext Ctx = { &Lock, Pool, 0, 0, 0 };
+
+    {
+        CxPlatTask<> Tasks[COROUTINE_LOCK_COUNT];
+        for (uint32_t i = 0; i < COROUTINE_LOCK_COUNT; ++i) {
+            Tasks[i] = CoroutineLockIncrement(&Ctx);
+        }
+    }
+
+    TEST_EQUAL(0, Ctx.Violations);
+    TEST_EQUAL((uint32_t)(COROUTINE_LOCK_COUNT * COROUTINE_LOCK_ITERATIONS), Ctx.Counter);
+#endif // CXPLAT_COROUTINES
+}
+
+void CxPlatTestCoroutineTimer()
+{
+#ifdef CXPLAT_COROUTINES
+    CxPlatThreadPool Pool;
+    TEST_TRUE(Pool.IsValid());
+    CxPlatCoTimer Timer(Pool);
+    TEST_TRUE(Timer.IsValid());
+
+    CxPlatTask<uint64_t> Task = CoroutineSleep(&Timer);
+    TEST_TRUE(Task.Get() >= 15000);
+#endif // CXPLAT_COROUTINES
+}
+
+void CxPlatTestCoroutineResumeOnProc()
+{
+#ifdef CXPLAT_COROUTINES
+    CXPLAT_WORKER_POOL* Pool;
+    TEST_CXPLAT(CxPlatWorkerPoolCreate(&Pool));
+
+    {
+        CxPlatTask<uint32_t> Task = CoroutineVisitProcs(Pool);
+        TEST_EQUAL_GOTO(CxPlatProcCount(), Task.Get());
+    }
+
+Failure:
+
+    CxPlatWorkerPoolDelete(Pool);
+#endif // CXPLAT_COROUTINES
+}
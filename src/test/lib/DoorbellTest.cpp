@@ -0,0 +1,110 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Doorbell test.
+
+--*/
+
+#include "precomp.h"
+
+void CxPlatTestDoorbellBasic()
+{
+    CXPLAT_DOORBELL Doorbell;
+    CxPlatDoorbellInitialize(&Doorbell);
+
+    //
+    // Nothing pending.
+    //
+    TEST_EQUAL(0u, CxPlatDoorbellDrain(&Doorbell));
+    TEST_EQUAL(0u, CxPlatDoorbellWaitWithTimeoutUs(&Doorbell, 0));
+    TEST_EQUAL(0u, CxPlatDoorbellWaitWithTimeoutUs(&Doorbell, 1000));
+
+    //
+    // Rings coalesce into a single drain.
+    //
+    CxPlatDoorbellRing(&Doorbell);
+    CxPlatDoorbellRing(&Doorbell);
+    CxPlatDoorbellRing(&Doorbell);
+    TEST_EQUAL(3u, CxPlatDoorbellWait(&Doorbell));
+    TEST_EQUAL(0u, CxPlatDoorbellDrain(&Doorbell));
+
+    CxPlatDoorbellRing(&Doorbell);
+    TEST_EQUAL(1u, CxPlatDoorbellWaitWithTimeoutUs(&Doorbell, 1000));
+
+    //
+    // A parked consumer is woken by another thread.
+    //
+    {
+        CxPlatAsyncT<CXPLAT_DOORBELL> Async([](CXPLAT_DOORBELL* Doorbell) {
+            CxPlatSleep(50);
+            CxPlatDoorbellRing(Doorbell);
+        }, &Doorbell);
+        TEST_EQUAL(1u, CxPlatDoorbellWait(&Doorbell));
+    }
+
+    CxPlatDoorbellUninitialize(&Doorbell);
+
+    {
+        CxPlatDoorbell CppDoorbell;
+        TEST_EQUAL(0u, CppDoorbell.WaitTimeoutUs(0));
+        CppDoorbell.Ring();
+        CppDoorbell.Ring();
+        TEST_EQUAL(2u, CppDoorbell.Wait());
+    }
+}
+
+#define DOORBELL_STRESS_PRODUCERS 4
+#define DOORBELL_STRESS_RINGS 10000
+
+CXPLAT_THREAD_CALLBACK(DoorbellProducerFn, Ctx)
+{
+    CXPLAT_DOORBELL* Doorbell = (CXPLAT_DOORBELL*)Ctx;
+    for (uint32_t i = 0; i < DOORBELL_STRESS_RINGS; ++i) {
+        CxPlatDoorbellRing(Doorbell);
+    }
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestDoorbellStress()
+{
+    CXPLAT_DOORBELL Doorbell;
+    CXPLAT_THREAD Producers[DOORBELL_STRESS_PRODUCERS];
+    CXPLAT_THREAD_CONFIG ThreadConfig = {
+        0, 0, "CxPlatTestDoorbellStress", DoorbellProducerFn, &Doorbell
+    };
+    uint32_t ProducerCount = 0;
+    uint32_t Total = 0;
+
+    CxPlatDoorbellInitialize(&Doorbell);
+
+    for (; ProducerCount < DOORBELL_STRESS_PRODUCERS; ++ProducerCount) {
+        TEST_CXPLAT_GOTO(CxPlatThreadCreate(&ThreadConfig, &Producers[ProducerCount]));
+    }
+
+    //
+    // Every ring must be observed exactly once, and the consumer must never
+    // be left parked with rings pending.
+    //
+    while (Total < DOORBELL_STRESS_PRODUCERS * DOORBELL_STRESS_RINGS) {
+        uint32_t Rings = CxPlatDoorbellWaitWithTimeoutUs(&Doorbell, 2000 * 1000);
+        TEST_NOT_EQUAL_GOTO(0u, Rings);
+        Total += Rings;
+    }
+
+    TEST_EQUAL_GOTO(DOORBELL_STRESS_PRODUCERS * DOORBELL_STRESS_RINGS, Total);
+
+Failure:
+
+    for (uint32_t i = 0; i < ProducerCount; ++i) {
+        CxPlatThreadWaitForever(&Producers[i]);
+        CxPlatThreadDelete(&Producers[i]);
+    }
+
+    TEST_EQUAL(0u, CxPlatDoorbellDrain(&Doorbell));
+
+    CxPlatDoorbellUninitialize(&Doorbell);
+}
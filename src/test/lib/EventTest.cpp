@@ -37,6 +37,26 @@ void CxPlatTestEventBasic()
     CxPlatEventSet(Event);
     CxPlatEventWaitForever(Event);
 
+    //
+    // Immediate satisfy (WithSpin).
+    //
+    CxPlatEventReset(Event);
+    CxPlatEventSet(Event);
+    CxPlatEventWaitWithSpin(Event, CXPLAT_EVENT_DEFAULT_SPIN_COUNT);
+    TEST_FALSE(CxPlatEventWaitWithTimeout(Event, 0));
+
+    //
+    // Spin runs out and falls back to blocking until set by another thread.
+    //
+    CxPlatEventReset(Event);
+    {
+        CxPlatAsyncT<CXPLAT_EVENT> Async([](CXPLAT_EVENT* Event) {
+            CxPlatSleep(50);
+            CxPlatEventSet(*Event);
+        }, &Event);
+        CxPlatEventWaitWithSpin(Event, 1);
+    }
+
     CxPlatEventUninitialize(Event);
 }
 
@@ -55,5 +75,31 @@ void CxPlatTestEventCpp()
         Event.Reset();
         Event.Set();
         Event.WaitForever();
+
+        Event.Reset();
+        Event.Set();
+        Event.WaitWithSpin();
+    }
+
+    {
+        //
+        // Ping-pong handoff between two threads, each spinning for the other.
+        //
+        const uint32_t Iterations = 1000;
+        CxPlatEvent Ping, Pong;
+        struct Context {
+            CxPlatEvent* Ping;
+            CxPlatEvent* Pong;
+        } Ctx = { &Ping, &Pong };
+        CxPlatAsyncT<Context> Async([](Context* Ctx) {
+            for (uint32_t i = 0; i < Iterations; ++i) {
+                Ctx->Ping->WaitWithSpin();
+                Ctx->Pong->Set();
+            }
+        }, &Ctx);
+        for (uint32_t i = 0; i < Iterations; ++i) {
+            Ping.Set();
+            TEST_TRUE(Pong.WaitTimeout(2000));
+        }
     }
 }
@@ -0,0 +1,95 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Execution context test.
+
+--*/
+
+#include "precomp.h"
+
+struct ExecutionContextTestContext {
+    CXPLAT_EXECUTION_CONTEXT ExecutionContext;
+    CxPlatEvent Ran;
+    long RunCount;
+    uint32_t ProcIndex;
+    CXPLAT_THREAD_ID ThreadId;
+    uint64_t ArmTimerUs;
+    uint64_t TimerFiredUs;
+    bool Unregister;
+    ExecutionContextTestContext() :
+        RunCount(0), ProcIndex(UINT32_MAX), ThreadId(0), ArmTimerUs(0), TimerFiredUs(0), Unregister(false) { }
+};
+
+static BOOLEAN ExecutionContextTestRun(CXPLAT_EXECUTION_CONTEXT* ExecutionContext, const CXPLAT_EXECUTION_STATE* State)
+{
+    ExecutionContextTestContext* Ctx = (ExecutionContextTestContext*)ExecutionContext->Context;
+    if (Ctx->ArmTimerUs != 0) {
+        ExecutionContext->NextTimeUs = State->TimeNowUs + Ctx->ArmTimerUs;
+        Ctx->ArmTimerUs = 0;
+    } else if (ExecutionContext->NextTimeUs <= State->TimeNowUs) {
+        ExecutionContext->NextTimeUs = UINT64_MAX;
+        Ctx->TimerFiredUs = State->TimeNowUs;
+    }
+    Ctx->ProcIndex = State->ProcIndex;
+    Ctx->ThreadId = State->ThreadId;
+    InterlockedIncrement(&Ctx->RunCount);
+    const bool Unregister = Ctx->Unregister;
+    Ctx->Ran.Set();
+    return !Unregister;
+}
+
+void CxPlatTestExecutionContextBasic()
+{
+    CXPLAT_WORKER_POOL* Pool;
+    ExecutionContextTestContext Ctx;
+    const uint32_t ProcIndex = CxPlatProcCount() - 1;
+    CxPlatExecutionContextInitialize(&Ctx.ExecutionContext, ExecutionContextTestRun, &Ctx);
+    TEST_CXPLAT(CxPlatWorkerPoolCreate(&Pool));
+
+    //
+    // Contexts run once when added, on the requested processor's worker.
+    //
+    CxPlatWorkerPoolAddExecutionContext(Pool, &Ctx.ExecutionContext, ProcIndex);
+    TEST_TRUE_GOTO(Ctx.Ran.WaitTimeout(2000));
+    TEST_EQUAL_GOTO(1, Ctx.RunCount);
+    TEST_EQUAL_GOTO(ProcIndex, Ctx.ProcIndex);
+    TEST_NOT_EQUAL_GOTO(CxPlatCurThreadID(), Ctx.ThreadId);
+
+    //
+    // Idle contexts don't run again until woken.
+    //
+    TEST_FALSE_GOTO(Ctx.Ran.WaitTimeout(50));
+    CxPlatWakeExecutionContext(&Ctx.ExecutionContext);
+    TEST_TRUE_GOTO(Ctx.Ran.WaitTimeout(2000));
+    TEST_EQUAL_GOTO(2, Ctx.RunCount);
+
+    //
+    // Contexts run again once their NextTimeUs arrives, without a wake.
+    //
+    {
+        Ctx.ArmTimerUs = 10000;
+        const uint64_t Start = CxPlatTimeUs64();
+        CxPlatWakeExecutionContext(&Ctx.ExecutionContext);
+        while (Ctx.RunCount < 4 && Ctx.Ran.WaitTimeout(2000)) { }
+        TEST_EQUAL_GOTO(4, Ctx.RunCount);
+        TEST_TRUE_GOTO(CxPlatTimeDiff64(Start, Ctx.TimerFiredUs) >= 10000);
+    }
+
+    //
+    // Contexts that return FALSE are never run again, even with a timer set.
+    //
+    Ctx.Unregister = true;
+    Ctx.ArmTimerUs = 10000;
+    CxPlatWakeExecutionContext(&Ctx.ExecutionContext);
+    TEST_TRUE_GOTO(Ctx.Ran.WaitTimeout(2000));
+    TEST_FALSE_GOTO(Ctx.Ran.WaitTimeout(50));
+    TEST_EQUAL_GOTO(5, Ctx.RunCount);
+
+Failure:
+
+    CxPlatWorkerPoolDelete(Pool);
+}
@@ -0,0 +1,134 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Future and promise test.
+
+--*/
+
+#include "precomp.h"
+
+struct FutureTestValue {
+    uint32_t Id;
+    uint64_t Total;
+};
+
+void CxPlatTestFutureBasic()
+{
+    //
+    // Futures become ready when their promise is set from another thread.
+    //
+    {
+        CxPlatPromise<uint32_t> Promise;
+        TEST_TRUE(Promise.IsValid());
+        CxPlatFuture<uint32_t> Future = Promise.GetFuture();
+        TEST_FALSE(Future.IsReady());
+        TEST_FALSE(Future.WaitFor(0));
+
+        CxPlatAsyncT<CxPlatPromise<uint32_t>> Async([](CxPlatPromise<uint32_t>* Promise) {
+            Promise->SetValue(123);
+        }, &Promise);
+
+        TEST_EQUAL(123u, Future.Get());
+        TEST_TRUE(Future.IsReady());
+    }
+
+    //
+    // Without a pool, continuations run inline on whichever thread completes
+    // second.
+    //
+    {
+        CxPlatPromise<uint32_t> Promise;
+        CxPlatFuture<uint32_t> Future = Promise.GetFuture();
+        CxPlatFuture<uint64_t> Next =
+            Future.Then([](uint32_t Value) { return (uint64_t)Value * 2; });
+        TEST_TRUE(Next.IsValid());
+        TEST_FALSE(Next.IsReady());
+        Promise.SetValue(21);
+        TEST_TRUE(Next.IsReady());
+        TEST_EQUAL(42u, Next.Get());
+
+        CxPlatFuture<uint64_t> Last =
+            Next.Then([](uint64_t Value) { return Value + 1; });
+        TEST_TRUE(Last.IsReady());
+        TEST_EQUAL(43u, Last.Get());
+    }
+
+    //
+    // Void futures and void continuations chain to and from valued ones.
+    //
+    {
+        uint32_t Seen = 0;
+        CxPlatPromise<uint32_t> Promise;
+        CxPlatFuture<uint32_t> Future = Promise.GetFuture();
+        CxPlatFuture<void> Stored =
+            Future.Then([&Seen](uint32_t Value) { Seen = Value; });
+        CxPlatFuture<uint32_t> Read =
+            Stored.Then([&Seen]() { return Seen + 1; });
+        TEST_TRUE(Read.IsValid());
+        TEST_FALSE(Stored.IsReady());
+        Promise.SetValue(7);
+        TEST_EQUAL(7u, Seen);
+        TEST_TRUE(Stored.IsReady());
+        TEST_EQUAL(8u, Read.Get());
+
+        CxPlatPromise<void> Signal;
+        CxPlatFuture<void> Signaled = Signal.GetFuture();
+        CxPlatFuture<void> Counted =
+            Signaled.Then([&Seen]() { ++Seen; });
+        CxPlatAsyncT<CxPlatPromise<void>> Async([](CxPlatPromise<void>* Signal) {
+            Signal->SetValue();
+        }, &Signal);
+        Signaled.Wait();
+        TEST_TRUE(Counted.WaitFor(2000));
+        TEST_EQUAL(8u, Seen);
+    }
+}
+
+#define FUTURE_PIPELINE_COUNT 64
+
+void CxPlatTestFuturePipeline()
+{
+    CxPlatThreadPool Pool;
+    TEST_TRUE(Pool.IsValid());
+
+    //
+    // Chains of continuations run on the pool as each stage completes,
+    // including stages added after their value was already set.
+    //
+    for (uint32_t i = 0; i < FUTURE_PIPELINE_COUNT; ++i) {
+        long Stages = 0;
+        CxPlatPromise<FutureTestValue> Promise(Pool);
+        CxPlatFuture<FutureTestValue> Future = Promise.GetFuture();
+
+        CxPlatFuture<FutureTestValue> Doubled =
+            Future.Then([&Stages](const FutureTestValue& Value) {
+                InterlockedIncrement(&Stages);
+                FutureTestValue Result = { Value.Id, Value.Total * 2 };
+                return Result;
+            });
+        if ((i & 1) == 0) {
+            Promise.SetValue(FutureTestValue{ i, i });
+        } else {
+            CxPlatAsyncT<CxPlatPromise<FutureTestValue>> Async(
+                [](CxPlatPromise<FutureTestValue>* Promise) {
+                    Promise->SetValue(FutureTestValue{ 0, 0 });
+                },
+                &Promise);
+        }
+        TEST_TRUE(Doubled.WaitFor(2000));
+
+        CxPlatFuture<uint64_t> Sum =
+            Doubled.Then([&Stages](const FutureTestValue& Value) {
+                InterlockedIncrement(&Stages);
+                return Value.Id + Value.Total;
+            });
+        TEST_TRUE(Sum.WaitFor(2000));
+        const uint64_t Expected = (i & 1) == 0 ? (uint64_t)i * 3 : 0;
+        TEST_EQUAL(Expected, Sum.Get());
+        TEST_EQUAL(2, Stages);
+    }
+}
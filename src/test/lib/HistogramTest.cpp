@@ -0,0 +1,158 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Histogram test.
+
+--*/
+
+#include "precomp.h"
+
+#define HISTOGRAM_SIGNIFICANT_BITS 7
+#define HISTOGRAM_MAX_VALUE_BITS 32
+
+//
+// True if Reported is no smaller than Expected and within the histogram's
+// relative error above it.
+//
+static bool HistogramValueMatches(uint64_t Expected, uint64_t Reported)
+{
+    return
+        Reported >= Expected &&
+        Reported <= Expected + (Expected >> HISTOGRAM_SIGNIFICANT_BITS);
+}
+
+void CxPlatTestHistogramBasic()
+{
+    CXPLAT_HISTOGRAM Histogram, Snapshot;
+    bool SnapshotInitialized = false;
+    TEST_CXPLAT(CxPlatHistogramInitialize(
+        &Histogram, HISTOGRAM_SIGNIFICANT_BITS, HISTOGRAM_MAX_VALUE_BITS));
+
+    TEST_EQUAL_GOTO(0u, CxPlatHistogramCount(&Histogram));
+    TEST_EQUAL_GOTO(0u, CxPlatHistogramMean(&Histogram));
+    TEST_EQUAL_GOTO(0u, CxPlatHistogramValueAtPercentile(&Histogram, 500000));
+
+    //
+    // Small values are exact.
+    //
+    for (uint64_t i = 0; i < 100; ++i) {
+        CxPlatHistogramRecord(&Histogram, i);
+    }
+    TEST_EQUAL_GOTO(100u, CxPlatHistogramCount(&Histogram));
+    TEST_EQUAL_GOTO(0u, CxPlatHistogramValueAtPercentile(&Histogram, 0));
+    TEST_EQUAL_GOTO(49u, CxPlatHistogramValueAtPercentile(&Histogram, 500000));
+    TEST_EQUAL_GOTO(99u, CxPlatHistogramValueAtPercentile(&Histogram, 1000000));
+
+    //
+    // Larger values are within the relative error, and the mean is exact.
+    //
+    CxPlatHistogramReset(&Histogram);
+    TEST_EQUAL_GOTO(0u, CxPlatHistogramCount(&Histogram));
+    for (uint64_t i = 1; i <= 10000; ++i) {
+        CxPlatHistogramRecord(&Histogram, i);
+    }
+    TEST_EQUAL_GOTO(10000u, CxPlatHistogramCount(&Histogram));
+    TEST_EQUAL_GOTO(5000u, CxPlatHistogramMean(&Histogram));
+    TEST_TRUE_GOTO(HistogramValueMatches(5000, CxPlatHistogramValueAtPercentile(&Histogram, 500000)));
+    TEST_TRUE_GOTO(HistogramValueMatches(9900, CxPlatHistogramValueAtPercentile(&Histogram, 990000)));
+    TEST_TRUE_GOTO(HistogramValueMatches(9990, CxPlatHistogramValueAtPercentile(&Histogram, 999000)));
+    TEST_TRUE_GOTO(HistogramValueMatches(10000, CxPlatHistogramValueAtPercentile(&Histogram, 1000000)));
+
+    //
+    // Values past the maximum land in the last bucket.
+    //
+    CxPlatHistogramRecord(&Histogram, UINT64_MAX);
+    TEST_EQUAL_GOTO(
+        (1ull << HISTOGRAM_MAX_VALUE_BITS) - 1,
+        CxPlatHistogramValueAtPercentile(&Histogram, 1000000));
+
+    //
+    // A snapshot taken by merging is unaffected by later recording.
+    //
+    TEST_CXPLAT_GOTO(CxPlatHistogramInitialize(
+        &Snapshot, HISTOGRAM_SIGNIFICANT_BITS, HISTOGRAM_MAX_VALUE_BITS));
+    SnapshotInitialized = true;
+    CxPlatHistogramReset(&Histogram);
+    for (uint64_t i = 1; i <= 100; ++i) {
+        CxPlatHistogramRecord(&Histogram, i * 1000);
+    }
+    CxPlatHistogramMerge(&Snapshot, &Histogram);
+    CxPlatHistogramRecord(&Histogram, 1000000);
+    TEST_EQUAL_GOTO(100u, CxPlatHistogramCount(&Snapshot));
+    TEST_EQUAL_GOTO(50500u, CxPlatHistogramMean(&Snapshot));
+    TEST_TRUE_GOTO(HistogramValueMatches(100000, CxPlatHistogramValueAtPercentile(&Snapshot, 1000000)));
+
+    //
+    // Merging again accumulates.
+    //
+    CxPlatHistogramMerge(&Snapshot, &Histogram);
+    TEST_EQUAL_GOTO(201u, CxPlatHistogramCount(&Snapshot));
+    TEST_TRUE_GOTO(HistogramValueMatches(1000000, CxPlatHistogramValueAtPercentile(&Snapshot, 1000000)));
+
+Failure:
+
+    if (SnapshotInitialized) {
+        CxPlatHistogramUninitialize(&Snapshot);
+    }
+    CxPlatHistogramUninitialize(&Histogram);
+}
+
+#define HISTOGRAM_THREADS 4
+#define HISTOGRAM_VALUES_PER_THREAD 100000
+
+CXPLAT_THREAD_CALLBACK(HistogramRecordThread, Context)
+{
+    CXPLAT_HISTOGRAM* Histogram = (CXPLAT_HISTOGRAM*)Context;
+    for (uint64_t i = 1; i <= HISTOGRAM_VALUES_PER_THREAD; ++i) {
+        CxPlatHistogramRecord(Histogram, i);
+    }
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestHistogramConcurrent()
+{
+    CXPLAT_HISTOGRAM Histogram;
+    TEST_CXPLAT(CxPlatHistogramInitialize(
+        &Histogram, HISTOGRAM_SIGNIFICANT_BITS, HISTOGRAM_MAX_VALUE_BITS));
+
+    {
+        uint32_t ThreadCount = 0;
+        CXPLAT_THREAD Threads[HISTOGRAM_THREADS];
+
+        for (; ThreadCount < HISTOGRAM_THREADS; ++ThreadCount) {
+            CXPLAT_THREAD_CONFIG Config = {
+                0, 0, "CxPlatTestHistogramConcurrent", HistogramRecordThread, &Histogram
+            };
+            if (CXPLAT_FAILED(CxPlatThreadCreate(&Config, &Threads[ThreadCount]))) {
+                break;
+            }
+        }
+        for (uint32_t i = 0; i < ThreadCount; ++i) {
+            CxPlatThreadWaitForever(&Threads[i]);
+            CxPlatThreadDelete(&Threads[i]);
+        }
+        TEST_EQUAL_GOTO(HISTOGRAM_THREADS, ThreadCount);
+
+        //
+        // No recordings are lost.
+        //
+        TEST_EQUAL_GOTO(
+            (uint64_t)HISTOGRAM_THREADS * HISTOGRAM_VALUES_PER_THREAD,
+            CxPlatHistogramCount(&Histogram));
+        TEST_EQUAL_GOTO(
+            (uint64_t)(HISTOGRAM_VALUES_PER_THREAD + 1) / 2,
+            CxPlatHistogramMean(&Histogram));
+        TEST_TRUE_GOTO(
+            HistogramValueMatches(
+                HISTOGRAM_VALUES_PER_THREAD / 2,
+                CxPlatHistogramValueAtPercentile(&Histogram, 500000)));
+    }
+
+Failure:
+
+    CxPlatHistogramUninitialize(&Histogram);
+}
@@ -0,0 +1,95 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Per-processor storage test.
+
+--*/
+
+#include "precomp.h"
+
+struct PerProcTestSlot {
+    int64_t Count;
+    uint8_t Data[17];
+};
+
+void CxPlatTestPerProcBasic()
+{
+    CXPLAT_PER_PROC PerProc;
+    TEST_CXPLAT(CxPlatPerProcInitialize(&PerProc, sizeof(PerProcTestSlot)));
+    TEST_EQUAL_GOTO(CxPlatProcCount(), PerProc.Count);
+
+    //
+    // Slots start zeroed, on their own cache lines.
+    //
+    for (uint32_t i = 0; i < PerProc.Count; ++i) {
+        const uint8_t* Slot = (const uint8_t*)CxPlatPerProcGet(&PerProc, i);
+        TEST_EQUAL_GOTO(0u, (uintptr_t)Slot % CXPLAT_CACHE_LINE_SIZE);
+        for (uint32_t j = 0; j < sizeof(PerProcTestSlot); ++j) {
+            TEST_EQUAL_GOTO(0, Slot[j]);
+        }
+        for (uint32_t j = 0; j < i; ++j) {
+            const uint8_t* Other = (const uint8_t*)CxPlatPerProcGet(&PerProc, j);
+            TEST_TRUE_GOTO(Slot >= Other + sizeof(PerProcTestSlot) || Other >= Slot + sizeof(PerProcTestSlot));
+        }
+    }
+
+    {
+        bool Found = false;
+        void* Current = CxPlatPerProcGetCurrent(&PerProc);
+        for (uint32_t i = 0; i < PerProc.Count; ++i) {
+            Found |= Current == CxPlatPerProcGet(&PerProc, i);
+        }
+        TEST_TRUE_GOTO(Found);
+    }
+
+Failure:
+
+    CxPlatPerProcUninitialize(&PerProc);
+}
+
+#define PER_PROC_THREADS 4
+#define PER_PROC_INCREMENTS 100000
+
+CXPLAT_THREAD_CALLBACK(PerProcIncrementThread, Context)
+{
+    CxPlatPerProc<PerProcTestSlot>* PerProc = (CxPlatPerProc<PerProcTestSlot>*)Context;
+    for (uint32_t i = 0; i < PER_PROC_INCREMENTS; ++i) {
+        InterlockedIncrement64(&PerProc->Current()->Count);
+    }
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestPerProcAggregate()
+{
+    CxPlatPerProc<PerProcTestSlot> PerProc;
+    TEST_TRUE(PerProc.IsValid());
+
+    uint32_t ThreadCount = 0;
+    CXPLAT_THREAD Threads[PER_PROC_THREADS];
+    for (; ThreadCount < PER_PROC_THREADS; ++ThreadCount) {
+        CXPLAT_THREAD_CONFIG Config = {
+            0, 0, "CxPlatTestPerProcAggregate", PerProcIncrementThread, &PerProc
+        };
+        if (CXPLAT_FAILED(CxPlatThreadCreate(&Config, &Threads[ThreadCount]))) {
+            break;
+        }
+    }
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        CxPlatThreadWaitForever(&Threads[i]);
+        CxPlatThreadDelete(&Threads[i]);
+    }
+    TEST_EQUAL(PER_PROC_THREADS, ThreadCount);
+
+    //
+    // No increments are lost, whichever slots they landed in.
+    //
+    int64_t Total = 0;
+    for (uint32_t i = 0; i < PerProc.Count(); ++i) {
+        Total += PerProc[i]->Count;
+    }
+    TEST_EQUAL((int64_t)PER_PROC_THREADS * PER_PROC_INCREMENTS, Total);
+}
@@ -11,8 +11,123 @@ Abstract:
 
 #include "precomp.h"
 
+#define CXPLAT_POOLTAG_PROC_TEST 'pPxC' // CxPp
+
 void CxPlatTestProcBasic()
 {
     TEST_TRUE(CxPlatProcCount() > 0);
+    TEST_TRUE(CxPlatProcCount() <= CxPlatProcSystemCount());
     TEST_TRUE(CxPlatProcCurrentNumber() < CxPlatProcCount());
+#ifndef _WIN32
+    for (uint32_t i = 1; i < CxPlatProcCount(); ++i) {
+        TEST_TRUE(CxPlatProcessorMap[i - 1] < CxPlatProcessorMap[i]);
+    }
+#endif
+}
+
+void CxPlatTestProcTopology()
+{
+#ifndef _WIN32
+    const uint32_t ProcCount = CxPlatProcCount();
+    uint32_t* Procs =
+        (uint32_t*)CXPLAT_ALLOC_NONPAGED(ProcCount * sizeof(uint32_t), CXPLAT_POOLTAG_PROC_TEST);
+    TEST_NOT_EQUAL(nullptr, Procs);
+
+    for (uint32_t i = 0; i < ProcCount; ++i) {
+        for (uint32_t Relation = CXPLAT_PROCESSOR_RELATION_CORE;
+             Relation <= CXPLAT_PROCESSOR_RELATION_NUMA_NODE;
+             ++Relation) {
+            const uint32_t Count =
+                CxPlatProcGetRelated(i, (CXPLAT_PROCESSOR_RELATION)Relation, Procs, ProcCount);
+            TEST_TRUE_GOTO(Count >= 1 && Count <= ProcCount);
+            TEST_EQUAL_GOTO(
+                Count, CxPlatProcGetRelated(i, (CXPLAT_PROCESSOR_RELATION)Relation, NULL, 0));
+
+            //
+            // Related processors are listed in ascending order and include
+            // the processor itself.
+            //
+            bool FoundSelf = false;
+            for (uint32_t j = 0; j < Count; ++j) {
+                TEST_TRUE_GOTO(Procs[j] < ProcCount);
+                TEST_TRUE_GOTO(j == 0 || Procs[j - 1] < Procs[j]);
+                FoundSelf |= Procs[j] == i;
+            }
+            TEST_TRUE_GOTO(FoundSelf);
+        }
+
+        //
+        // Shared domains are identified by their lowest processor.
+        //
+        TEST_TRUE_GOTO(CxPlatProcessorTopology[i].Core <= i);
+        TEST_TRUE_GOTO(CxPlatProcessorTopology[i].L2Domain <= i);
+        TEST_TRUE_GOTO(CxPlatProcessorTopology[i].L3Domain <= i);
+    }
+
+Failure:
+
+    CXPLAT_FREE(Procs, CXPLAT_POOLTAG_PROC_TEST);
+#endif
+}
+
+#ifndef _WIN32
+struct ProcTestCurrent {
+    uint32_t Current;
+    uint32_t FromCpu;
+    uint32_t Fallback;
+    bool RseqRegistered;
+    bool RseqSentinel;
+};
+
+CXPLAT_THREAD_CALLBACK(ProcTestCurrentFn, Ctx)
+{
+    ProcTestCurrent* Result = (ProcTestCurrent*)Ctx;
+    Result->Current = CxPlatProcCurrentNumber();
+    Result->FromCpu = CxPlatProcessorIndexes[sched_getcpu()];
+    Result->Fallback = CxPlatInternalProcCurrentNumber();
+#ifdef CXPLAT_PROC_RSEQ
+    Result->RseqRegistered = __rseq_size != 0;
+    Result->RseqSentinel =
+        *(volatile uint32_t*)&((struct rseq*)
+            ((uint8_t*)__builtin_thread_pointer() + __rseq_offset))->cpu_id >=
+        CxPlatProcessorCpuLimit;
+#else
+    Result->RseqRegistered = false;
+    Result->RseqSentinel = true;
+#endif
+    CXPLAT_THREAD_RETURN(0);
+}
+#endif // _WIN32
+
+void CxPlatTestProcCurrentNumber()
+{
+#ifndef _WIN32
+    CXPLAT_THREAD Thread;
+    CXPLAT_THREAD_CONFIG ThreadConfig;
+    ProcTestCurrent Result;
+
+    CxPlatZeroMemory(&ThreadConfig, sizeof(ThreadConfig));
+    ThreadConfig.Flags = CXPLAT_THREAD_FLAG_SET_AFFINITIZE;
+    ThreadConfig.Name = "CxPlatTestProcCurrentNumber";
+    ThreadConfig.Callback = ProcTestCurrentFn;
+    ThreadConfig.Context = (void*)&Result;
+
+    //
+    // A thread pinned to each processor sees that processor's index, whether
+    // it's read from the rseq area or from sched_getcpu. Without rseq (such as
+    // under GLIBC_TUNABLES=glibc.pthread.rseq=0), the area holds a sentinel
+    // that sends the read to the fallback.
+    //
+    for (uint32_t i = 0; i < CxPlatProcCount(); ++i) {
+        CxPlatZeroMemory(&Result, sizeof(Result));
+        ThreadConfig.IdealProcessor = (uint16_t)i;
+        TEST_CXPLAT(CxPlatThreadCreate(&ThreadConfig, &Thread));
+        CxPlatThreadWaitForever(&Thread);
+        CxPlatThreadDelete(&Thread);
+        TEST_EQUAL(i, Result.FromCpu);
+        TEST_EQUAL(i, Result.Current);
+        TEST_EQUAL(i, Result.Fallback);
+        TEST_TRUE(Result.RseqRegistered || Result.RseqSentinel);
+    }
+#endif // _WIN32
 }
@@ -0,0 +1,166 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Rate limiter test.
+
+--*/
+
+#include "precomp.h"
+
+void CxPlatTestRateLimiterBasic()
+{
+    CXPLAT_RATE_LIMITER Limiter;
+    TEST_CXPLAT(CxPlatRateLimiterInitialize(&Limiter, 100, 10, 0));
+
+    //
+    // Starts full.
+    //
+    TEST_EQUAL_GOTO(0u, CxPlatRateLimiterTimeUntilUs(&Limiter, 10));
+    TEST_EQUAL_GOTO(UINT64_MAX, CxPlatRateLimiterTimeUntilUs(&Limiter, 11));
+    TEST_FALSE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 11));
+    TEST_TRUE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 4));
+    for (uint32_t i = 0; i < 6; ++i) {
+        TEST_TRUE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 1));
+    }
+
+    //
+    // Empty, with one token every 10 milliseconds.
+    //
+    TEST_FALSE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 1));
+    {
+        const uint64_t WaitUs = CxPlatRateLimiterTimeUntilUs(&Limiter, 2);
+        TEST_TRUE_GOTO(WaitUs > 10000 && WaitUs <= 20000);
+        CxPlatSleepUs(WaitUs);
+        TEST_TRUE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 2));
+        TEST_FALSE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 1));
+    }
+
+    //
+    // Refills up to the burst size, but no further.
+    //
+    CxPlatSleep(150);
+    TEST_EQUAL_GOTO(0u, CxPlatRateLimiterTimeUntilUs(&Limiter, 10));
+    TEST_TRUE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 10));
+    TEST_FALSE_GOTO(CxPlatRateLimiterTryAcquire(&Limiter, 1));
+
+Failure:
+
+    CxPlatRateLimiterUninitialize(&Limiter);
+}
+
+void CxPlatTestRateLimiterHighRate()
+{
+    //
+    // Rates that aren't a whole number of nanoseconds per token, including
+    // ones above a token per nanosecond, refill exactly. Each case empties a
+    // million token bucket, and checks the time until it's full again.
+    //
+    const struct {
+        uint64_t Rate;
+        uint64_t RefillUs;
+    } Cases[] = {
+        { 400000000, 2500 },
+        { 700000000, 1429 },
+        { 2000000000, 500 },
+    };
+    const uint32_t Burst = 1000000;
+
+    for (uint32_t i = 0; i < sizeof(Cases) / sizeof(Cases[0]); ++i) {
+        CXPLAT_RATE_LIMITER Limiter;
+        TEST_CXPLAT(CxPlatRateLimiterInitialize(&Limiter, Cases[i].Rate, Burst, 0));
+        TEST_TRUE(CxPlatRateLimiterTryAcquire(&Limiter, Burst));
+        const uint64_t WaitUs = CxPlatRateLimiterTimeUntilUs(&Limiter, Burst);
+        CxPlatRateLimiterUninitialize(&Limiter);
+        TEST_TRUE(WaitUs <= Cases[i].RefillUs);
+        TEST_TRUE(WaitUs + 200 > Cases[i].RefillUs);
+    }
+
+    //
+    // Rates the limiter can't represent are rejected.
+    //
+    {
+        CXPLAT_RATE_LIMITER Limiter;
+        TEST_EQUAL(
+            CXPLAT_STATUS_NOT_SUPPORTED,
+            CxPlatRateLimiterInitialize(&Limiter, CXPLAT_RATE_LIMITER_MAX_RATE + 1, Burst, 0));
+    }
+}
+
+#define RATE_LIMITER_THREADS 4
+#define RATE_LIMITER_RUN_MS 100
+
+struct RateLimiterContext {
+    CXPLAT_RATE_LIMITER* Limiter;
+    uint64_t StopUs;
+    uint32_t Tokens;
+    uint64_t Acquired;
+};
+
+CXPLAT_THREAD_CALLBACK(RateLimiterThread, Context)
+{
+    RateLimiterContext* Ctx = (RateLimiterContext*)Context;
+    while (CxPlatTimeUs64() < Ctx->StopUs) {
+        if (CxPlatRateLimiterTryAcquire(Ctx->Limiter, Ctx->Tokens)) {
+            Ctx->Acquired += Ctx->Tokens;
+        }
+    }
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestRateLimiterCached()
+{
+    const uint64_t Rate = 100000;
+    const uint32_t Burst = 1000;
+    const uint32_t CacheSize = 16;
+    CXPLAT_RATE_LIMITER Limiter;
+    TEST_CXPLAT(CxPlatRateLimiterInitialize(&Limiter, Rate, Burst, CacheSize));
+
+    {
+        const uint64_t StartUs = CxPlatTimeUs64();
+        uint64_t TotalAcquired = 0;
+        uint32_t ThreadCount = 0;
+        CXPLAT_THREAD Threads[RATE_LIMITER_THREADS];
+        RateLimiterContext Contexts[RATE_LIMITER_THREADS];
+
+        for (; ThreadCount < RATE_LIMITER_THREADS; ++ThreadCount) {
+            RateLimiterContext* Ctx = &Contexts[ThreadCount];
+            Ctx->Limiter = &Limiter;
+            Ctx->StopUs = StartUs + RATE_LIMITER_RUN_MS * 1000;
+            Ctx->Tokens = 1 + ThreadCount % 3;
+            Ctx->Acquired = 0;
+            CXPLAT_THREAD_CONFIG Config = {
+                0, 0, "CxPlatTestRateLimiterCached", RateLimiterThread, Ctx
+            };
+            if (CXPLAT_FAILED(CxPlatThreadCreate(&Config, &Threads[ThreadCount]))) {
+                break;
+            }
+        }
+        for (uint32_t i = 0; i < ThreadCount; ++i) {
+            CxPlatThreadWaitForever(&Threads[i]);
+            CxPlatThreadDelete(&Threads[i]);
+        }
+        TEST_EQUAL_GOTO(RATE_LIMITER_THREADS, ThreadCount);
+
+        //
+        // Everything handed out fits within the burst, plus what was refilled
+        // over the run, plus at most one cache's worth per processor.
+        //
+        const uint64_t ElapsedUs = CxPlatTimeDiff64(StartUs, CxPlatTimeUs64());
+        for (uint32_t i = 0; i < RATE_LIMITER_THREADS; ++i) {
+            TotalAcquired += Contexts[i].Acquired;
+        }
+        TEST_TRUE_GOTO(TotalAcquired >= Burst);
+        TEST_TRUE_GOTO(
+            TotalAcquired <=
+                Burst + Rate * ElapsedUs / 1000000 + 1 +
+                (uint64_t)CacheSize * CxPlatProcCount());
+    }
+
+Failure:
+
+    CxPlatRateLimiterUninitialize(&Limiter);
+}
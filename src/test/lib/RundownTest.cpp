@@ -0,0 +1,109 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Rundown protection test.
+
+--*/
+
+#include "precomp.h"
+
+void CxPlatTestRundownBasic()
+{
+    CXPLAT_RUNDOWN_REF Rundown;
+    CxPlatRundownInitialize(&Rundown);
+
+    //
+    // Acquire/release with no rundown in progress.
+    //
+    TEST_TRUE(CxPlatRundownAcquire(&Rundown));
+    TEST_TRUE(CxPlatRundownAcquire(&Rundown));
+    CxPlatRundownRelease(&Rundown);
+    CxPlatRundownRelease(&Rundown);
+
+    //
+    // Wait with no outstanding references completes immediately and blocks
+    // further acquires.
+    //
+    CxPlatRundownWait(&Rundown);
+    TEST_FALSE(CxPlatRundownAcquire(&Rundown));
+
+    //
+    // Wait blocks until the last reference is released.
+    //
+    CxPlatRundownReinitialize(&Rundown);
+    TEST_TRUE(CxPlatRundownAcquire(&Rundown));
+    {
+        CxPlatEvent Event;
+        struct Context {
+            CxPlatEvent* Event;
+            CXPLAT_RUNDOWN_REF* Rundown;
+        } Ctx = { &Event, &Rundown };
+        CxPlatAsyncT<Context> Async([](Context* Ctx) {
+            CxPlatRundownWait(Ctx->Rundown);
+            Ctx->Event->Set();
+        }, &Ctx);
+        TEST_FALSE(Event.WaitTimeout(100));
+        CxPlatRundownRelease(&Rundown);
+        TEST_TRUE(Event.WaitTimeout(2000));
+    }
+    TEST_FALSE(CxPlatRundownAcquire(&Rundown));
+
+    CxPlatRundownUninitialize(&Rundown);
+}
+
+void CxPlatTestRundownCacheAware()
+{
+    CXPLAT_RUNDOWN_REF_CACHE_AWARE Rundown;
+    TEST_CXPLAT(CxPlatRundownCacheAwareInitialize(&Rundown));
+
+    //
+    // Acquire/release with no rundown in progress.
+    //
+    TEST_TRUE(CxPlatRundownCacheAwareAcquire(&Rundown));
+    TEST_TRUE(CxPlatRundownCacheAwareAcquire(&Rundown));
+    CxPlatRundownCacheAwareRelease(&Rundown);
+    CxPlatRundownCacheAwareRelease(&Rundown);
+
+    //
+    // Wait with no outstanding references completes immediately and blocks
+    // further acquires.
+    //
+    CxPlatRundownCacheAwareWait(&Rundown);
+    TEST_FALSE(CxPlatRundownCacheAwareAcquire(&Rundown));
+
+    //
+    // Wait blocks until the last reference is released, including references
+    // released from another thread (and so possibly another processor).
+    //
+    CxPlatRundownCacheAwareReinitialize(&Rundown);
+    TEST_TRUE(CxPlatRundownCacheAwareAcquire(&Rundown));
+    TEST_TRUE(CxPlatRundownCacheAwareAcquire(&Rundown));
+    {
+        CxPlatAsyncT<CXPLAT_RUNDOWN_REF_CACHE_AWARE> Release(
+            [](CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown) {
+                CxPlatRundownCacheAwareRelease(Rundown);
+            }, &Rundown);
+        Release.Wait();
+    }
+    {
+        CxPlatEvent Event;
+        struct Context {
+            CxPlatEvent* Event;
+            CXPLAT_RUNDOWN_REF_CACHE_AWARE* Rundown;
+        } Ctx = { &Event, &Rundown };
+        CxPlatAsyncT<Context> Async([](Context* Ctx) {
+            CxPlatRundownCacheAwareWait(Ctx->Rundown);
+            Ctx->Event->Set();
+        }, &Ctx);
+        TEST_FALSE(Event.WaitTimeout(100));
+        CxPlatRundownCacheAwareRelease(&Rundown);
+        TEST_TRUE(Event.WaitTimeout(2000));
+    }
+    TEST_FALSE(CxPlatRundownCacheAwareAcquire(&Rundown));
+
+    CxPlatRundownCacheAwareUninitialize(&Rundown);
+}
@@ -0,0 +1,200 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Scheduler test.
+
+--*/
+
+#include "precomp.h"
+
+struct SchedulerTestContext {
+    CxPlatEvent Ran;
+    long RunCount;
+    uint64_t LastLatenessUs;
+    uint32_t CallbackDelayMs;
+    long CallbackComplete;
+    SchedulerTestContext() : RunCount(0), LastLatenessUs(0), CallbackDelayMs(0), CallbackComplete(0) { }
+};
+
+static void SchedulerTestCallback(CXPLAT_SCHEDULER_TASK* Task, void* Context, uint64_t LatenessUs)
+{
+    UNREFERENCED_PARAMETER(Task);
+    SchedulerTestContext* Ctx = (SchedulerTestContext*)Context;
+    Ctx->LastLatenessUs = LatenessUs;
+    InterlockedIncrement(&Ctx->RunCount);
+    Ctx->Ran.Set();
+    if (Ctx->CallbackDelayMs != 0) {
+        CxPlatSleep(Ctx->CallbackDelayMs);
+    }
+    InterlockedExchange(&Ctx->CallbackComplete, 1);
+}
+
+void CxPlatTestSchedulerBasic()
+{
+    SchedulerTestContext Ctx;
+    CXPLAT_SCHEDULER* Scheduler;
+    CXPLAT_SCHEDULER_TASK* Task = NULL;
+    CXPLAT_SCHEDULER_STATS Stats;
+    TEST_CXPLAT(CxPlatSchedulerCreate(2, 0, &Scheduler));
+    TEST_CXPLAT_GOTO(CxPlatSchedulerTaskCreate(Scheduler, SchedulerTestCallback, &Ctx, &Task));
+
+    //
+    // Never started.
+    //
+    TEST_FALSE_GOTO(CxPlatSchedulerTaskCancel(Task));
+
+    //
+    // One-shot tasks run once, no earlier than requested.
+    //
+    {
+        const uint64_t Start = CxPlatTimeUs64();
+        CxPlatSchedulerTaskStart(Task, 10000, 0);
+        TEST_TRUE_GOTO(Ctx.Ran.WaitTimeout(2000));
+        TEST_TRUE_GOTO(CxPlatTimeDiff64(Start, CxPlatTimeUs64()) >= 10000);
+        TEST_EQUAL_GOTO(1, Ctx.RunCount);
+        TEST_FALSE_GOTO(CxPlatSchedulerTaskCancel(Task));
+    }
+
+    //
+    // Cancel before it runs.
+    //
+    CxPlatSchedulerTaskStart(Task, 50000, 0);
+    TEST_TRUE_GOTO(CxPlatSchedulerTaskCancel(Task));
+    TEST_FALSE_GOTO(Ctx.Ran.WaitTimeout(100));
+    TEST_EQUAL_GOTO(1, Ctx.RunCount);
+
+    //
+    // Periodic tasks keep running until cancelled, without drifting.
+    //
+    {
+        const uint64_t Start = CxPlatTimeUs64();
+        CxPlatSchedulerTaskStart(Task, 0, 5000);
+        CxPlatSleep(100);
+        TEST_TRUE_GOTO(CxPlatSchedulerTaskCancel(Task));
+        const uint64_t ElapsedUs = CxPlatTimeDiff64(Start, CxPlatTimeUs64());
+        CxPlatSleep(20); // Let a callback that was already running finish.
+        CxPlatSchedulerGetStats(Scheduler, &Stats);
+        TEST_TRUE_GOTO(Ctx.RunCount > 1);
+        TEST_TRUE_GOTO(
+            Ctx.RunCount - 1 + Stats.MissedPeriods <= 1 + 1 + ElapsedUs / 5000);
+        TEST_EQUAL_GOTO((uint64_t)Ctx.RunCount, Stats.Runs);
+        TEST_TRUE_GOTO(Stats.MaxLatenessUs >= Ctx.LastLatenessUs);
+    }
+
+Failure:
+
+    if (Task != NULL) {
+        CxPlatSchedulerTaskDelete(Task);
+    }
+    CxPlatSchedulerDelete(Scheduler);
+}
+
+#define SCHEDULER_ORDER_COUNT 8
+
+struct SchedulerOrderContext {
+    CXPLAT_SCHEDULER_TASK* Tasks[SCHEDULER_ORDER_COUNT];
+    uint32_t Order[SCHEDULER_ORDER_COUNT];
+    long RunCount;
+    CxPlatEvent Done;
+};
+
+void CxPlatTestSchedulerOrder()
+{
+    SchedulerOrderContext Ctx;
+    SchedulerTestContext BlockerCtx;
+    CXPLAT_SCHEDULER* Scheduler;
+    CXPLAT_SCHEDULER_TASK* Blocker = NULL;
+    uint32_t Created = 0;
+    Ctx.RunCount = 0;
+    TEST_CXPLAT(CxPlatSchedulerCreate(1, 0, &Scheduler));
+
+    for (; Created < SCHEDULER_ORDER_COUNT; ++Created) {
+        TEST_CXPLAT_GOTO(CxPlatSchedulerTaskCreate(
+            Scheduler,
+            [](CXPLAT_SCHEDULER_TASK* Task, void* Context, uint64_t) {
+                SchedulerOrderContext* Ctx = (SchedulerOrderContext*)Context;
+                for (uint32_t i = 0; i < SCHEDULER_ORDER_COUNT; ++i) {
+                    if (Ctx->Tasks[i] == Task) {
+                        Ctx->Order[Ctx->RunCount] = i;
+                    }
+                }
+                if (++Ctx->RunCount == SCHEDULER_ORDER_COUNT) {
+                    Ctx->Done.Set();
+                }
+            },
+            &Ctx,
+            &Ctx.Tasks[Created]));
+    }
+
+    //
+    // Keep the only thread busy while tasks with shuffled deadlines become
+    // due, then check they ran earliest deadline first.
+    //
+    BlockerCtx.CallbackDelayMs = 100;
+    TEST_CXPLAT_GOTO(CxPlatSchedulerTaskCreate(Scheduler, SchedulerTestCallback, &BlockerCtx, &Blocker));
+    CxPlatSchedulerTaskStart(Blocker, 0, 0);
+    TEST_TRUE_GOTO(BlockerCtx.Ran.WaitTimeout(2000));
+    for (uint32_t i = 0; i < SCHEDULER_ORDER_COUNT; ++i) {
+        const uint32_t Index = (i * 5) % SCHEDULER_ORDER_COUNT;
+        CxPlatSchedulerTaskStart(Ctx.Tasks[Index], 1000 + Index * 1000, 0);
+    }
+    TEST_TRUE_GOTO(Ctx.Done.WaitTimeout(2000));
+    for (uint32_t i = 0; i < SCHEDULER_ORDER_COUNT; ++i) {
+        TEST_EQUAL_GOTO(i, Ctx.Order[i]);
+    }
+
+Failure:
+
+    if (Blocker != NULL) {
+        CxPlatSchedulerTaskDelete(Blocker);
+    }
+    for (uint32_t i = 0; i < Created; ++i) {
+        CxPlatSchedulerTaskDelete(Ctx.Tasks[i]);
+    }
+    CxPlatSchedulerDelete(Scheduler);
+}
+
+void CxPlatTestSchedulerDelete()
+{
+    SchedulerTestContext Ctx;
+    CXPLAT_SCHEDULER* Scheduler;
+    CXPLAT_SCHEDULER_TASK* Task;
+    CxPlatEvent Deleted;
+    TEST_CXPLAT(CxPlatSchedulerCreate(1, 0, &Scheduler));
+
+    //
+    // Delete waits for a running callback to complete.
+    //
+    Ctx.CallbackDelayMs = 100;
+    TEST_CXPLAT_GOTO(CxPlatSchedulerTaskCreate(Scheduler, SchedulerTestCallback, &Ctx, &Task));
+    CxPlatSchedulerTaskStart(Task, 0, 1000);
+    {
+        const bool Ran = Ctx.Ran.WaitTimeout(2000);
+        CxPlatSchedulerTaskDelete(Task);
+        TEST_TRUE_GOTO(Ran);
+    }
+    TEST_EQUAL_GOTO(1, Ctx.CallbackComplete);
+    TEST_EQUAL_GOTO(1, Ctx.RunCount);
+
+    //
+    // A periodic task can delete itself from its own callback.
+    //
+    TEST_CXPLAT_GOTO(CxPlatSchedulerTaskCreate(
+        Scheduler,
+        [](CXPLAT_SCHEDULER_TASK* Task, void* Context, uint64_t) {
+            CxPlatSchedulerTaskDelete(Task);
+            ((CxPlatEvent*)Context)->Set();
+        },
+        &Deleted,
+        &Task));
+    CxPlatSchedulerTaskStart(Task, 0, 1000);
+    TEST_TRUE_GOTO(Deleted.WaitTimeout(2000));
+
+Failure:
+
+    CxPlatSchedulerDelete(Scheduler);
+}
@@ -0,0 +1,177 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Thread pool test.
+
+--*/
+
+#include "precomp.h"
+
+#define CXPLAT_POOLTAG_THREAD_POOL_TEST 'tPxC' // CxPt
+
+#define THREAD_POOL_WORK_COUNT 1000
+
+struct ThreadPoolCounter {
+    long Count;
+};
+
+struct ThreadPoolSelfFreeingWork {
+    CXPLAT_THREAD_POOL_WORK Work;
+    CxPlatEvent* Done;
+};
+
+void CxPlatTestThreadPoolBasic()
+{
+    CxPlatThreadPool Pool;
+    TEST_TRUE(Pool.IsValid());
+
+    //
+    // Work submitted from outside the pool all runs, and the group tracks it.
+    //
+    {
+        ThreadPoolCounter Counter = {0};
+        CxPlatThreadPoolGroup Group;
+        CXPLAT_THREAD_POOL_WORK* Work =
+            (CXPLAT_THREAD_POOL_WORK*)CXPLAT_ALLOC_NONPAGED(
+                THREAD_POOL_WORK_COUNT * sizeof(CXPLAT_THREAD_POOL_WORK), CXPLAT_POOLTAG_THREAD_POOL_TEST);
+        TEST_NOT_EQUAL(nullptr, Work);
+
+        for (uint32_t i = 0; i < THREAD_POOL_WORK_COUNT; ++i) {
+            CxPlatThreadPoolWorkInitialize(
+                &Work[i],
+                [](void* Context) { InterlockedIncrement(&((ThreadPoolCounter*)Context)->Count); },
+                &Counter,
+                Group);
+            Pool.Submit(&Work[i]);
+        }
+        Group.Wait(Pool);
+        CXPLAT_FREE(Work, CXPLAT_POOLTAG_THREAD_POOL_TEST);
+        TEST_EQUAL(THREAD_POOL_WORK_COUNT, Counter.Count);
+
+        //
+        // Groups can be waited on again, including with nothing outstanding.
+        //
+        Group.Wait(Pool);
+        CxPlatThreadPoolWorkT<ThreadPoolCounter> More(
+            [](ThreadPoolCounter* Counter) { InterlockedIncrement(&Counter->Count); },
+            &Counter,
+            Group);
+        More.Submit(Pool);
+        Group.Wait(Pool);
+        TEST_EQUAL(THREAD_POOL_WORK_COUNT + 1, Counter.Count);
+    }
+
+    //
+    // Work with no group can free itself.
+    //
+    {
+        CxPlatEvent Done;
+        ThreadPoolSelfFreeingWork* Work =
+            (ThreadPoolSelfFreeingWork*)CXPLAT_ALLOC_NONPAGED(
+                sizeof(ThreadPoolSelfFreeingWork), CXPLAT_POOLTAG_THREAD_POOL_TEST);
+        TEST_NOT_EQUAL(nullptr, Work);
+        Work->Done = &Done;
+        CxPlatThreadPoolWorkInitialize(
+            &Work->Work,
+            [](void* Context) {
+                ThreadPoolSelfFreeingWork* Work = (ThreadPoolSelfFreeingWork*)Context;
+                CxPlatEvent* Done = Work->Done;
+                CXPLAT_FREE(Work, CXPLAT_POOLTAG_THREAD_POOL_TEST);
+                Done->Set();
+            },
+            Work,
+            nullptr);
+        Pool.Submit(&Work->Work);
+        TEST_TRUE(Done.WaitTimeout(2000));
+    }
+}
+
+#define THREAD_POOL_SUM_COUNT 4096
+#define THREAD_POOL_SUM_LEAF 64
+
+struct ThreadPoolSumContext {
+    CXPLAT_THREAD_POOL* Pool;
+    const uint32_t* Values;
+    uint32_t Count;
+    int64_t* Total;
+};
+
+//
+// Splits the range in half, sums each half on the pool, and waits for both
+// from within the pool.
+//
+static void ThreadPoolSum(void* Context)
+{
+    ThreadPoolSumContext* Ctx = (ThreadPoolSumContext*)Context;
+    if (Ctx->Count <= THREAD_POOL_SUM_LEAF) {
+        int64_t Sum = 0;
+        for (uint32_t i = 0; i < Ctx->Count; ++i) {
+            Sum += Ctx->Values[i];
+        }
+        InterlockedExchangeAdd64(Ctx->Total, Sum);
+        return;
+    }
+
+    const uint32_t Half = Ctx->Count / 2;
+    ThreadPoolSumContext Children[2] = {
+        { Ctx->Pool, Ctx->Values, Half, Ctx->Total },
+        { Ctx->Pool, Ctx->Values + Half, Ctx->Count - Half, Ctx->Total }
+    };
+    CXPLAT_THREAD_POOL_GROUP Group;
+    CXPLAT_THREAD_POOL_WORK Work[2];
+    CxPlatThreadPoolGroupInitialize(&Group);
+    for (uint32_t i = 0; i < 2; ++i) {
+        CxPlatThreadPoolWorkInitialize(&Work[i], ThreadPoolSum, &Children[i], &Group);
+        CxPlatThreadPoolSubmit(Ctx->Pool, &Work[i]);
+    }
+    CxPlatThreadPoolGroupWait(Ctx->Pool, &Group);
+    CxPlatThreadPoolGroupUninitialize(&Group);
+}
+
+void CxPlatTestThreadPoolNested()
+{
+    CxPlatThreadPool Pool;
+    TEST_TRUE(Pool.IsValid());
+
+    uint32_t* Values =
+        (uint32_t*)CXPLAT_ALLOC_NONPAGED(THREAD_POOL_SUM_COUNT * sizeof(uint32_t), CXPLAT_POOLTAG_THREAD_POOL_TEST);
+    TEST_NOT_EQUAL(nullptr, Values);
+    int64_t Expected = 0;
+    for (uint32_t i = 0; i < THREAD_POOL_SUM_COUNT; ++i) {
+        Values[i] = i * 7 + 1;
+        Expected += Values[i];
+    }
+
+    for (uint32_t Round = 0; Round < 10; ++Round) {
+        int64_t Total = 0;
+        ThreadPoolSumContext Root = { Pool, Values, THREAD_POOL_SUM_COUNT, &Total };
+        CxPlatThreadPoolGroup Group;
+        CxPlatThreadPoolWork Work(ThreadPoolSum, &Root, Group);
+        Work.Submit(Pool);
+        Group.Wait(Pool);
+        TEST_EQUAL_GOTO(Expected, Total);
+    }
+
+    //
+    // Once idle, every worker is parked exactly once, including ones that
+    // were rung late for a group they had already finished waiting on.
+    //
+    for (uint32_t i = 0; i < 200; ++i) {
+        CXPLAT_THREAD_POOL_STATS Stats;
+        CxPlatThreadPoolGetStats(Pool, &Stats);
+        TEST_TRUE_GOTO(Stats.IdleCount <= Stats.WorkerCount);
+        if (Stats.IdleCount == Stats.WorkerCount && i >= 5) {
+            break;
+        }
+        TEST_TRUE_GOTO(i < 199);
+        CxPlatSleep(10);
+    }
+
+Failure:
+
+    CXPLAT_FREE(Values, CXPLAT_POOLTAG_THREAD_POOL_TEST);
+}
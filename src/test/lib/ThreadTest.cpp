@@ -88,7 +88,6 @@ void CxPlatTestThreadAsync()
         TEST_NOT_EQUAL(INITIAL_THREAD_ID_VALUE, ThreadId);
     }
 
-#if _WIN32
     {
         intptr_t Ctx = 0;
         CxPlatAsyncT<intptr_t> Async([](intptr_t* Ctx) {
@@ -101,7 +100,47 @@ void CxPlatTestThreadAsync()
         Async.Wait();
         TEST_NOT_EQUAL(Ctx, 0);
     }
-#endif // _WIN32
+}
+
+void CxPlatTestThreadCache()
+{
+    CXPLAT_CACHED_THREAD* Thread;
+    CXPLAT_THREAD_ID FirstId = INITIAL_THREAD_ID_VALUE;
+    CXPLAT_THREAD_ID SecondId = INITIAL_THREAD_ID_VALUE;
+
+    TEST_CXPLAT(CxPlatCachedThreadStart(
+        [](void* Ctx) { *(CXPLAT_THREAD_ID*)Ctx = CxPlatCurThreadID(); },
+        &FirstId,
+        &Thread));
+    CxPlatCachedThreadWait(Thread);
+    TEST_TRUE(CxPlatCachedThreadWaitWithTimeout(Thread, 0));
+    CxPlatCachedThreadRelease(Thread);
+    TEST_NOT_EQUAL(INITIAL_THREAD_ID_VALUE, FirstId);
+
+    //
+    // The thread just released is the first one handed out again.
+    //
+    TEST_CXPLAT(CxPlatCachedThreadStart(
+        [](void* Ctx) { *(CXPLAT_THREAD_ID*)Ctx = CxPlatCurThreadID(); },
+        &SecondId,
+        &Thread));
+    CxPlatCachedThreadRelease(Thread);
+    TEST_EQUAL(FirstId, SecondId);
+
+    //
+    // Waits time out while the callback is still running.
+    //
+    {
+        CxPlatEvent Continue;
+        TEST_CXPLAT(CxPlatCachedThreadStart(
+            [](void* Ctx) { ((CxPlatEvent*)Ctx)->WaitForever(); },
+            &Continue,
+            &Thread));
+        TEST_FALSE(CxPlatCachedThreadWaitWithTimeout(Thread, 50));
+        Continue.Set();
+        TEST_TRUE(CxPlatCachedThreadWaitWithTimeout(Thread, 2000));
+        CxPlatCachedThreadRelease(Thread);
+    }
 }
 
 #if _WIN32
@@ -133,3 +172,48 @@ Failure:
     CxPlatThreadDelete(&Thread);
 }
 #endif // _WIN32
+
+CXPLAT_THREAD_CALLBACK(ThreadProcFn, Ctx)
+{
+    *(uint32_t*)Ctx = CxPlatProcCurrentNumber();
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestThreadPlacement()
+{
+#ifndef _WIN32
+    CXPLAT_THREAD Thread;
+    CXPLAT_THREAD_CONFIG ThreadConfig;
+    const uint32_t LastProc = CxPlatProcCount() - 1;
+    uint32_t ProcIndex;
+
+    CxPlatZeroMemory(&ThreadConfig, sizeof(ThreadConfig));
+    ThreadConfig.Name = "CxPlatTestThreadPlacement";
+    ThreadConfig.Callback = ThreadProcFn;
+    ThreadConfig.Context = (void*)&ProcIndex;
+
+    //
+    // A thread limited to a processor set starts on it.
+    //
+    ProcIndex = UINT32_MAX;
+    ThreadConfig.Flags = CXPLAT_THREAD_FLAG_SET_PROCESSORS;
+    ThreadConfig.Processors = &LastProc;
+    ThreadConfig.ProcessorCount = 1;
+    TEST_CXPLAT(CxPlatThreadCreate(&ThreadConfig, &Thread));
+    CxPlatThreadWaitForever(&Thread);
+    CxPlatThreadDelete(&Thread);
+    TEST_EQUAL(LastProc, ProcIndex);
+
+    //
+    // A thread placed on a node starts on one of its processors.
+    //
+    ProcIndex = UINT32_MAX;
+    ThreadConfig.Flags = CXPLAT_THREAD_FLAG_SET_NUMA_NODE;
+    ThreadConfig.NumaNode = CxPlatProcessorTopology[LastProc].NumaNode;
+    TEST_CXPLAT(CxPlatThreadCreate(&ThreadConfig, &Thread));
+    CxPlatThreadWaitForever(&Thread);
+    CxPlatThreadDelete(&Thread);
+    TEST_TRUE(ProcIndex < CxPlatProcCount());
+    TEST_EQUAL(ThreadConfig.NumaNode, CxPlatProcessorTopology[ProcIndex].NumaNode);
+#endif // _WIN32
+}
@@ -49,3 +49,219 @@ void CxPlatTestTimeBasic()
     TEST_TRUE(CxPlatTimeAtOrBefore32(T1Ms32, T2Ms32));
     TEST_TRUE(CxPlatTimeAtOrBefore64(T1Ms64, T2Ms64));
 }
+
+void CxPlatTestTimePlat()
+{
+    const uint64_t SleepTimeMs = 100;
+    const uint64_t FudgeMs = 50;
+
+    TEST_TRUE(CxPlatPerfFreq >= 1000000);
+
+    //
+    // Platform time is monotonic and converts consistently in both directions.
+    //
+    uint64_t T1Plat = CxPlatTimePlat();
+    uint64_t T2Plat = CxPlatTimePlat();
+    TEST_TRUE(T1Plat <= T2Plat);
+
+    const uint64_t OneSecondUs = 1000 * 1000;
+    const uint64_t OneSecondPlat = CxPlatTimeUs64ToPlat(OneSecondUs);
+    TEST_TRUE(OneSecondPlat + 1 >= CxPlatPerfFreq && OneSecondPlat <= CxPlatPerfFreq + 1);
+    const uint64_t RoundTripUs = CxPlatTimePlatToUs64(OneSecondPlat);
+    TEST_TRUE(RoundTripUs + 1 >= OneSecondUs && RoundTripUs <= OneSecondUs + 1);
+
+    //
+    // Platform time advances at the same rate as the sleep.
+    //
+    T1Plat = CxPlatTimePlat();
+    CxPlatSleep((uint32_t)SleepTimeMs);
+    T2Plat = CxPlatTimePlat();
+    const uint64_t ElapsedMs = US_TO_MS(CxPlatTimePlatToUs64(T2Plat - T1Plat));
+    TEST_TRUE(ElapsedMs >= SleepTimeMs - 1);
+    TEST_TRUE(ElapsedMs < SleepTimeMs + FudgeMs);
+
+    //
+    // And agrees with the microsecond clock, which is derived from it.
+    //
+    const uint64_t T1Us = CxPlatTimeUs64();
+    const uint64_t TPlatUs = CxPlatTimePlatToUs64(CxPlatTimePlat());
+    const uint64_t T2Us = CxPlatTimeUs64();
+    TEST_TRUE(T1Us <= TPlatUs && TPlatUs <= T2Us);
+}
+
+void CxPlatTestTimeWaitUs()
+{
+    const uint64_t SleepTimeUs = 200;
+    const uint64_t TimeoutUs = 500;
+    const uint64_t FudgeUs = 100 * 1000;
+
+    //
+    // Sub-millisecond sleep. Only the lower bound is strict; the upper bound
+    // just catches sleeps that were rounded up to something much larger.
+    //
+    uint64_t T1Us = CxPlatTimeUs64();
+    CxPlatSleepUs(SleepTimeUs);
+    uint64_t T2Us = CxPlatTimeUs64();
+    TEST_TRUE(CxPlatTimeDiff64(T1Us, T2Us) >= SleepTimeUs);
+    TEST_TRUE(CxPlatTimeDiff64(T1Us, T2Us) < SleepTimeUs + FudgeUs);
+
+    CxPlatSleepUs(0);
+
+    CXPLAT_EVENT Event;
+    CxPlatEventInitialize(&Event, FALSE, FALSE);
+
+    //
+    // Timeout.
+    //
+    T1Us = CxPlatTimeUs64();
+    TEST_FALSE(CxPlatEventWaitWithTimeoutUs(Event, TimeoutUs));
+    T2Us = CxPlatTimeUs64();
+    TEST_TRUE(CxPlatTimeDiff64(T1Us, T2Us) >= TimeoutUs);
+    TEST_TRUE(CxPlatTimeDiff64(T1Us, T2Us) < TimeoutUs + FudgeUs);
+
+    TEST_FALSE(CxPlatEventWaitWithTimeoutUs(Event, 0));
+
+    //
+    // Immediate satisfy.
+    //
+    CxPlatEventSet(Event);
+    TEST_TRUE(CxPlatEventWaitWithTimeoutUs(Event, TimeoutUs));
+    CxPlatEventSet(Event);
+    TEST_TRUE(CxPlatEventWaitWithTimeoutUs(Event, 0));
+
+    CxPlatEventUninitialize(Event);
+
+    {
+        CxPlatEvent CppEvent;
+        TEST_FALSE(CppEvent.WaitTimeoutUs(TimeoutUs));
+        CppEvent.Set();
+        TEST_TRUE(CppEvent.WaitTimeoutUs(TimeoutUs));
+    }
+}
+
+void CxPlatTestTimeCoarse()
+{
+    //
+    // Allowed error. Generous to tolerate scheduling delays of the ticker.
+    //
+    const uint64_t FudgeUs = 50 * 1000;
+
+    //
+    // Without the ticker.
+    //
+    uint64_t T1Us = CxPlatTimeUs64();
+    uint64_t CoarseUs = CxPlatTimeCoarseUs64();
+    uint64_t T2Us = CxPlatTimeUs64();
+    TEST_TRUE(CoarseUs <= T2Us);
+    TEST_TRUE(CoarseUs + FudgeUs >= T1Us);
+
+#if defined(_WIN64) || defined(__LP64__)
+    uint32_t StartCount = 0;
+    TEST_CXPLAT_GOTO(CxPlatTimeCoarseStart(CXPLAT_TIME_COARSE_DEFAULT_PERIOD_US));
+    StartCount++;
+    TEST_CXPLAT_GOTO(CxPlatTimeCoarseStart(500));
+    StartCount++;
+    TEST_NOT_EQUAL_GOTO(0u, CxPlatTimeCoarseCurrentUs);
+
+    //
+    // The published time keeps advancing and tracks the precise clock.
+    //
+    T1Us = CxPlatTimeCoarseUs64();
+    CxPlatSleep(50);
+    CoarseUs = CxPlatTimeCoarseUs64();
+    T2Us = CxPlatTimeUs64();
+    TEST_TRUE_GOTO(CoarseUs > T1Us);
+    TEST_TRUE_GOTO(CoarseUs <= T2Us);
+    TEST_TRUE_GOTO(CoarseUs + FudgeUs >= T2Us);
+
+    CxPlatTimeCoarseStop();
+    StartCount--;
+    TEST_NOT_EQUAL_GOTO(0u, CxPlatTimeCoarseCurrentUs);
+    CxPlatTimeCoarseStop();
+    StartCount--;
+    TEST_EQUAL_GOTO(0u, CxPlatTimeCoarseCurrentUs);
+
+Failure:
+
+    while (StartCount-- > 0) {
+        CxPlatTimeCoarseStop();
+    }
+#else
+    TEST_EQUAL(CXPLAT_STATUS_NOT_SUPPORTED, CxPlatTimeCoarseStart(0));
+#endif
+}
+
+void CxPlatTestTimeSleepUntil()
+{
+    const uint64_t FudgeUs = 100 * 1000;
+
+    //
+    // Deadlines already in the past return immediately.
+    //
+    CxPlatSleepUntil(0);
+    CxPlatSleepUntilPrecise(0);
+    CxPlatSleepUntilPrecise(CxPlatTimeUs64());
+
+    uint64_t DeadlineUs = CxPlatTimeUs64() + 2000;
+    CxPlatSleepUntil(DeadlineUs);
+    uint64_t NowUs = CxPlatTimeUs64();
+    TEST_TRUE(NowUs >= DeadlineUs);
+    TEST_TRUE(NowUs < DeadlineUs + FudgeUs);
+
+    //
+    // Precise sleeps are never early. Lateness is only loosely bounded, since
+    // the spin can still be preempted on a busy machine: most sleeps must be
+    // on time, but a few may run long.
+    //
+    uint32_t LateCount = 0;
+    const uint32_t Iterations = 20;
+    for (uint32_t i = 0; i < Iterations; ++i) {
+        DeadlineUs = CxPlatTimeUs64() + 500 + i * 50;
+        CxPlatSleepUntilPrecise(DeadlineUs);
+        NowUs = CxPlatTimeUs64();
+        TEST_TRUE(NowUs >= DeadlineUs);
+        if (NowUs - DeadlineUs >= 1000) {
+            ++LateCount;
+        }
+    }
+    TEST_TRUE(LateCount <= Iterations / 4);
+
+    const uint64_t StartUs = CxPlatTimeUs64();
+    CxPlatSleepUsPrecise(300);
+    TEST_TRUE(CxPlatTimeDiff64(StartUs, CxPlatTimeUs64()) >= 300);
+}
+
+void CxPlatTestTimeEpoch()
+{
+    const uint64_t FudgeUs = 100 * 1000;
+
+    //
+    // Agrees with the system wall clock.
+    //
+    const int64_t SystemMs = CxPlatTimeEpochMs64();
+    uint64_t EpochUs = CxPlatTimeEpochUs64();
+    TEST_TRUE(SystemMs > 0);
+    TEST_TRUE(EpochUs + FudgeUs >= MS_TO_US((uint64_t)SystemMs));
+    TEST_TRUE(EpochUs <= MS_TO_US((uint64_t)SystemMs) + FudgeUs);
+
+    //
+    // Moves forward with the monotonic clock, across resyncs too. Allow for
+    // a little backward movement when a resync corrects for drift.
+    //
+    const uint64_t StartUs = CxPlatTimeUs64();
+    const uint64_t StartEpochNs = CxPlatTimeEpochNs64();
+    uint64_t PrevNs = StartEpochNs;
+    for (uint32_t i = 0; i < 100000; ++i) {
+        const uint64_t Ns = CxPlatTimeEpochNs64();
+        TEST_TRUE(Ns + US_TO_NS(1000) >= PrevNs);
+        PrevNs = Ns;
+    }
+    CxPlatSleep(CXPLAT_TIME_EPOCH_RESYNC_US / 1000 + 50);
+    const uint64_t ElapsedUs = CxPlatTimeDiff64(StartUs, CxPlatTimeUs64());
+    const uint64_t EpochElapsedUs = (CxPlatTimeEpochNs64() - StartEpochNs) / 1000;
+    TEST_TRUE(EpochElapsedUs + FudgeUs >= ElapsedUs);
+    TEST_TRUE(EpochElapsedUs <= ElapsedUs + FudgeUs);
+
+    EpochUs = CxPlatTimeEpochUs64();
+    TEST_TRUE(EpochUs + FudgeUs >= MS_TO_US((uint64_t)CxPlatTimeEpochMs64()));
+}
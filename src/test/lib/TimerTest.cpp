@@ -0,0 +1,279 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Timer test.
+
+--*/
+
+#include "precomp.h"
+
+struct TimerTestContext {
+    CxPlatEvent Fired;
+    long FireCount;
+    uint32_t FireProc;
+    uint32_t CallbackDelayMs;
+    long CallbackComplete;
+    TimerTestContext() : FireCount(0), FireProc(UINT32_MAX), CallbackDelayMs(0), CallbackComplete(0) { }
+};
+
+static void TimerTestCallback(CXPLAT_TIMER* Timer, void* Context)
+{
+    UNREFERENCED_PARAMETER(Timer);
+    TimerTestContext* Ctx = (TimerTestContext*)Context;
+    Ctx->FireProc = CxPlatProcCurrentNumber();
+    InterlockedIncrement(&Ctx->FireCount);
+    Ctx->Fired.Set();
+    if (Ctx->CallbackDelayMs != 0) {
+        CxPlatSleep(Ctx->CallbackDelayMs);
+    }
+    InterlockedExchange(&Ctx->CallbackComplete, 1);
+}
+
+void CxPlatTestTimerBasic()
+{
+    TimerTestContext Ctx;
+    CXPLAT_TIMER* Timer;
+    TEST_CXPLAT(CxPlatTimerCreate(TimerTestCallback, &Ctx, &Timer));
+
+    //
+    // Never set.
+    //
+    TEST_FALSE_GOTO(CxPlatTimerCancel(Timer));
+
+    //
+    // Fires once, no earlier than requested.
+    //
+    {
+        const uint64_t Start = CxPlatTimeUs64();
+        CxPlatTimerSet(Timer, 10000);
+        TEST_TRUE_GOTO(Ctx.Fired.WaitTimeout(2000));
+        TEST_TRUE_GOTO(CxPlatTimeDiff64(Start, CxPlatTimeUs64()) >= 10000);
+        TEST_EQUAL_GOTO(1, Ctx.FireCount);
+        TEST_FALSE_GOTO(CxPlatTimerCancel(Timer));
+    }
+
+    //
+    // Cancel before it fires.
+    //
+    CxPlatTimerSet(Timer, 50000);
+    TEST_TRUE_GOTO(CxPlatTimerCancel(Timer));
+    TEST_FALSE_GOTO(Ctx.Fired.WaitTimeout(100));
+    TEST_EQUAL_GOTO(1, Ctx.FireCount);
+
+    //
+    // Setting again replaces the previous expiration.
+    //
+    CxPlatTimerSet(Timer, 10 * 1000 * 1000);
+    CxPlatTimerSet(Timer, 1000);
+    TEST_TRUE_GOTO(Ctx.Fired.WaitTimeout(2000));
+    TEST_EQUAL_GOTO(2, Ctx.FireCount);
+
+Failure:
+
+    CxPlatTimerDelete(Timer);
+}
+
+#define TIMER_COALESCE_COUNT 32
+
+struct TimerCoalesceContext {
+    CXPLAT_TIMER* Timers[TIMER_COALESCE_COUNT];
+    uint64_t EarliestUs[TIMER_COALESCE_COUNT];
+    uint64_t FiredUs[TIMER_COALESCE_COUNT];
+    long Remaining;
+    CxPlatEvent Done;
+};
+
+CXPLAT_THREAD_CALLBACK(TimerCoalesceSetThread, Context)
+{
+    TimerCoalesceContext* Ctx = (TimerCoalesceContext*)Context;
+    for (uint32_t i = 0; i < TIMER_COALESCE_COUNT; ++i) {
+        const uint64_t DelayUs = 20000 + i * 100;
+        Ctx->EarliestUs[i] = CxPlatTimeUs64() + DelayUs;
+        CxPlatTimerSetWithTolerance(Ctx->Timers[i], DelayUs, 50000);
+    }
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestTimerCoalesce()
+{
+    TimerCoalesceContext Ctx;
+    CXPLAT_TIMER_STATS Before, After;
+    uint32_t Created = 0;
+    Ctx.Remaining = TIMER_COALESCE_COUNT;
+
+    for (; Created < TIMER_COALESCE_COUNT; ++Created) {
+        TEST_CXPLAT_GOTO(CxPlatTimerCreate(
+            [](CXPLAT_TIMER* Timer, void* Context) {
+                TimerCoalesceContext* Ctx = (TimerCoalesceContext*)Context;
+                for (uint32_t i = 0; i < TIMER_COALESCE_COUNT; ++i) {
+                    if (Ctx->Timers[i] == Timer) {
+                        Ctx->FiredUs[i] = CxPlatTimeUs64();
+                    }
+                }
+                if (InterlockedDecrement(&Ctx->Remaining) == 0) {
+                    Ctx->Done.Set();
+                }
+            },
+            &Ctx,
+            &Ctx.Timers[Created]));
+    }
+
+    //
+    // Staggered timers with generous tolerance share a handful of wakeups,
+    // and none fire early. The timers are all set from one processor, so they
+    // share one thread.
+    //
+    CxPlatTimerGetStats(&Before);
+    {
+        CXPLAT_THREAD Thread;
+        CXPLAT_THREAD_CONFIG Config = {
+            CXPLAT_THREAD_FLAG_SET_AFFINITIZE,
+            0,
+            "CxPlatTestTimerCoalesce",
+            TimerCoalesceSetThread,
+            &Ctx
+        };
+        TEST_CXPLAT_GOTO(CxPlatThreadCreate(&Config, &Thread));
+        CxPlatThreadWaitForever(&Thread);
+        CxPlatThreadDelete(&Thread);
+    }
+    TEST_TRUE_GOTO(Ctx.Done.WaitTimeout(2000));
+    CxPlatTimerGetStats(&After);
+
+    for (uint32_t i = 0; i < TIMER_COALESCE_COUNT; ++i) {
+        TEST_TRUE_GOTO(Ctx.FiredUs[i] >= Ctx.EarliestUs[i]);
+    }
+    TEST_EQUAL_GOTO(TIMER_COALESCE_COUNT, After.Expirations - Before.Expirations);
+    TEST_TRUE_GOTO(After.Wakeups - Before.Wakeups < TIMER_COALESCE_COUNT / 4);
+
+Failure:
+
+    for (uint32_t i = 0; i < Created; ++i) {
+        CxPlatTimerDelete(Ctx.Timers[i]);
+    }
+}
+
+CXPLAT_THREAD_CALLBACK(TimerAffinitySetThread, Context)
+{
+    CxPlatTimerSet((CXPLAT_TIMER*)Context, 1000);
+    CXPLAT_THREAD_RETURN(0);
+}
+
+void CxPlatTestTimerAffinity()
+{
+    TimerTestContext Ctx;
+    CXPLAT_TIMER* Timer;
+    TEST_CXPLAT(CxPlatTimerCreate(TimerTestCallback, &Ctx, &Timer));
+
+    //
+    // The callback runs on whichever processor set the timer.
+    //
+    for (uint32_t i = 0; i < CxPlatProcCount() && i < 8; ++i) {
+        CXPLAT_THREAD Thread;
+        CXPLAT_THREAD_CONFIG Config = {
+            CXPLAT_THREAD_FLAG_SET_AFFINITIZE,
+            (uint16_t)i,
+            "CxPlatTestTimerAffinity",
+            TimerAffinitySetThread,
+            Timer
+        };
+        TEST_CXPLAT_GOTO(CxPlatThreadCreate(&Config, &Thread));
+        CxPlatThreadWaitForever(&Thread);
+        CxPlatThreadDelete(&Thread);
+
+        TEST_TRUE_GOTO(Ctx.Fired.WaitTimeout(2000));
+        TEST_EQUAL_GOTO(i, Ctx.FireProc);
+    }
+
+Failure:
+
+    CxPlatTimerDelete(Timer);
+}
+
+struct TimerTestSetContext {
+    CXPLAT_TIMER* Timer;
+    bool Delete;
+};
+
+//
+// Sets the timer, or sets it again far off and deletes it, from whichever
+// processor the thread was created on.
+//
+CXPLAT_THREAD_CALLBACK(TimerTestSetThread, Context)
+{
+    TimerTestSetContext* Ctx = (TimerTestSetContext*)Context;
+    if (Ctx->Delete) {
+        CxPlatTimerSet(Ctx->Timer, 10 * 1000 * 1000);
+        CxPlatTimerDelete(Ctx->Timer);
+    } else {
+        CxPlatTimerSet(Ctx->Timer, 0);
+    }
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static void TimerTestSetOnProc(TimerTestSetContext* Ctx, uint16_t Proc)
+{
+    CXPLAT_THREAD Thread;
+    CXPLAT_THREAD_CONFIG Config = {
+        CXPLAT_THREAD_FLAG_SET_AFFINITIZE,
+        Proc,
+        "TimerTestSetThread",
+        TimerTestSetThread,
+        Ctx
+    };
+    TEST_CXPLAT(CxPlatThreadCreate(&Config, &Thread));
+    CxPlatThreadWaitForever(&Thread);
+    CxPlatThreadDelete(&Thread);
+}
+
+void CxPlatTestTimerDelete()
+{
+    TimerTestContext Ctx;
+    CXPLAT_TIMER* Timer;
+
+    //
+    // Delete waits for a running callback to complete.
+    //
+    Ctx.CallbackDelayMs = 100;
+    TEST_CXPLAT(CxPlatTimerCreate(TimerTestCallback, &Ctx, &Timer));
+    CxPlatTimerSet(Timer, 0);
+    TEST_TRUE(Ctx.Fired.WaitTimeout(2000));
+    CxPlatTimerDelete(Timer);
+    TEST_EQUAL(1, Ctx.CallbackComplete);
+
+    //
+    // It still waits after the timer is set again from another processor
+    // while the callback is running on the first.
+    //
+    Ctx.CallbackComplete = 0;
+    {
+        TimerTestSetContext SetCtx = { nullptr, false };
+        TEST_CXPLAT(CxPlatTimerCreate(TimerTestCallback, &Ctx, &SetCtx.Timer));
+        TimerTestSetOnProc(&SetCtx, 0);
+        TEST_TRUE(Ctx.Fired.WaitTimeout(2000));
+        SetCtx.Delete = true;
+        TimerTestSetOnProc(&SetCtx, (uint16_t)(CxPlatProcCount() - 1));
+        TEST_EQUAL(1, Ctx.CallbackComplete);
+    }
+
+    //
+    // A timer can delete itself from its own callback, even if it's the last
+    // one, and timers still work afterwards.
+    //
+    Ctx.CallbackDelayMs = 0;
+    for (uint32_t i = 0; i < 2; ++i) {
+        TEST_CXPLAT(CxPlatTimerCreate(
+            [](CXPLAT_TIMER* Timer, void* Context) {
+                CxPlatTimerDelete(Timer);
+                ((CxPlatEvent*)Context)->Set();
+            },
+            &Ctx.Fired,
+            &Timer));
+        CxPlatTimerSet(Timer, 0);
+        TEST_TRUE(Ctx.Fired.WaitTimeout(2000));
+    }
+}
@@ -0,0 +1,226 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Timer wheel test.
+
+--*/
+
+#include "precomp.h"
+
+#define CXPLAT_POOLTAG_TIMER_WHEEL_TEST 'tWxC' // CxWt
+
+//
+// The wheel is too large for the kernel stack, so all test state is allocated.
+//
+struct TimerWheelTestContext {
+    CXPLAT_TIMER_WHEEL Wheel;
+    CXPLAT_TIMER_ENTRY Entries[256];
+    uint64_t DueTick[256];
+};
+
+static TimerWheelTestContext* AllocTimerWheelTestContext()
+{
+    return
+        (TimerWheelTestContext*)CXPLAT_ALLOC_NONPAGED(
+            sizeof(TimerWheelTestContext), CXPLAT_POOLTAG_TIMER_WHEEL_TEST);
+}
+
+static uint32_t DrainExpired(CXPLAT_LIST_ENTRY* Expired)
+{
+    uint32_t Count = 0;
+    while (!CxPlatListIsEmpty(Expired)) {
+        (void)CxPlatListRemoveHead(Expired);
+        Count++;
+    }
+    return Count;
+}
+
+void CxPlatTestTimerWheelBasic()
+{
+    TimerWheelTestContext* Ctx = AllocTimerWheelTestContext();
+    TEST_NOT_EQUAL(nullptr, Ctx);
+    CXPLAT_TIMER_WHEEL* Wheel = &Ctx->Wheel;
+    CXPLAT_TIMER_ENTRY* Entries = Ctx->Entries;
+    CXPLAT_LIST_ENTRY Expired;
+    CxPlatListInitializeHead(&Expired);
+
+    CxPlatTimerWheelInitialize(Wheel, 100, 1000);
+    for (uint32_t i = 0; i < 4; ++i) {
+        CxPlatTimerEntryInitialize(&Entries[i]);
+        TEST_FALSE_GOTO(CxPlatTimerEntryIsQueued(&Entries[i]));
+    }
+
+    //
+    // Empty wheel.
+    //
+    TEST_EQUAL_GOTO(UINT64_MAX, CxPlatTimerWheelNextExpirationUs(Wheel));
+    TEST_EQUAL_GOTO(0u, CxPlatTimerWheelProcessExpired(Wheel, 1000000, &Expired));
+
+    //
+    // Timers expire in order, no earlier than requested and rounded up to
+    // the next tick. One lands on a higher level and one in the overflow.
+    //
+    CxPlatTimerWheelInsert(Wheel, &Entries[0], 1000250);
+    CxPlatTimerWheelInsert(Wheel, &Entries[1], 1000100);
+    CxPlatTimerWheelInsert(Wheel, &Entries[2], 1000000 + 100 * 5000);
+    CxPlatTimerWheelInsert(Wheel, &Entries[3], 1000000 + 100 * (1ull << 40));
+    TEST_TRUE_GOTO(CxPlatTimerEntryIsQueued(&Entries[3]));
+    TEST_TRUE_GOTO(CxPlatTimerWheelNextExpirationUs(Wheel) <= 1000100);
+
+    TEST_EQUAL_GOTO(0u, CxPlatTimerWheelProcessExpired(Wheel, 1000099, &Expired));
+    TEST_EQUAL_GOTO(1u, CxPlatTimerWheelProcessExpired(Wheel, 1000100, &Expired));
+    TEST_EQUAL_GOTO(&Entries[1].Link, CxPlatListRemoveHead(&Expired));
+    TEST_FALSE_GOTO(CxPlatTimerEntryIsQueued(&Entries[1]));
+    TEST_EQUAL_GOTO(0u, CxPlatTimerWheelProcessExpired(Wheel, 1000299, &Expired));
+    TEST_EQUAL_GOTO(1u, CxPlatTimerWheelProcessExpired(Wheel, 1000300, &Expired));
+    TEST_EQUAL_GOTO(&Entries[0].Link, CxPlatListRemoveHead(&Expired));
+
+    TEST_TRUE_GOTO(CxPlatTimerWheelNextExpirationUs(Wheel) <= 1000000 + 100 * 5000);
+    TEST_EQUAL_GOTO(0u, CxPlatTimerWheelProcessExpired(Wheel, 1000000 + 100 * 5000 - 1, &Expired));
+    TEST_EQUAL_GOTO(1u, CxPlatTimerWheelProcessExpired(Wheel, 1000000 + 100 * 5000, &Expired));
+    TEST_EQUAL_GOTO(&Entries[2].Link, CxPlatListRemoveHead(&Expired));
+
+    TEST_EQUAL_GOTO(0u, CxPlatTimerWheelProcessExpired(Wheel, 1000000 + 100 * (1ull << 40) - 1, &Expired));
+    TEST_EQUAL_GOTO(1u, CxPlatTimerWheelProcessExpired(Wheel, 1000000 + 100 * (1ull << 40), &Expired));
+    TEST_EQUAL_GOTO(&Entries[3].Link, CxPlatListRemoveHead(&Expired));
+    TEST_EQUAL_GOTO(UINT64_MAX, CxPlatTimerWheelNextExpirationUs(Wheel));
+
+    {
+        //
+        // Cancel and reset.
+        //
+        const uint64_t Now = 1000000 + 100 * (1ull << 40);
+        CxPlatTimerWheelInsert(Wheel, &Entries[0], Now + 1000);
+        CxPlatTimerWheelInsert(Wheel, &Entries[1], Now + 1000);
+        CxPlatTimerWheelCancel(Wheel, &Entries[0]);
+        TEST_FALSE_GOTO(CxPlatTimerEntryIsQueued(&Entries[0]));
+        CxPlatTimerWheelCancel(Wheel, &Entries[0]);
+        CxPlatTimerWheelInsert(Wheel, &Entries[1], Now + 2000);
+        TEST_EQUAL_GOTO(0u, CxPlatTimerWheelProcessExpired(Wheel, Now + 1999, &Expired));
+        TEST_EQUAL_GOTO(1u, CxPlatTimerWheelProcessExpired(Wheel, Now + 2000, &Expired));
+        TEST_EQUAL_GOTO(&Entries[1].Link, CxPlatListRemoveHead(&Expired));
+
+        //
+        // Timers already in the past expire on the next pass.
+        //
+        CxPlatTimerWheelInsert(Wheel, &Entries[2], 0);
+        TEST_EQUAL_GOTO(1u, CxPlatTimerWheelProcessExpired(Wheel, Now + 2100, &Expired));
+        TEST_EQUAL_GOTO(&Entries[2].Link, CxPlatListRemoveHead(&Expired));
+    }
+
+Failure:
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        CxPlatTimerWheelCancel(Wheel, &Entries[i]);
+    }
+    CxPlatTimerWheelUninitialize(Wheel);
+    CXPLAT_FREE(Ctx, CXPLAT_POOLTAG_TIMER_WHEEL_TEST);
+}
+
+void CxPlatTestTimerWheelRandom()
+{
+    TimerWheelTestContext* Ctx = AllocTimerWheelTestContext();
+    TEST_NOT_EQUAL(nullptr, Ctx);
+    CXPLAT_TIMER_WHEEL* Wheel = &Ctx->Wheel;
+    CXPLAT_TIMER_ENTRY* Entries = Ctx->Entries;
+    const uint32_t EntryCount = sizeof(Ctx->Entries) / sizeof(Ctx->Entries[0]);
+    const uint32_t ResolutionUs = 10;
+    uint64_t Now = 12345;
+    uint32_t Queued = 0;
+    CXPLAT_LIST_ENTRY Expired;
+    CxPlatListInitializeHead(&Expired);
+
+    CxPlatTimerWheelInitialize(Wheel, ResolutionUs, Now);
+    for (uint32_t i = 0; i < EntryCount; ++i) {
+        CxPlatTimerEntryInitialize(&Entries[i]);
+    }
+
+    for (uint32_t Iteration = 0; Iteration < 10000; ++Iteration) {
+        uint32_t Random[3];
+        TEST_CXPLAT_GOTO(CxPlatRandom(sizeof(Random), Random));
+
+        //
+        // Insert, reset or cancel a random entry, with expirations spread over
+        // a random number of levels.
+        //
+        CXPLAT_TIMER_ENTRY* Entry = &Entries[Random[0] % EntryCount];
+        if ((Random[0] >> 16) % 8 == 0) {
+            if (CxPlatTimerEntryIsQueued(Entry)) {
+                Queued--;
+            }
+            CxPlatTimerWheelCancel(Wheel, Entry);
+        } else {
+            if (!CxPlatTimerEntryIsQueued(Entry)) {
+                Queued++;
+            }
+            const uint32_t Scale = (Random[0] >> 24) % 40;
+            const uint64_t Delay = (((uint64_t)Random[1] << 32) | Random[2]) & ((1ull << Scale) - 1);
+            CxPlatTimerWheelInsert(Wheel, Entry, Now + Delay);
+
+            //
+            // Timers due before the wheel's current tick are due on the next
+            // pass.
+            //
+            const uint64_t Tick = (Now + Delay + ResolutionUs - 1) / ResolutionUs;
+            Ctx->DueTick[Entry - Entries] =
+                Tick > Wheel->CurrentTick ? Tick : Wheel->CurrentTick;
+        }
+
+        //
+        // Nothing can be due before the reported next expiration.
+        //
+        const uint64_t Next = CxPlatTimerWheelNextExpirationUs(Wheel);
+        for (uint32_t i = 0; i < EntryCount; ++i) {
+            if (CxPlatTimerEntryIsQueued(&Entries[i])) {
+                TEST_TRUE_GOTO(Ctx->DueTick[i] * ResolutionUs >= Next);
+            }
+        }
+
+        //
+        // Advance by a random amount, usually small, occasionally jumping
+        // straight to the next expiration.
+        //
+        const uint64_t PrevNowTick = Now / ResolutionUs;
+        if ((Random[1] % 16) == 0 && Next != UINT64_MAX) {
+            Now = Next > Now ? Next : Now;
+        } else {
+            Now += Random[1] % (1 << ((Random[2] % 4) * 5));
+        }
+
+        const uint32_t Count = CxPlatTimerWheelProcessExpired(Wheel, Now, &Expired);
+        TEST_TRUE_GOTO(Count <= Queued);
+        Queued -= Count;
+        for (uint32_t i = 0; i < Count; ++i) {
+            CXPLAT_TIMER_ENTRY* ExpiredEntry =
+                CXPLAT_CONTAINING_RECORD(
+                    CxPlatListRemoveHead(&Expired), CXPLAT_TIMER_ENTRY, Link);
+            TEST_FALSE_GOTO(CxPlatTimerEntryIsQueued(ExpiredEntry));
+
+            //
+            // Never early, and no later than the first pass after it's due.
+            //
+            TEST_TRUE_GOTO(ExpiredEntry->ExpirationUs <= Now);
+            TEST_TRUE_GOTO(Ctx->DueTick[ExpiredEntry - Entries] > PrevNowTick);
+        }
+        TEST_TRUE_GOTO(CxPlatListIsEmpty(&Expired));
+    }
+
+    //
+    // Everything left expires eventually.
+    //
+    TEST_EQUAL_GOTO(Queued, CxPlatTimerWheelProcessExpired(Wheel, Now + (1ull << 41), &Expired));
+    TEST_EQUAL_GOTO(Queued, DrainExpired(&Expired));
+    TEST_EQUAL_GOTO(UINT64_MAX, CxPlatTimerWheelNextExpirationUs(Wheel));
+
+Failure:
+
+    for (uint32_t i = 0; i < EntryCount; ++i) {
+        CxPlatTimerWheelCancel(Wheel, &Entries[i]);
+    }
+    CxPlatTimerWheelUninitialize(Wheel);
+    CXPLAT_FREE(Ctx, CXPLAT_POOLTAG_TIMER_WHEEL_TEST);
+}
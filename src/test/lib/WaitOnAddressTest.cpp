@@ -0,0 +1,79 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Wait on address test.
+
+--*/
+
+#include "precomp.h"
+
+#ifndef _KERNEL_MODE
+
+struct WAIT_ON_ADDRESS_CONTEXT {
+    volatile uint32_t* Value;
+    CxPlatEvent* Done;
+};
+
+static void WaitOnAddressFn(WAIT_ON_ADDRESS_CONTEXT* Ctx) {
+    while (*Ctx->Value == 0) {
+        CxPlatWaitOnAddressForever(Ctx->Value, 0);
+    }
+    Ctx->Done->Set();
+}
+
+#endif // _KERNEL_MODE
+
+void CxPlatTestWaitOnAddressBasic()
+{
+#ifndef _KERNEL_MODE
+    volatile uint32_t Value = 1;
+
+    //
+    // Mismatched value returns immediately.
+    //
+    TEST_TRUE(CxPlatWaitOnAddressWithTimeoutUs(&Value, 0, 1000 * 1000));
+
+    //
+    // Matched value times out.
+    //
+    uint64_t StartUs = CxPlatTimeUs64();
+    TEST_FALSE(CxPlatWaitOnAddressWithTimeoutUs(&Value, 1, 1000));
+    TEST_TRUE(CxPlatTimeDiff64(StartUs, CxPlatTimeUs64()) >= 1000);
+
+    //
+    // Wake a single blocked waiter.
+    //
+    Value = 0;
+    {
+        CxPlatEvent Done;
+        WAIT_ON_ADDRESS_CONTEXT Ctx = { &Value, &Done };
+        CxPlatAsyncT<WAIT_ON_ADDRESS_CONTEXT> Async(WaitOnAddressFn, &Ctx);
+        TEST_FALSE(Done.WaitTimeout(100));
+        Value = 1;
+        CxPlatWakeByAddressSingle(&Value);
+        TEST_TRUE(Done.WaitTimeout(2000));
+    }
+
+    //
+    // Wake all blocked waiters.
+    //
+    Value = 0;
+    {
+        CxPlatEvent Done1, Done2;
+        WAIT_ON_ADDRESS_CONTEXT Ctx1 = { &Value, &Done1 };
+        WAIT_ON_ADDRESS_CONTEXT Ctx2 = { &Value, &Done2 };
+        CxPlatAsyncT<WAIT_ON_ADDRESS_CONTEXT> Async1(WaitOnAddressFn, &Ctx1);
+        CxPlatAsyncT<WAIT_ON_ADDRESS_CONTEXT> Async2(WaitOnAddressFn, &Ctx2);
+        TEST_FALSE(Done1.WaitTimeout(100));
+        TEST_FALSE(Done2.WaitTimeout(0));
+        Value = 1;
+        CxPlatWakeByAddressAll(&Value);
+        TEST_TRUE(Done1.WaitTimeout(2000));
+        TEST_TRUE(Done2.WaitTimeout(2000));
+    }
+#endif // _KERNEL_MODE
+}